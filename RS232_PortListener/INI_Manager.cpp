@@ -1,211 +1,568 @@
-#include "INI_Manager.h"
-#include "Base64.h"
-
-#include <iostream>
-
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/xml_parser.hpp>
-#include <boost/property_tree/ini_parser.hpp>
-#include <boost/algorithm/string/predicate.hpp>
-
-namespace RS232
-{
-	INI_Manager_Ptr INI_Manager::m_instance = nullptr;
-
-	INI_Manager_Ptr& INI_Manager::getInstance()
-	{
-		if (m_instance == nullptr)
-			m_instance = std::unique_ptr<INI_Manager>(new INI_Manager());
-		return m_instance;
-	}
-
-	INI_Manager::INI_Manager()
-	{
-
-	}
-
-	INI_Manager::~INI_Manager()
-	{
-		m_portMap.clear();
-	}
-
-	bool INI_Manager::initFromXml(const std::string& filePath)
-	{
-		try
-		{
-			boost::property_tree::ptree pt;
-			boost::property_tree::read_xml(filePath, pt);
-
-			for (auto const& v : pt.get_child(ROOT_ELEMENT))
-			{
-				if (v.first == PORT_NODE) //RS232Port
-				{
-					RS232_PortParams* portParam = nullptr;
-					std::string comPort = v.second.get<std::string>(PORT_NAME_ATTR);
-					for (boost::property_tree::ptree::value_type const& p : v.second.get_child(""))
-					{
-						if (p.first == DETAILS_NODE) //portDetails
-						{
-							BaudRate baudRate = (BaudRate)p.second.get<unsigned int>(BAUD_ATTR);
-							CharSize charSize = (CharSize)p.second.get<unsigned int>(CHAR_SIZE_ATTR);
-							Parity parity = (Parity)p.second.get<char>(PARITY_ATTR);
-							StopBits stopBits = (StopBits)p.second.get<unsigned int>(STOP_ATTR);
-							FlowControl flow = (FlowControl)p.second.get<char>(FLOW_ATTR);
-
-							portParam = new RS232_PortParams(comPort, baudRate, charSize, parity, stopBits, flow);
-						}
-						else if (p.first == PROTOCOL_NODE && portParam != nullptr)
-						{
-							std::istringstream i_str;
-							int intVal = -1;
-							i_str.str(p.second.get<std::string>(STX_ATTR));
-							i_str >> std::hex >> intVal;
-							portParam->m_STX = intVal;
-
-							i_str.clear();
-							i_str.str(p.second.get<std::string>(ETX_ATTR));
-							i_str >> std::hex >> intVal;
-							portParam->m_ETX = intVal;
-
-							boost::optional<std::string> dleStr = p.second.get_optional<std::string>(DLE_ATTR);
-							if (dleStr.is_initialized())
-								portParam->m_DLEEnabled = boost::iequals(dleStr.value(), TRUE_STR);
-
-							boost::optional<std::string> crStr = p.second.get_optional<std::string>(CR_ATTR);
-							if (crStr.is_initialized())
-								portParam->m_CREnabled = boost::iequals(crStr.value(), TRUE_STR);
-
-							//RS232_PortParams portParam(comPort, baudRate, charSize, parity, stopBits, flow, stx, etx, dle, cr);
-
-							boost::optional<unsigned int> updateTime = p.second.get_optional<unsigned int>(UPDATE_TIME_ATTR);
-							if (updateTime.is_initialized())
-								portParam->m_statusUpdateTime = updateTime.value();
-
-							boost::optional<unsigned int> rxBufferSize = p.second.get_optional<unsigned int>(RX_SIZE_ATTR);
-							if (rxBufferSize.is_initialized())
-								portParam->m_rxBufferSize = rxBufferSize.value();
-
-							boost::optional<unsigned int> txBufferSize = p.second.get_optional<unsigned int>(TX_SIZE_ATTR);
-							if (txBufferSize.is_initialized())
-								portParam->m_txBufferSize = txBufferSize.value();
-
-							for (auto const& r : p.second.get_child(""))
-							{
-								if (r.first == CONTROL_NODE) //dataControl
-								{
-									unsigned char sod, eod;
-
-									i_str.clear();
-									i_str.str(r.second.get<std::string>(SOD_ATTR));
-									i_str >> std::hex >> intVal;
-									sod = intVal;
-
-									i_str.clear();
-									i_str.str(r.second.get<std::string>(EOD_ATTR));
-									i_str >> std::hex >> intVal;
-									eod = intVal;
-
-									std::string typeName = r.second.get<std::string>(TYPE_ATTR);
-
-									std::string delims;
-									for (auto const& s : r.second.get_child(""))
-									{
-										if (s.first == DELIM_NODE) //delimeter
-										{
-											i_str.clear();
-											i_str.str(s.second.get_value<std::string>());
-											i_str >> std::hex >> intVal;
-											delims.push_back(intVal);
-										}
-									}
-									if (delims.size())
-										portParam->addDataControl(DataControl(typeName, sod, eod, delims));
-									else
-										portParam->addDataControl(DataControl(typeName, sod, eod));
-								}
-							}
-							m_portMap.insert(PortMapPair(comPort, RS232_PortParams_Ptr(portParam)));
-						}
-					}
-				}
-			}
-		}
-		catch (boost::property_tree::ptree_error &e)
-		{
-			std::cout << "ERROR while reading RS232.xml file!" << std::endl;
-			std::cout << "INI_Manager::initFromXml() -> ptree_error: " << e.what() << std::endl;
-			return false;
-		}
-		catch (std::exception e) {
-			std::cout << "ERROR while reading RS232.xml file!" << std::endl;
-			std::cout << "INI_Manager::initFromXml() -> std::exception: " << e.what() << std::endl;
-			return false;
-		}
-		return true;
-	}
-
-	RS232_PortParams_Ptr INI_Manager::getPortParams(const std::string& comPort)
-	{
-		PortMapIter iter = m_portMap.find(comPort);
-		if (iter != m_portMap.end())
-			return iter->second;
-		else
-			return RS232_PortParams_Ptr();
-	}
-
-	std::vector<std::string> INI_Manager::getComPortList()
-	{
-		std::vector<std::string> portList;
-		for (auto iter : m_portMap)
-			portList.push_back(iter.first);
-		return portList;
-	}
-
-	std::string TransmitDataHandler::prepareTransmitData(const std::string& filePath)
-	{
-		try
-		{
-			boost::property_tree::ptree pt;
-			boost::property_tree::read_ini(filePath, pt);
-			for (auto& section : pt)
-			{
-				if (section.first == TRANSMIT_SECTION) //TransmitData
-				{
-					std::string transmitData("");
-					std::string binaryData("");
-					for (auto& property : section.second)
-					{
-						if (property.first == TEXT_SECTION) //TextData
-						{
-							boost::optional<std::string> propertyValue = property.second.get_value_optional<std::string>();
-							if (propertyValue.is_initialized())
-								transmitData = propertyValue.value();
-						}
-						else if (property.first == BINARY_SECTION) //BinaryData
-						{
-							boost::optional<std::string> propertyValue = property.second.get_value_optional<std::string>();
-							if (propertyValue.is_initialized())
-							{
-								binaryData = Base64::Decode(propertyValue.value());
-								transmitData += binaryData;
-							}
-						}
-					}
-					return transmitData;
-				}
-			}
-		}
-		catch (boost::property_tree::ptree_error &e)
-		{
-			std::cout << "ERROR while reading " << filePath << "file!" << std::endl;
-			std::cout << "::init() -> ptree_error: " << e.what() << std::endl;
-			return "";
-		}
-		catch (std::exception e)
-		{
-			std::cout << "ERROR while reading " << filePath << "file!" << std::endl;
-			std::cout << "::init() -> std::exception: " << e.what() << std::endl;
-			return "";
-		}
-	}
-}
+#include "INI_Manager.h"
+#include "Base64.h"
+
+#include <iostream>
+#include <algorithm>
+#include <sstream>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+#include <boost/property_tree/ini_parser.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+namespace RS232
+{
+	INI_Manager_Ptr INI_Manager::m_instance = nullptr;
+
+	INI_Manager_Ptr& INI_Manager::getInstance()
+	{
+		if (m_instance == nullptr)
+			m_instance = std::unique_ptr<INI_Manager>(new INI_Manager());
+		return m_instance;
+	}
+
+	INI_Manager::INI_Manager() : m_priorityClass(NORMAL_PRIORITY_CLASS)
+	{
+
+	}
+
+	INI_Manager::~INI_Manager()
+	{
+		m_portMap.clear();
+	}
+
+	bool INI_Manager::initFromXml(const std::string& filePath)
+	{
+		try
+		{
+			boost::property_tree::ptree pt;
+			boost::property_tree::read_xml(filePath, pt);
+
+			for (auto const& v : pt.get_child(ROOT_ELEMENT))
+			{
+				if (v.first == PORT_NODE) //RS232Port
+				{
+					RS232_PortParams* portParam = nullptr;
+					std::string comPort = v.second.get<std::string>(PORT_NAME_ATTR);
+					for (boost::property_tree::ptree::value_type const& p : v.second.get_child(""))
+					{
+						if (p.first == DETAILS_NODE) //portDetails
+						{
+							BaudRate baudRate = (BaudRate)p.second.get<unsigned int>(BAUD_ATTR);
+							CharSize charSize = (CharSize)p.second.get<unsigned int>(CHAR_SIZE_ATTR);
+							Parity parity = (Parity)p.second.get<char>(PARITY_ATTR);
+							StopBits stopBits = (StopBits)p.second.get<unsigned int>(STOP_ATTR);
+							FlowControl flow = (FlowControl)p.second.get<char>(FLOW_ATTR);
+
+							portParam = new RS232_PortParams(comPort, baudRate, charSize, parity, stopBits, flow);
+						}
+						else if (p.first == PROTOCOL_NODE && portParam != nullptr)
+						{
+							std::istringstream i_str;
+							int intVal = -1;
+
+							boost::optional<std::string> framingStr = p.second.get_optional<std::string>(FRAMING_ATTR);
+							if (framingStr.is_initialized())
+							{
+								if (boost::iequals(framingStr.value(), FRAMING_MODBUS_RTU))
+									portParam->m_framingMode = FM_MODBUS_RTU;
+								else if (boost::iequals(framingStr.value(), FRAMING_COBS))
+									portParam->m_framingMode = FM_COBS;
+								else if (boost::iequals(framingStr.value(), FRAMING_SLIP))
+									portParam->m_framingMode = FM_SLIP;
+								else if (!boost::iequals(framingStr.value(), FRAMING_STX_ETX))
+									std::cout << "INI_Manager::initFromXml() -> unknown framing: " << framingStr.value() << std::endl;
+							}
+
+							if (portParam->m_framingMode == FM_STX_ETX) //STX & ETX are mandatory for STX/ETX framing only
+							{
+								i_str.str(p.second.get<std::string>(STX_ATTR));
+								i_str >> std::hex >> intVal;
+								portParam->m_STX = intVal;
+
+								i_str.clear();
+								i_str.str(p.second.get<std::string>(ETX_ATTR));
+								i_str >> std::hex >> intVal;
+								portParam->m_ETX = intVal;
+							}
+
+							boost::optional<std::string> dleStr = p.second.get_optional<std::string>(DLE_ATTR);
+							if (dleStr.is_initialized())
+								portParam->m_DLEEnabled = boost::iequals(dleStr.value(), TRUE_STR);
+
+							boost::optional<std::string> crStr = p.second.get_optional<std::string>(CR_ATTR);
+							if (crStr.is_initialized())
+								portParam->m_CREnabled = boost::iequals(crStr.value(), TRUE_STR);
+
+							boost::optional<std::string> printFrameStartStr = p.second.get_optional<std::string>(PRINT_FRAME_START_ATTR);
+							if (printFrameStartStr.is_initialized())
+								portParam->m_printFrameStart = boost::iequals(printFrameStartStr.value(), TRUE_STR);
+
+							//RS232_PortParams portParam(comPort, baudRate, charSize, parity, stopBits, flow, stx, etx, dle, cr);
+
+							boost::optional<unsigned int> updateTime = p.second.get_optional<unsigned int>(UPDATE_TIME_ATTR);
+							if (updateTime.is_initialized())
+								portParam->m_statusUpdateTime = updateTime.value();
+
+							boost::optional<unsigned int> rxBufferSize = p.second.get_optional<unsigned int>(RX_SIZE_ATTR);
+							if (rxBufferSize.is_initialized())
+								portParam->m_rxBufferSize = rxBufferSize.value();
+
+							boost::optional<unsigned int> rxBufferMaxSize = p.second.get_optional<unsigned int>(RX_MAX_SIZE_ATTR);
+							if (rxBufferMaxSize.is_initialized())
+								portParam->m_rxBufferMaxSize = rxBufferMaxSize.value();
+							if (portParam->m_rxBufferMaxSize < portParam->m_rxBufferSize)
+								portParam->m_rxBufferMaxSize = portParam->m_rxBufferSize; //no growth
+
+							boost::optional<unsigned int> txBufferSize = p.second.get_optional<unsigned int>(TX_SIZE_ATTR);
+							if (txBufferSize.is_initialized())
+								portParam->m_txBufferSize = txBufferSize.value();
+
+							boost::optional<unsigned int> readMinBytes = p.second.get_optional<unsigned int>(READ_MIN_ATTR);
+							if (readMinBytes.is_initialized())
+								portParam->m_readMinBytes = std::max(1u, readMinBytes.value());
+
+							boost::optional<unsigned int> readMaxWait = p.second.get_optional<unsigned int>(READ_WAIT_ATTR);
+							if (readMaxWait.is_initialized())
+								portParam->m_readMaxWaitMicros = readMaxWait.value();
+							if (portParam->m_readMaxWaitMicros > 0 && portParam->m_framingMode == FM_MODBUS_RTU)
+							{	//a batched read hands over the bytes of several frames at once, the t3.5 silence between them cannot be seen
+								std::cout << "INI_Manager::initFromXml() -> Modbus RTU framing of " << portParam->m_comPort << " needs the arrival time of every read, read batching is ignored!" << std::endl;
+								portParam->m_readMaxWaitMicros = 0;
+							}
+
+							boost::optional<unsigned int> readMaxBatch = p.second.get_optional<unsigned int>(READ_BATCH_ATTR);
+							if (readMaxBatch.is_initialized())
+								portParam->m_readMaxBatch = readMaxBatch.value();
+
+							boost::optional<size_t> rxQueueSize = p.second.get_optional<size_t>(RX_QUEUE_ATTR);
+							if (rxQueueSize.is_initialized())
+								portParam->m_rxQueueSize = rxQueueSize.value();
+
+							boost::optional<std::string> halfDuplexStr = p.second.get_optional<std::string>(HALF_DUPLEX_ATTR);
+							if (halfDuplexStr.is_initialized())
+							{
+								if (boost::iequals(halfDuplexStr.value(), HALF_DUPLEX_AUTO))
+									portParam->m_halfDuplexMode = HD_AUTO;
+								else if (boost::iequals(halfDuplexStr.value(), HALF_DUPLEX_RTS))
+									portParam->m_halfDuplexMode = HD_RTS;
+								else if (!boost::iequals(halfDuplexStr.value(), HALF_DUPLEX_NONE))
+									std::cout << "INI_Manager::initFromXml() -> unknown half duplex mode: " << halfDuplexStr.value() << std::endl;
+							}
+							if (portParam->m_halfDuplexMode != HD_NONE && portParam->m_flowControl == FC_HARD)
+							{
+								std::cout << "INI_Manager::initFromXml() -> RTS of " << portParam->m_comPort << " controls the line driver, hardware flow control is ignored!" << std::endl;
+								portParam->m_flowControl = FC_NONE;
+							}
+
+							boost::optional<unsigned int> rtsGuard = p.second.get_optional<unsigned int>(RTS_GUARD_ATTR);
+							if (rtsGuard.is_initialized())
+								portParam->m_rtsGuardMicros = rtsGuard.value();
+
+							boost::optional<std::string> echoCancelStr = p.second.get_optional<std::string>(ECHO_CANCEL_ATTR);
+							if (echoCancelStr.is_initialized())
+								portParam->m_echoCancel = boost::iequals(echoCancelStr.value(), TRUE_STR);
+
+							boost::optional<unsigned int> echoTimeout = p.second.get_optional<unsigned int>(ECHO_TIMEOUT_ATTR);
+							if (echoTimeout.is_initialized() && echoTimeout.value() > 0)
+								portParam->m_echoTimeoutMillis = echoTimeout.value();
+
+							boost::optional<unsigned int> flowHighWatermark = p.second.get_optional<unsigned int>(FLOW_HIGH_WATERMARK_ATTR);
+							if (flowHighWatermark.is_initialized() && flowHighWatermark.value() <= 100)
+								portParam->m_flowHighWatermark = flowHighWatermark.value();
+
+							boost::optional<unsigned int> flowLowWatermark = p.second.get_optional<unsigned int>(FLOW_LOW_WATERMARK_ATTR);
+							if (flowLowWatermark.is_initialized())
+								portParam->m_flowLowWatermark = flowLowWatermark.value();
+
+							if (portParam->m_flowHighWatermark > 0)
+							{
+								if (portParam->m_flowControl != FC_HARD && portParam->m_flowControl != FC_SOFT)
+								{
+									std::cout << "INI_Manager::initFromXml() -> flow watermarks of " << portParam->m_comPort << " need hardware or software flow control, ignored!" << std::endl;
+									portParam->m_flowHighWatermark = 0;
+								}
+								else if (portParam->m_flowLowWatermark >= portParam->m_flowHighWatermark)
+								{
+									std::cout << "INI_Manager::initFromXml() -> low flow watermark of " << portParam->m_comPort << " is not below the high one, using half of it!" << std::endl;
+									portParam->m_flowLowWatermark = portParam->m_flowHighWatermark / 2;
+								}
+							}
+
+							boost::optional<std::string> overflowStr = p.second.get_optional<std::string>(OVERFLOW_ATTR);
+							if (overflowStr.is_initialized())
+							{
+								if (boost::iequals(overflowStr.value(), OVERFLOW_DROP_OLDEST))
+									portParam->m_overflowPolicy = OP_DROP_OLDEST;
+								else if (boost::iequals(overflowStr.value(), OVERFLOW_DROP_NEWEST))
+									portParam->m_overflowPolicy = OP_DROP_NEWEST;
+								else if (boost::iequals(overflowStr.value(), OVERFLOW_SPILL))
+									portParam->m_overflowPolicy = OP_SPILL;
+								else if (!boost::iequals(overflowStr.value(), OVERFLOW_BLOCK))
+									std::cout << "INI_Manager::initFromXml() -> unknown overflow policy: " << overflowStr.value() << std::endl;
+							}
+
+							portParam->m_spillFilePath = p.second.get<std::string>(SPILL_FILE_ATTR, portParam->m_comPort + DEFAULT_SPILL_FILE_SUFFIX);
+
+							boost::optional<unsigned long long> spillMaxSize = p.second.get_optional<unsigned long long>(SPILL_SIZE_ATTR);
+							if (spillMaxSize.is_initialized())
+								portParam->m_spillMaxSize = spillMaxSize.value();
+
+							boost::optional<size_t> busSize = p.second.get_optional<size_t>(BUS_SIZE_ATTR);
+							if (busSize.is_initialized())
+								portParam->m_busSize = busSize.value();
+
+							portParam->m_gatewaySocketPath = p.second.get<std::string>(GATEWAY_SOCKET_ATTR, "");
+
+							boost::optional<size_t> gatewayClientQueue = p.second.get_optional<size_t>(GATEWAY_QUEUE_ATTR);
+							if (gatewayClientQueue.is_initialized())
+								portParam->m_gatewayClientQueue = gatewayClientQueue.value();
+
+							boost::optional<std::string> cpuAffinityStr = p.second.get_optional<std::string>(CPU_AFFINITY_ATTR);
+							if (cpuAffinityStr.is_initialized())
+								portParam->m_cpuAffinity = parseCpuList(cpuAffinityStr.value());
+
+							boost::optional<std::string> priorityStr = p.second.get_optional<std::string>(READER_PRIORITY_ATTR);
+							if (priorityStr.is_initialized())
+							{
+								if (boost::iequals(priorityStr.value(), PRIORITY_HIGH))
+									portParam->m_readerPriority = RP_HIGH;
+								else if (boost::iequals(priorityStr.value(), PRIORITY_TIME_CRITICAL))
+									portParam->m_readerPriority = RP_TIME_CRITICAL;
+								else if (boost::iequals(priorityStr.value(), PRIORITY_REALTIME))
+								{	//the class would raise every thread of the process, not the reader of this port only
+									std::cout << "INI_Manager::initFromXml() -> realtime is a priority class of the whole process (process node), reader of "
+										<< portParam->m_comPort << " runs time critical!" << std::endl;
+									portParam->m_readerPriority = RP_TIME_CRITICAL;
+								}
+								else if (!boost::iequals(priorityStr.value(), PRIORITY_NORMAL))
+									std::cout << "INI_Manager::initFromXml() -> unknown reader priority: " << priorityStr.value() << std::endl;
+							}
+
+							boost::optional<std::string> lockMemoryStr = p.second.get_optional<std::string>(LOCK_MEMORY_ATTR);
+							if (lockMemoryStr.is_initialized())
+								portParam->m_lockMemory = boost::iequals(lockMemoryStr.value(), TRUE_STR);
+
+							boost::optional<unsigned int> txDrainTimeout = p.second.get_optional<unsigned int>(TX_DRAIN_ATTR);
+							if (txDrainTimeout.is_initialized())
+								portParam->m_txDrainTimeoutMillis = txDrainTimeout.value();
+
+							boost::optional<unsigned int> maxFrameSize = p.second.get_optional<unsigned int>(MAX_FRAME_SIZE_ATTR);
+							if (maxFrameSize.is_initialized() && maxFrameSize.value() > 0)
+								portParam->m_maxFrameSize = maxFrameSize.value();
+
+							boost::optional<unsigned int> addressSize = p.second.get_optional<unsigned int>(ADDRESS_SIZE_ATTR);
+							if (addressSize.is_initialized())
+							{
+								if (addressSize.value() <= MAX_ADDRESS_SIZE)
+									portParam->m_addressSize = addressSize.value();
+								else
+									std::cout << "INI_Manager::initFromXml() -> address field of " << addressSize.value() << " bytes is not supported for " << portParam->m_comPort << ", ignored!" << std::endl;
+							}
+
+							boost::optional<unsigned int> addressOffset = p.second.get_optional<unsigned int>(ADDRESS_OFFSET_ATTR);
+							if (addressOffset.is_initialized())
+								portParam->m_addressOffset = addressOffset.value();
+
+							boost::optional<std::string> checksumStr = p.second.get_optional<std::string>(CHECKSUM_ATTR);
+							if (checksumStr.is_initialized())
+							{
+								portParam->m_checksumType = Checksum::fromName(checksumStr.value());
+								if (portParam->m_checksumType == CK_NONE && !boost::iequals(checksumStr.value(), "NONE"))
+									std::cout << "INI_Manager::initFromXml() -> unknown checksum type: " << checksumStr.value() << std::endl;
+							}
+
+							for (auto const& r : p.second.get_child(""))
+							{
+								if (r.first == CONTROL_NODE) //dataControl
+								{
+									unsigned char sod, eod;
+
+									i_str.clear();
+									i_str.str(r.second.get<std::string>(SOD_ATTR));
+									i_str >> std::hex >> intVal;
+									sod = intVal;
+
+									i_str.clear();
+									i_str.str(r.second.get<std::string>(EOD_ATTR));
+									i_str >> std::hex >> intVal;
+									eod = intVal;
+
+									std::string typeName = r.second.get<std::string>(TYPE_ATTR);
+
+									std::string delims;
+									for (auto const& s : r.second.get_child(""))
+									{
+										if (s.first == DELIM_NODE) //delimeter
+										{
+											i_str.clear();
+											i_str.str(s.second.get_value<std::string>());
+											i_str >> std::hex >> intVal;
+											delims.push_back(intVal);
+										}
+									}
+									if (delims.size())
+										portParam->addDataControl(DataControl(typeName, sod, eod, delims));
+									else
+										portParam->addDataControl(DataControl(typeName, sod, eod));
+								}
+							}
+							m_portMap.insert(PortMapPair(comPort, RS232_PortParams_Ptr(portParam)));
+						}
+						else if (p.first == POLLER_NODE && portParam != nullptr) //poller
+						{
+							RS232_PollerParams_Ptr pollerParams = std::make_shared<RS232_PollerParams>();
+
+							boost::optional<unsigned int> turnaround = p.second.get_optional<unsigned int>(POLLER_TURNAROUND_ATTR);
+							if (turnaround.is_initialized())
+								pollerParams->m_turnaroundMicros = turnaround.value();
+
+							boost::optional<unsigned int> maxBackoff = p.second.get_optional<unsigned int>(POLLER_MAX_BACKOFF_ATTR);
+							if (maxBackoff.is_initialized())
+								pollerParams->m_maxBackoffMillis = maxBackoff.value();
+
+							boost::optional<unsigned int> deadTimeouts = p.second.get_optional<unsigned int>(POLLER_DEAD_TIMEOUTS_ATTR);
+							if (deadTimeouts.is_initialized() && deadTimeouts.value() > 0)
+								pollerParams->m_deadTimeouts = deadTimeouts.value();
+
+							for (auto const& r : p.second.get_child(""))
+							{
+								if (r.first == POLL_NODE) //poll
+								{
+									RS232_PollParams pollParams;
+									pollParams.m_slave = r.second.get<unsigned int>(POLL_SLAVE_ATTR);
+
+									boost::optional<unsigned int> period = r.second.get_optional<unsigned int>(POLL_PERIOD_ATTR);
+									if (period.is_initialized() && period.value() > 0)
+										pollParams.m_periodMillis = period.value();
+
+									boost::optional<unsigned int> timeout = r.second.get_optional<unsigned int>(POLL_TIMEOUT_ATTR);
+									if (timeout.is_initialized() && timeout.value() > 0)
+										pollParams.m_timeoutMillis = timeout.value();
+
+									std::string requestHex = r.second.get<std::string>(POLL_REQUEST_ATTR);
+									for (size_t i = 0; i + 1 < requestHex.size(); i += 2)
+										pollParams.m_request.push_back((char)std::stoul(requestHex.substr(i, 2), nullptr, 16));
+
+									pollerParams->m_polls.push_back(pollParams);
+								}
+							}
+
+							if (portParam->m_addressSize == 0)
+								std::cout << "INI_Manager::initFromXml() -> poller of " << portParam->m_comPort << " needs the address field of a multidrop line, ignored!" << std::endl;
+							else if (!pollerParams->m_polls.empty())
+								portParam->m_pollerParams = pollerParams;
+						}
+					}
+				}
+				else if (v.first == JOURNAL_NODE) //journal
+				{
+					m_journalParams = std::make_shared<RS232_JournalParams>();
+					m_journalParams->m_directory = v.second.get<std::string>(JOURNAL_DIR_ATTR);
+
+					boost::optional<unsigned long long> segmentSize = v.second.get_optional<unsigned long long>(JOURNAL_SEGMENT_ATTR);
+					if (segmentSize.is_initialized())
+						m_journalParams->m_segmentSize = segmentSize.value();
+
+					boost::optional<unsigned int> commitInterval = v.second.get_optional<unsigned int>(JOURNAL_COMMIT_ATTR);
+					if (commitInterval.is_initialized())
+						m_journalParams->m_commitIntervalMillis = commitInterval.value();
+				}
+				else if (v.first == TRAFFIC_LOG_NODE) //trafficLog
+				{
+					m_trafficLogParams = std::make_shared<RS232_TrafficLogParams>();
+					m_trafficLogParams->m_directory = v.second.get<std::string>(TRAFFIC_LOG_DIR_ATTR);
+
+					boost::optional<unsigned long long> maxFileSize = v.second.get_optional<unsigned long long>(TRAFFIC_LOG_SIZE_ATTR);
+					if (maxFileSize.is_initialized() && maxFileSize.value() > 0)
+						m_trafficLogParams->m_maxFileSize = maxFileSize.value();
+
+					boost::optional<unsigned int> rotateInterval = v.second.get_optional<unsigned int>(TRAFFIC_LOG_ROTATE_ATTR);
+					if (rotateInterval.is_initialized())
+						m_trafficLogParams->m_rotateIntervalSeconds = rotateInterval.value();
+
+					boost::optional<std::string> compress = v.second.get_optional<std::string>(TRAFFIC_LOG_COMPRESS_ATTR);
+					if (compress.is_initialized())
+						m_trafficLogParams->m_compress = boost::iequals(compress.value(), TRUE_STR);
+				}
+				else if (v.first == FRAME_OUTPUT_NODE) //frameOutput
+				{
+					m_frameOutputParams = std::make_shared<RS232_FrameOutputParams>();
+
+					boost::optional<std::string> path = v.second.get_optional<std::string>(FRAME_OUTPUT_PATH_ATTR);
+					if (path.is_initialized() && !path.value().empty())
+						m_frameOutputParams->m_path = path.value();
+
+					boost::optional<unsigned int> bufferSize = v.second.get_optional<unsigned int>(FRAME_OUTPUT_BUFFER_ATTR);
+					if (bufferSize.is_initialized() && bufferSize.value() > 0)
+						m_frameOutputParams->m_bufferSize = bufferSize.value();
+
+					boost::optional<unsigned int> flushInterval = v.second.get_optional<unsigned int>(FRAME_OUTPUT_FLUSH_ATTR);
+					if (flushInterval.is_initialized())
+						m_frameOutputParams->m_flushIntervalMillis = flushInterval.value();
+				}
+				else if (v.first == PROCESS_NODE) //process
+				{
+					boost::optional<std::string> priorityClassStr = v.second.get_optional<std::string>(PROCESS_PRIORITY_CLASS_ATTR);
+					if (priorityClassStr.is_initialized())
+					{
+						if (boost::iequals(priorityClassStr.value(), PRIORITY_HIGH))
+							m_priorityClass = HIGH_PRIORITY_CLASS;
+						else if (boost::iequals(priorityClassStr.value(), PRIORITY_REALTIME))
+							m_priorityClass = REALTIME_PRIORITY_CLASS;
+						else if (!boost::iequals(priorityClassStr.value(), PRIORITY_NORMAL))
+							std::cout << "INI_Manager::initFromXml() -> unknown priority class: " << priorityClassStr.value() << std::endl;
+					}
+				}
+				else if (v.first == HARNESS_NODE) //harness
+				{
+					m_harnessParams = std::make_shared<RS232_HarnessParams>();
+
+					boost::optional<unsigned int> frames = v.second.get_optional<unsigned int>(HARNESS_FRAMES_ATTR);
+					if (frames.is_initialized() && frames.value() > 0)
+						m_harnessParams->m_frames = frames.value();
+
+					boost::optional<double> maxOneWay = v.second.get_optional<double>(HARNESS_ONE_WAY_ATTR);
+					if (maxOneWay.is_initialized())
+						m_harnessParams->m_maxOneWayP99 = maxOneWay.value();
+
+					boost::optional<double> maxRoundTrip = v.second.get_optional<double>(HARNESS_ROUND_TRIP_ATTR);
+					if (maxRoundTrip.is_initialized())
+						m_harnessParams->m_maxRoundTripP99 = maxRoundTrip.value();
+
+					boost::optional<double> minUtilization = v.second.get_optional<double>(HARNESS_UTILIZATION_ATTR);
+					if (minUtilization.is_initialized())
+						m_harnessParams->m_minLineUtilization = minUtilization.value();
+				}
+			}
+		}
+		catch (boost::property_tree::ptree_error &e)
+		{
+			std::cout << "ERROR while reading RS232.xml file!" << std::endl;
+			std::cout << "INI_Manager::initFromXml() -> ptree_error: " << e.what() << std::endl;
+			return false;
+		}
+		catch (std::exception e) {
+			std::cout << "ERROR while reading RS232.xml file!" << std::endl;
+			std::cout << "INI_Manager::initFromXml() -> std::exception: " << e.what() << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	RS232_PortParams_Ptr INI_Manager::getPortParams(const std::string& comPort)
+	{
+		PortMapIter iter = m_portMap.find(comPort);
+		if (iter != m_portMap.end())
+			return iter->second;
+		else
+			return RS232_PortParams_Ptr();
+	}
+
+	RS232_JournalParams_Ptr INI_Manager::getJournalParams()
+	{
+		return m_journalParams;
+	}
+
+	RS232_TrafficLogParams_Ptr INI_Manager::getTrafficLogParams()
+	{
+		return m_trafficLogParams;
+	}
+
+	RS232_FrameOutputParams_Ptr INI_Manager::getFrameOutputParams()
+	{
+		return m_frameOutputParams;
+	}
+
+	unsigned long long INI_Manager::parseCpuList(const std::string& cpuList)
+	{
+		unsigned long long mask = 0;
+		std::stringstream cpuStream(cpuList);
+		std::string cpu;
+		while (std::getline(cpuStream, cpu, ','))
+		{
+			try
+			{
+				unsigned long cpuIndex = std::stoul(cpu);
+				if (cpuIndex < 64)
+				{
+					mask |= 1ULL << cpuIndex;
+					continue;
+				}
+			}
+			catch (const std::exception&)
+			{
+			}
+			std::cout << "INI_Manager::parseCpuList() -> invalid CPU index: " << cpu << std::endl;
+		}
+		return mask;
+	}
+
+	DWORD INI_Manager::getPriorityClass() const
+	{
+		return m_priorityClass;
+	}
+
+	RS232_HarnessParams_Ptr INI_Manager::getHarnessParams()
+	{
+		if (!m_harnessParams.get())
+			m_harnessParams = std::make_shared<RS232_HarnessParams>();
+		return m_harnessParams;
+	}
+
+	std::vector<std::string> INI_Manager::getComPortList()
+	{
+		std::vector<std::string> portList;
+		for (auto iter : m_portMap)
+			portList.push_back(iter.first);
+		return portList;
+	}
+
+	std::string TransmitDataHandler::prepareTransmitData(const std::string& filePath)
+	{
+		try
+		{
+			boost::property_tree::ptree pt;
+			boost::property_tree::read_ini(filePath, pt);
+			for (auto& section : pt)
+			{
+				if (section.first == TRANSMIT_SECTION) //TransmitData
+				{
+					std::string transmitData("");
+					std::string binaryData("");
+					for (auto& property : section.second)
+					{
+						if (property.first == TEXT_SECTION) //TextData
+						{
+							boost::optional<std::string> propertyValue = property.second.get_value_optional<std::string>();
+							if (propertyValue.is_initialized())
+								transmitData = propertyValue.value();
+						}
+						else if (property.first == BINARY_SECTION) //BinaryData
+						{
+							boost::optional<std::string> propertyValue = property.second.get_value_optional<std::string>();
+							if (propertyValue.is_initialized())
+							{
+								binaryData = Base64::Decode(propertyValue.value());
+								transmitData += binaryData;
+							}
+						}
+					}
+					return transmitData;
+				}
+			}
+		}
+		catch (boost::property_tree::ptree_error &e)
+		{
+			std::cout << "ERROR while reading " << filePath << "file!" << std::endl;
+			std::cout << "::init() -> ptree_error: " << e.what() << std::endl;
+			return "";
+		}
+		catch (std::exception e)
+		{
+			std::cout << "ERROR while reading " << filePath << "file!" << std::endl;
+			std::cout << "::init() -> std::exception: " << e.what() << std::endl;
+			return "";
+		}
+	}
+}
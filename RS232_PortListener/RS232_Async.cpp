@@ -0,0 +1,315 @@
+#include "RS232_Async.h"
+
+namespace RS232
+{
+	/*an operation waiting for a received frame, completed exactly once*/
+	struct AsyncWaiter
+	{
+		RS232_AsyncChannel::FrameHandler m_frameHandler;
+		std::atomic<bool> m_completed{ false }; //by a frame, the timeout, or close()
+	};
+
+	static void completeWaiter(const RS232_Executor_Ptr& executor, const std::shared_ptr<AsyncWaiter>& waiter, RS232_AsyncFrame result)
+	{
+		executor->post([waiter, result]() mutable
+		{
+			waiter->m_frameHandler(std::move(result));
+		});
+	}
+
+	RS232_EventLoop::RS232_EventLoop(unsigned int threadCount) :
+		m_stopped(false)
+	{
+		if (threadCount == 0)
+			threadCount = 1;
+		for (unsigned int i = 0; i < threadCount; i++)
+			m_threads.push_back(std::thread(&RS232_EventLoop::run, this));
+	}
+
+	RS232_EventLoop::~RS232_EventLoop()
+	{
+		stop();
+	}
+
+	void RS232_EventLoop::post(Task task)
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		m_tasks.push_back(std::move(task));
+		m_ready.notify_one();
+	}
+
+	void RS232_EventLoop::postAfter(DWORD delayMillis, Task task)
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		m_timers.insert(std::make_pair(std::chrono::steady_clock::now() + std::chrono::milliseconds(delayMillis), std::move(task)));
+		m_ready.notify_one(); //the new timer may expire before the one a thread is waiting for
+	}
+
+	void RS232_EventLoop::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			if (m_stopped)
+				return;
+			m_stopped = true;
+			m_ready.notify_all();
+		}
+
+		for (std::thread& thread : m_threads)
+		{
+			if (thread.get_id() == std::this_thread::get_id())
+				thread.detach(); //stopped by one of its own tasks
+			else if (thread.joinable())
+				thread.join();
+		}
+		m_threads.clear();
+		m_tasks.clear();
+		m_timers.clear();
+	}
+
+	void RS232_EventLoop::run()
+	{
+		std::unique_lock<std::mutex> lock(m_guard);
+		while (!m_stopped)
+		{
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			while (!m_timers.empty() && m_timers.begin()->first <= now)
+			{
+				m_tasks.push_back(std::move(m_timers.begin()->second));
+				m_timers.erase(m_timers.begin());
+			}
+
+			if (m_tasks.empty())
+			{
+				if (m_timers.empty())
+					m_ready.wait(lock);
+				else
+					m_ready.wait_until(lock, m_timers.begin()->first);
+				continue;
+			}
+
+			Task task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+			if (!m_tasks.empty())
+				m_ready.notify_one();
+
+			lock.unlock();
+			try
+			{
+				task();
+			}
+			catch (...)
+			{
+				std::cout << "RS232_EventLoop::run() -> Unknown exception occurred!!" << std::endl;
+			}
+			lock.lock();
+		}
+	}
+
+	RS232_AsyncChannel::RS232_AsyncChannel(RS232_Executor_Ptr executor, SendFunction sendFunction) :
+		m_executor(executor),
+		m_sendFunction(sendFunction),
+		m_opened(false)
+	{
+	}
+
+	RS232_AsyncChannel::~RS232_AsyncChannel()
+	{
+		close();
+	}
+
+	void RS232_AsyncChannel::open()
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		if (m_opened || m_transmitThread.joinable())
+			return;
+		m_opened = true;
+		m_transmitThread = std::thread(&RS232_AsyncChannel::transmitLoop, this);
+	}
+
+	void RS232_AsyncChannel::close()
+	{
+		std::deque<std::shared_ptr<AsyncWaiter>> waiters;
+		std::deque<Transmit> transmits;
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			m_opened = false;
+			waiters.swap(m_waiters);
+			transmits.swap(m_transmits);
+			m_waiterAdded.notify_all();
+			m_transmitReady.notify_all();
+		}
+		if (m_transmitThread.joinable())
+			m_transmitThread.join();
+
+		for (std::shared_ptr<AsyncWaiter>& waiter : waiters)
+			completeClosed(waiter);
+		for (Transmit& transmit : transmits)
+		{
+			if (transmit.m_sendHandler)
+			{
+				SendHandler sendHandler = transmit.m_sendHandler;
+				m_executor->post([sendHandler]() { sendHandler(AS_CLOSED); });
+			}
+			else
+				completeClosed(transmit.m_responseWaiter);
+		}
+	}
+
+	void RS232_AsyncChannel::asyncNextFrame(DWORD timeoutMillis, FrameHandler frameHandler)
+	{
+		std::shared_ptr<AsyncWaiter> waiter = createWaiter(timeoutMillis, frameHandler);
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			if (m_opened)
+			{
+				addWaiter(waiter);
+				return;
+			}
+		}
+		completeClosed(waiter);
+	}
+
+	void RS232_AsyncChannel::asyncSend(const std::string& message, SendHandler sendHandler)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			if (m_opened)
+			{
+				Transmit transmit;
+				transmit.m_message = message;
+				transmit.m_sendHandler = sendHandler;
+				m_transmits.push_back(std::move(transmit));
+				m_transmitReady.notify_one();
+				return;
+			}
+		}
+		m_executor->post([sendHandler]() { sendHandler(AS_CLOSED); });
+	}
+
+	void RS232_AsyncChannel::asyncRequest(const std::string& message, DWORD timeoutMillis, FrameHandler frameHandler)
+	{
+		std::shared_ptr<AsyncWaiter> waiter = createWaiter(timeoutMillis, frameHandler);
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			if (m_opened)
+			{
+				Transmit transmit;
+				transmit.m_message = message;
+				transmit.m_responseWaiter = waiter;
+				m_transmits.push_back(std::move(transmit));
+				m_transmitReady.notify_one();
+				return;
+			}
+		}
+		completeClosed(waiter);
+	}
+
+	bool RS232_AsyncChannel::deliver(RS232_Frame&& frame)
+	{
+		std::unique_lock<std::mutex> lock(m_guard);
+		while (true)
+		{
+			m_waiterAdded.wait(lock, [&]() { return !m_opened || !m_waiters.empty(); });
+			if (!m_opened)
+				return false;
+
+			std::shared_ptr<AsyncWaiter> waiter = m_waiters.front();
+			m_waiters.pop_front();
+			if (waiter->m_completed.exchange(true))
+				continue; //timed out, the frame goes to the next waiter
+
+			lock.unlock();
+			RS232_AsyncFrame result;
+			result.m_status = AS_OK;
+			result.m_frame = std::move(frame);
+			completeWaiter(m_executor, waiter, std::move(result));
+			return true;
+		}
+	}
+
+	std::shared_ptr<AsyncWaiter> RS232_AsyncChannel::createWaiter(DWORD timeoutMillis, FrameHandler frameHandler)
+	{
+		std::shared_ptr<AsyncWaiter> waiter = std::make_shared<AsyncWaiter>();
+		waiter->m_frameHandler = frameHandler;
+		if (timeoutMillis != INFINITE)
+		{
+			std::weak_ptr<AsyncWaiter> weakWaiter = waiter;
+			m_executor->postAfter(timeoutMillis, [weakWaiter]()
+			{
+				std::shared_ptr<AsyncWaiter> waiter = weakWaiter.lock();
+				if (waiter.get() && !waiter->m_completed.exchange(true))
+				{
+					RS232_AsyncFrame result;
+					result.m_status = AS_TIMEOUT;
+					waiter->m_frameHandler(std::move(result));
+				}
+			});
+		}
+		return waiter;
+	}
+
+	void RS232_AsyncChannel::addWaiter(const std::shared_ptr<AsyncWaiter>& waiter)
+	{
+		//m_guard is held by the caller, the timed out waiters in front are released first
+		while (!m_waiters.empty() && m_waiters.front()->m_completed)
+			m_waiters.pop_front();
+		m_waiters.push_back(waiter);
+		m_waiterAdded.notify_one();
+	}
+
+	void RS232_AsyncChannel::completeClosed(const std::shared_ptr<AsyncWaiter>& waiter)
+	{
+		if (!waiter->m_completed.exchange(true))
+			completeWaiter(m_executor, waiter, RS232_AsyncFrame());
+	}
+
+	void RS232_AsyncChannel::transmitLoop()
+	{
+		while (true)
+		{
+			Transmit transmit;
+			{
+				std::unique_lock<std::mutex> lock(m_guard);
+				m_transmitReady.wait(lock, [&]() { return !m_opened || !m_transmits.empty(); });
+				if (!m_opened)
+					return;
+				transmit = std::move(m_transmits.front());
+				m_transmits.pop_front();
+
+				//the response waiter is queued before the message is written, so the response cannot be missed
+				if (transmit.m_responseWaiter.get())
+				{
+					if (transmit.m_responseWaiter->m_completed)
+						continue; //timed out before its turn
+					addWaiter(transmit.m_responseWaiter);
+				}
+			}
+
+			bool written = false;
+			try
+			{
+				written = m_sendFunction(transmit.m_message);
+			}
+			catch (...)
+			{
+				std::cout << "RS232_AsyncChannel::transmitLoop() -> Unknown exception occurred!!" << std::endl;
+			}
+
+			//a request whose message was not written gets no response, it is completed right away
+			if (!written && transmit.m_responseWaiter.get() && !transmit.m_responseWaiter->m_completed.exchange(true))
+			{
+				RS232_AsyncFrame result;
+				result.m_status = AS_FAILED;
+				completeWaiter(m_executor, transmit.m_responseWaiter, std::move(result));
+			}
+
+			if (transmit.m_sendHandler)
+			{
+				SendHandler sendHandler = transmit.m_sendHandler;
+				AsyncStatus status = written ? AS_OK : AS_FAILED;
+				m_executor->post([sendHandler, status]() { sendHandler(status); });
+			}
+		}
+	}
+}
@@ -0,0 +1,190 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: asynchronous frame reading & message sending of a device, completed on an executor (awaitable with C++20 coroutines)
+*/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RS232_FrameQueue.h"
+
+namespace RS232
+{
+	/*runs the completion handlers of the asynchronous operations*/
+	class RS232_Executor
+	{
+	public:
+		using Task = std::function<void()>;
+
+		virtual ~RS232_Executor() {};
+
+		virtual void post(Task task) = 0;
+
+		virtual void postAfter(DWORD delayMillis, Task task) = 0;
+	};
+	using RS232_Executor_Ptr = std::shared_ptr<RS232_Executor>;
+
+	/*a few threads running posted tasks & timers, can be shared by any number of devices*/
+	class RS232_EventLoop : public RS232_Executor
+	{
+	public:
+		RS232_EventLoop(unsigned int threadCount = 1);
+		virtual ~RS232_EventLoop();
+
+		void post(Task task) override;
+
+		void postAfter(DWORD delayMillis, Task task) override;
+
+		//joins the threads, the tasks not run yet are discarded
+		void stop();
+
+	private:
+		void run();
+
+		std::mutex m_guard;
+		std::condition_variable m_ready;
+		std::deque<Task> m_tasks;
+		std::multimap<std::chrono::steady_clock::time_point, Task> m_timers;
+		bool m_stopped;
+		std::vector<std::thread> m_threads;
+
+		RS232_EventLoop(const RS232_EventLoop&) = delete;
+		RS232_EventLoop& operator=(const RS232_EventLoop&) = delete;
+	};
+
+	enum AsyncStatus
+	{
+		AS_OK,
+		AS_TIMEOUT,
+		AS_CLOSED,	//the device is closed (or not opened yet)
+		AS_FAILED	//the message could not be written to the port
+	};
+
+	struct RS232_AsyncFrame
+	{
+		AsyncStatus m_status = AS_CLOSED;
+		RS232_Frame m_frame; //empty unless m_status is AS_OK
+	};
+
+	struct AsyncWaiter;
+
+	/*
+	* frames stay in the receive queue (under its overflow policy) until an operation waits for them,
+	* the waiting operations are served in the order they were started
+	*/
+	class RS232_AsyncChannel
+	{
+	public:
+		using FrameHandler = std::function<void(RS232_AsyncFrame result)>;
+		using SendHandler = std::function<void(AsyncStatus status)>;
+		using SendFunction = std::function<bool(const std::string& message)>; //false when the message was not written
+
+		RS232_AsyncChannel(RS232_Executor_Ptr executor, SendFunction sendFunction);
+		virtual ~RS232_AsyncChannel();
+
+		//starts the transmit thread
+		void open();
+
+		//completes the pending operations with AS_CLOSED & joins the transmit thread
+		void close();
+
+		//the next received frame, INFINITE waits until the device is closed
+		void asyncNextFrame(DWORD timeoutMillis, FrameHandler frameHandler);
+
+		//the handler is called once the message is written to the port
+		void asyncSend(const std::string& message, SendHandler sendHandler);
+
+		//sends the message & waits for the next received frame, a request timed out before its turn is not sent
+		void asyncRequest(const std::string& message, DWORD timeoutMillis, FrameHandler frameHandler);
+
+		//called by the consumer thread, blocks until an operation waits for the frame, false once closed
+		bool deliver(RS232_Frame&& frame);
+
+		RS232_Executor_Ptr getExecutor() const { return m_executor; }
+
+	private:
+		/*a message waiting for the transmit thread*/
+		struct Transmit
+		{
+			std::string m_message;
+			SendHandler m_sendHandler; //NULL for a request
+			std::shared_ptr<AsyncWaiter> m_responseWaiter; //NULL for a send
+		};
+
+		std::shared_ptr<AsyncWaiter> createWaiter(DWORD timeoutMillis, FrameHandler frameHandler);
+		void addWaiter(const std::shared_ptr<AsyncWaiter>& waiter);
+		void completeClosed(const std::shared_ptr<AsyncWaiter>& waiter);
+
+		void transmitLoop();
+
+		RS232_Executor_Ptr m_executor;
+		SendFunction m_sendFunction;
+
+		std::mutex m_guard;
+		std::condition_variable m_waiterAdded;
+		std::condition_variable m_transmitReady;
+		std::deque<std::shared_ptr<AsyncWaiter>> m_waiters;
+		std::deque<Transmit> m_transmits;
+		bool m_opened;
+		std::thread m_transmitThread;
+
+		RS232_AsyncChannel(const RS232_AsyncChannel&) = delete;
+		RS232_AsyncChannel& operator=(const RS232_AsyncChannel&) = delete;
+	};
+	using RS232_AsyncChannel_Ptr = std::unique_ptr<RS232_AsyncChannel>;
+
+	/*co_await starts the operation, the coroutine is resumed on the executor with its result*/
+	template<typename Result>
+	class RS232_Awaitable
+	{
+	public:
+		using Starter = std::function<void(std::function<void(Result)>)>;
+
+		explicit RS232_Awaitable(Starter starter) : m_starter(std::move(starter)) {}
+
+		bool await_ready() const noexcept { return false; }
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			//the coroutine may be resumed (and the awaitable destroyed) before the starter returns
+			Starter starter = std::move(m_starter);
+			starter([this, handle](Result result)
+			{
+				m_result = std::move(result);
+				handle.resume();
+			});
+		}
+
+		Result await_resume() { return std::move(m_result); }
+
+	private:
+		Starter m_starter;
+		Result m_result;
+	};
+
+	/*return type of a fire & forget coroutine, it runs until its first co_await & frees itself when it finishes*/
+	struct RS232_AsyncTask
+	{
+		struct promise_type
+		{
+			RS232_AsyncTask get_return_object() { return RS232_AsyncTask(); }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() {}
+			void unhandled_exception() { std::cout << "RS232_AsyncTask -> Unknown exception occurred!!" << std::endl; }
+		};
+	};
+}
@@ -0,0 +1,878 @@
+//Winsock has to be included before Windows.h (pulled in by RS232_Util.h)
+#include <winsock2.h>
+#include <afunix.h>
+
+#include "RS232_Benchmark.h"
+#include "RS232_Framer.h"
+#include "RS232_Journal.h"
+#include "RS232_Gateway.h"
+#include "RS232_TrafficLogger.h"
+#include "RS232_FrameOutput.h"
+#include "INI_Manager.h"
+#include "RS232_PortHandler.h"
+#include "RS232_Device.h"
+#include "RS232_TxScheduler.h"
+#include "RS232_EchoCanceller.h"
+#include "RS232_Async.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <thread>
+
+namespace RS232
+{
+	constexpr unsigned int BENCHMARK_ITERATIONS = 2000;
+	constexpr unsigned int BENCHMARK_READ_CHUNK = 64; //typical size of a single driver read at high baud rates
+
+	constexpr unsigned int JOURNAL_BENCH_PORTS = 4;
+	constexpr unsigned int JOURNAL_BENCH_FRAMES = 20000; //per port, appended without waiting
+	constexpr unsigned int JOURNAL_BENCH_SYNC_FRAMES = 100; //per port, each one waits until it is on disk
+	constexpr unsigned int JOURNAL_BENCH_FRAME_SIZE = 64; //typical magnetic stripe frame
+	constexpr unsigned int JOURNAL_BENCH_INTERVALS[] = { 0, 1, 5, 20 };
+
+	constexpr auto GATEWAY_BENCH_SOCKET = "rs232_gateway_bench.sock";
+	constexpr unsigned int GATEWAY_BENCH_FRAMES = 20000;
+	constexpr unsigned int GATEWAY_BENCH_FRAME_SIZE = 64;
+	constexpr unsigned int GATEWAY_BENCH_MAX_LAG = 1000; //frames the publisher may run ahead of the average client
+	constexpr size_t GATEWAY_BENCH_CLIENT_QUEUE = 256 * 1024;
+
+	constexpr unsigned int JITTER_BENCH_WAKEUPS = 10000;
+	constexpr unsigned int JITTER_BENCH_PERIOD_MICROS = 1000; //between two signals, roughly a read at high baud rates
+
+	constexpr unsigned int TRAFFIC_BENCH_CHUNKS[] = { 1, 16, 64, 512 }; //bytes per log() call, a read returns anything from a byte to a buffer
+	constexpr unsigned int TRAFFIC_BENCH_BURSTS = 64;
+	constexpr unsigned int TRAFFIC_BENCH_BURST_BYTES = 65536; //logged back to back, then the writer gets TRAFFIC_BENCH_PAUSE_MILLIS to catch up
+	constexpr unsigned int TRAFFIC_BENCH_PAUSE_MILLIS = 20;
+	constexpr double TRAFFIC_BENCH_LINE_BYTES = 46080.0; //bytes/s of 460800 baud 8N1 in one direction
+
+	constexpr unsigned int OUTPUT_BENCH_FRAMES = 100000; //half printable, half with a binary tail
+	constexpr unsigned int OUTPUT_BENCH_FRAME_SIZE = 64;
+
+	constexpr unsigned int TX_BENCH_BULK_SENDERS = 4; //each one sends bulk frames back to back, so the normal lane always has a backlog
+	constexpr unsigned int TX_BENCH_BULK_FRAME_SIZE = 1024;
+	constexpr unsigned int TX_BENCH_CONTROL_FRAME_SIZE = 16;
+	constexpr unsigned int TX_BENCH_CONTROL_FRAMES = 50;
+	constexpr unsigned int TX_BENCH_CONTROL_PERIOD_MILLIS = 20;
+
+	constexpr unsigned int HALF_DUPLEX_BENCH_EXCHANGES = 10000; //request & reply of a polled slave
+	constexpr unsigned int HALF_DUPLEX_BENCH_MAX_TURNAROUND_MICROS = 3000; //the simulated slave replies after a random gap up to this
+	constexpr unsigned int HALF_DUPLEX_BENCH_COLLISION_PERIOD = 500; //every nth request has an echo byte corrupted on the line, the middle one or the first one
+
+	constexpr unsigned int RTU_BENCH_FRAMES = 5000;
+	constexpr unsigned int RTU_BENCH_GAP_PERIOD = 250; //every nth frame is interrupted by a silence between t1.5 and t3.5
+	constexpr unsigned int RTU_BENCH_CRC_PERIOD = 200; //every nth frame has a byte corrupted on the line
+	constexpr unsigned int RTU_BENCH_MERGED_PAIRS = 20; //two frames handed over in one chunk, as a batched read would return them
+
+	constexpr unsigned int COROUTINE_BENCH_CONVERSATIONS = 1000; //coroutines started at once, each one a request/send conversation with the loopback device
+	constexpr unsigned int COROUTINE_BENCH_REQUESTS = 20; //per conversation
+	constexpr unsigned int COROUTINE_BENCH_THREADS = 2; //of the event loop resuming the coroutines
+	constexpr unsigned int COROUTINE_BENCH_FAILED_WRITE_PERIOD = 100; //every nth write to the loopback device fails
+	constexpr DWORD COROUTINE_BENCH_TIMEOUT_MILLIS = 5000;
+
+	static double elapsedNanos(FrameTime start, unsigned int iterations)
+	{
+		return std::chrono::duration<double, std::nano>(FrameClock::now() - start).count() / iterations;
+	}
+
+	void RS232_Benchmark::runFramingBenchmark(const std::string& transmitFilePath)
+	{
+		std::string payload = TransmitDataHandler::prepareTransmitData(transmitFilePath);
+		if (payload.empty())
+		{
+			std::cout << "RS232_Benchmark::runFramingBenchmark() -> no data to be sent in " << transmitFilePath << std::endl;
+			return;
+		}
+
+		struct FramingCase
+		{
+			const char* m_name;
+			FramingMode m_mode;
+		};
+		const FramingCase cases[] = { { "STX/ETX+DLE", FM_STX_ETX }, { FRAMING_COBS, FM_COBS }, { FRAMING_SLIP, FM_SLIP } };
+
+		std::cout << "Framing benchmark on " << payload.size() << " payload bytes, " << BENCHMARK_ITERATIONS << " iterations" << std::endl;
+		std::cout << std::left << std::setw(14) << "framing" << std::setw(12) << "wire bytes" << std::setw(12) << "overhead %"
+			<< std::setw(16) << "encode ns/B" << std::setw(16) << "decode ns/B" << "frames ok" << std::endl;
+
+		for (const FramingCase& framingCase : cases)
+		{
+			RS232_PortParams_Ptr portParams = std::make_shared<RS232_PortParams>("BENCH");
+			portParams->m_framingMode = framingCase.m_mode;
+			portParams->m_DLEEnabled = true;
+			portParams->m_printFrameStart = false; //the framing is measured, not the console
+
+			unsigned long long decodedFrames = 0;
+			RS232_Framer_Ptr framer = RS232_Framer::create(portParams, [&](RS232_SegmentedBuffer& frame, const RS232_FrameInfo& frameInfo)
+			{
+				if (frame.size() == payload.size())
+					decodedFrames++;
+			});
+
+			std::string encoded;
+			FrameTime start = FrameClock::now();
+			for (unsigned int i = 0; i < BENCHMARK_ITERATIONS; i++)
+				encoded = framer->encapsulate(payload);
+			double encodeNanos = elapsedNanos(start, BENCHMARK_ITERATIONS);
+
+			start = FrameClock::now();
+			for (unsigned int i = 0; i < BENCHMARK_ITERATIONS; i++)
+			{
+				for (size_t pos = 0; pos < encoded.size(); pos += BENCHMARK_READ_CHUNK)
+				{
+					unsigned int chunk = (unsigned int)std::min<size_t>(BENCHMARK_READ_CHUNK, encoded.size() - pos);
+					framer->push((const unsigned char*)encoded.data() + pos, chunk, start);
+				}
+			}
+			double decodeNanos = elapsedNanos(start, BENCHMARK_ITERATIONS);
+
+			std::cout << std::left << std::setw(14) << framingCase.m_name << std::setw(12) << encoded.size()
+				<< std::setw(12) << std::fixed << std::setprecision(2) << (100.0 * (encoded.size() - payload.size()) / payload.size())
+				<< std::setw(16) << encodeNanos / payload.size() << std::setw(16) << decodeNanos / payload.size()
+				<< decodedFrames << "/" << BENCHMARK_ITERATIONS << std::endl;
+		}
+	}
+
+	//appends from JOURNAL_BENCH_PORTS threads, returns the frames/s until the last frame is on disk
+	static double measureJournal(unsigned int framesPerPort, bool waitEachFrame)
+	{
+		RS232_SegmentedBuffer frame;
+		frame.assign(std::string(JOURNAL_BENCH_FRAME_SIZE, 'A').data(), JOURNAL_BENCH_FRAME_SIZE);
+		std::vector<std::thread> ports;
+
+		FrameTime start = FrameClock::now();
+		for (unsigned int port = 0; port < JOURNAL_BENCH_PORTS; port++)
+		{
+			ports.push_back(std::thread([&, port]()
+			{
+				std::string portName = "BENCH" + std::to_string(port + 1);
+				unsigned long long sequence = 0;
+				for (unsigned int i = 0; i < framesPerPort; i++)
+				{
+					sequence = RS232_Journal::getInstance()->append(portName, frame);
+					if (waitEachFrame)
+						RS232_Journal::getInstance()->waitDurable(sequence);
+				}
+				RS232_Journal::getInstance()->waitDurable(sequence);
+			}));
+		}
+		for (std::thread& port : ports)
+			port.join();
+
+		double seconds = std::chrono::duration<double>(FrameClock::now() - start).count();
+		return JOURNAL_BENCH_PORTS * framesPerPort / seconds;
+	}
+
+	void RS232_Benchmark::runJournalBenchmark(const std::string& journalDirectory)
+	{
+		CreateDirectoryA(journalDirectory.c_str(), NULL);
+
+		std::cout << "Journal benchmark, " << JOURNAL_BENCH_PORTS << " ports, " << JOURNAL_BENCH_FRAME_SIZE << " byte frames" << std::endl;
+		std::cout << std::left << std::setw(18) << "commit interval" << std::setw(18) << "async frames/s" << std::setw(18) << "frames/commit"
+			<< "sync frames/s" << std::endl;
+
+		for (unsigned int commitInterval : JOURNAL_BENCH_INTERVALS)
+		{
+			RS232_JournalParams_Ptr journalParams = std::make_shared<RS232_JournalParams>();
+			journalParams->m_directory = journalDirectory + "/bench_" + std::to_string(commitInterval) + "ms";
+			journalParams->m_commitIntervalMillis = commitInterval;
+
+			if (!RS232_Journal::getInstance()->open(journalParams))
+				return;
+			double asyncRate = measureJournal(JOURNAL_BENCH_FRAMES, false);
+			RS232_JournalStats stats = RS232_Journal::getInstance()->getStats();
+			double syncRate = measureJournal(JOURNAL_BENCH_SYNC_FRAMES, true);
+			RS232_Journal::getInstance()->close();
+
+			std::cout << std::left << std::setw(18) << (std::to_string(commitInterval) + " ms") << std::setw(18) << std::fixed << std::setprecision(0) << asyncRate
+				<< std::setw(18) << std::setprecision(1) << (stats.m_commits ? (double)stats.m_durableRecords / stats.m_commits : 0.0)
+				<< std::setprecision(0) << syncRate << std::endl;
+		}
+	}
+
+	void RS232_Benchmark::runTrafficLogBenchmark(const std::string& logDirectory)
+	{
+		std::vector<unsigned char> traffic(TRAFFIC_BENCH_BURST_BYTES);
+		for (size_t i = 0; i < traffic.size(); i++)
+			traffic[i] = (unsigned char)(i * 31);
+
+		std::cout << "Traffic log benchmark, " << TRAFFIC_BENCH_BURSTS << " bursts of " << TRAFFIC_BENCH_BURST_BYTES << " bytes" << std::endl;
+		std::cout << std::left << std::setw(14) << "chunk bytes" << std::setw(14) << "ns/byte" << std::setw(14) << "MB/s"
+			<< std::setw(18) << "dropped records" << "CPU % at 460800 RX+TX" << std::endl;
+
+		for (unsigned int chunk : TRAFFIC_BENCH_CHUNKS)
+		{
+			RS232_TrafficLogParams_Ptr trafficLogParams = std::make_shared<RS232_TrafficLogParams>();
+			trafficLogParams->m_directory = logDirectory;
+			if (!RS232_TrafficLogger::getInstance()->open(trafficLogParams))
+				return;
+
+			double logNanos = 0;
+			for (unsigned int burst = 0; burst < TRAFFIC_BENCH_BURSTS; burst++)
+			{
+				FrameTime start = FrameClock::now();
+				for (unsigned int offset = 0; offset < TRAFFIC_BENCH_BURST_BYTES; offset += chunk)
+					RS232_TrafficLogger::getInstance()->log(TD_RX, "COM1", traffic.data() + offset, chunk);
+				logNanos += elapsedNanos(start, 1);
+				std::this_thread::sleep_for(std::chrono::milliseconds(TRAFFIC_BENCH_PAUSE_MILLIS));
+			}
+			RS232_TrafficLogStats stats = RS232_TrafficLogger::getInstance()->getStats();
+			RS232_TrafficLogger::getInstance()->close();
+
+			double nanosPerByte = logNanos / ((double)TRAFFIC_BENCH_BURSTS * TRAFFIC_BENCH_BURST_BYTES);
+			std::cout << std::left << std::setw(14) << chunk << std::setw(14) << std::fixed << std::setprecision(2) << nanosPerByte
+				<< std::setw(14) << std::setprecision(1) << 1000.0 / nanosPerByte << std::setw(18) << stats.m_droppedRecords
+				<< std::setprecision(3) << nanosPerByte * 2 * TRAFFIC_BENCH_LINE_BYTES / 1e7 << std::endl;
+		}
+	}
+
+	void RS232_Benchmark::runFrameOutputBenchmark(const std::string& outputDirectory)
+	{
+		std::string payloads[2] = { std::string(OUTPUT_BENCH_FRAME_SIZE, 'A'), std::string(OUTPUT_BENCH_FRAME_SIZE, 'B') };
+		for (unsigned int i = OUTPUT_BENCH_FRAME_SIZE / 2; i < OUTPUT_BENCH_FRAME_SIZE; i++)
+			payloads[1][i] = (char)(i * 7);
+		RS232_Frame frames[2];
+		frames[0].m_data.assign(payloads[0].data(), payloads[0].size());
+		frames[1].m_data.assign(payloads[1].data(), payloads[1].size());
+		frames[1].m_info.m_firstNonPrintableCharPos = OUTPUT_BENCH_FRAME_SIZE / 2;
+		for (RS232_Frame& frame : frames)
+		{
+			frame.m_info.m_endTime = FrameClock::now();
+			frame.m_info.m_startTime = frame.m_info.m_endTime - std::chrono::microseconds(OUTPUT_BENCH_FRAME_SIZE * 87);
+		}
+
+		std::cout << "Frame output benchmark, " << OUTPUT_BENCH_FRAMES << " frames of " << OUTPUT_BENCH_FRAME_SIZE << " bytes" << std::endl;
+		std::cout << std::left << std::setw(16) << "mode" << std::setw(14) << "frames/s" << std::setw(14) << "payload MB/s" << "output bytes" << std::endl;
+		auto printResult = [](const char* mode, double seconds, unsigned long long outputBytes)
+		{
+			std::cout << std::left << std::setw(16) << mode << std::setw(14) << std::fixed << std::setprecision(0) << OUTPUT_BENCH_FRAMES / seconds
+				<< std::setw(14) << std::setprecision(1) << (double)OUTPUT_BENCH_FRAMES * OUTPUT_BENCH_FRAME_SIZE / seconds / 1e6 << outputBytes << std::endl;
+		};
+
+		/*text: the console printout, redirected to a file*/
+		std::string textPath = outputDirectory + "/rs232_frames_bench.txt";
+		std::ofstream textFile(textPath, std::ios::binary | std::ios::out | std::ios::trunc);
+		if (!textFile.is_open())
+		{
+			std::cout << "RS232_Benchmark::runFrameOutputBenchmark() -> cannot open " << textPath << std::endl;
+			return;
+		}
+		std::streambuf* coutBuffer = std::cout.rdbuf(textFile.rdbuf());
+		FrameTime start = FrameClock::now();
+		for (unsigned int i = 0; i < OUTPUT_BENCH_FRAMES; i++)
+			RS232_Device::printReceivedData(frames[i & 1].m_data, frames[i & 1].m_info);
+		textFile.flush();
+		double textSeconds = std::chrono::duration<double>(FrameClock::now() - start).count();
+		std::cout.rdbuf(coutBuffer);
+		unsigned long long textBytes = (unsigned long long)textFile.tellp();
+		textFile.close();
+		printResult("text", textSeconds, textBytes);
+
+		/*binary: the records of the frame output*/
+		RS232_FrameOutputParams_Ptr frameOutputParams = std::make_shared<RS232_FrameOutputParams>();
+		frameOutputParams->m_path = outputDirectory + "/rs232_frames_bench.bin";
+		start = FrameClock::now();
+		if (!RS232_FrameOutput::getInstance()->open(frameOutputParams))
+			return;
+		for (unsigned int i = 0; i < OUTPUT_BENCH_FRAMES; i++)
+			RS232_FrameOutput::getInstance()->write("COM1", frames[i & 1]);
+		RS232_FrameOutput::getInstance()->close();
+		double binarySeconds = std::chrono::duration<double>(FrameClock::now() - start).count();
+		RS232_FrameOutputStats stats = RS232_FrameOutput::getInstance()->getStats();
+		printResult("binary", binarySeconds, stats.m_writtenBytes);
+
+		/*reading the binary records back, the payload has to survive as is*/
+		std::ifstream binaryFile(frameOutputParams->m_path, std::ios::binary | std::ios::in);
+		start = FrameClock::now();
+		RS232_FrameReader reader(binaryFile);
+		RS232_FrameRecord record;
+		unsigned long long mismatches = 0;
+		while (reader.next(record))
+		{
+			const RS232_Frame& frame = frames[(reader.getReadRecords() - 1) & 1];
+			if (record.m_data != payloads[(reader.getReadRecords() - 1) & 1] || ((record.m_flags & FRAME_FLAG_BINARY) != 0) != (frame.m_info.m_firstNonPrintableCharPos != NO_NON_PRINTABLE_CHAR))
+				mismatches++;
+		}
+		double readSeconds = std::chrono::duration<double>(FrameClock::now() - start).count();
+		printResult("binary read", readSeconds, stats.m_writtenBytes);
+		std::cout << "read back " << reader.getReadRecords() << " of " << stats.m_writtenRecords << " records, "
+			<< mismatches << " mismatches, " << stats.m_writes << " writes, " << stats.m_throttledRecords << " throttled" << std::endl;
+	}
+
+	void RS232_Benchmark::runGatewayBenchmark(unsigned int clientCount)
+	{
+		std::atomic<unsigned long long> deviceMessages(0);
+		RS232_Gateway gateway(GATEWAY_BENCH_SOCKET, GATEWAY_BENCH_CLIENT_QUEUE, [&](const std::string& message) { deviceMessages++; });
+		if (!gateway.start())
+			return;
+
+		sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		strncpy(address.sun_path, GATEWAY_BENCH_SOCKET, sizeof(address.sun_path) - 1);
+
+		//the fast clients read everything, the last one never reads & has to be disconnected
+		std::vector<SOCKET> clients;
+		for (unsigned int i = 0; i <= clientCount; i++)
+		{
+			SOCKET client = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (client == INVALID_SOCKET || connect(client, (sockaddr*)&address, sizeof(address)) == SOCKET_ERROR)
+			{
+				std::cout << "RS232_Benchmark::runGatewayBenchmark() -> connect failed, error: " << WSAGetLastError() << std::endl;
+				break;
+			}
+			unsigned char message[GATEWAY_BENCH_FRAME_SIZE + 4] = { GATEWAY_BENCH_FRAME_SIZE, 0, 0, 0 };
+			send(client, (const char*)message, sizeof(message), 0);
+			clients.push_back(client);
+		}
+		unsigned int fastClients = clients.empty() ? 0 : (unsigned int)clients.size() - 1;
+		while (gateway.getStats().m_acceptedClients < clients.size())
+			std::this_thread::yield();
+
+		std::atomic<unsigned long long> receivedBytes(0);
+		std::atomic<bool> reading(true);
+		std::thread readerThread([&]()
+		{
+			std::vector<WSAPOLLFD> pollFds(fastClients);
+			for (unsigned int i = 0; i < fastClients; i++)
+				pollFds[i].fd = clients[i];
+			char buffer[16384];
+			while (reading)
+			{
+				for (WSAPOLLFD& pollFd : pollFds)
+				{
+					pollFd.events = POLLRDNORM;
+					pollFd.revents = 0;
+				}
+				if (WSAPoll(pollFds.data(), (ULONG)pollFds.size(), 100) <= 0)
+					continue;
+				for (WSAPOLLFD& pollFd : pollFds)
+				{
+					if (pollFd.revents & POLLRDNORM)
+					{
+						int received = recv(pollFd.fd, buffer, sizeof(buffer), 0);
+						if (received > 0)
+							receivedBytes += received;
+					}
+				}
+			}
+		});
+
+		RS232_SegmentedBuffer frame;
+		frame.assign(std::string(GATEWAY_BENCH_FRAME_SIZE, 'A').data(), GATEWAY_BENCH_FRAME_SIZE);
+		unsigned long long expectedBytes = (unsigned long long)fastClients * GATEWAY_BENCH_FRAMES * (GATEWAY_BENCH_FRAME_SIZE + 4);
+		FrameTime start = FrameClock::now();
+		for (unsigned int i = 1; i <= GATEWAY_BENCH_FRAMES; i++)
+		{
+			gateway.publish(frame);
+			unsigned long long allowedLag = (unsigned long long)fastClients * GATEWAY_BENCH_MAX_LAG * (GATEWAY_BENCH_FRAME_SIZE + 4);
+			while ((unsigned long long)fastClients * i * (GATEWAY_BENCH_FRAME_SIZE + 4) > receivedBytes + allowedLag)
+				std::this_thread::yield();
+		}
+		while (receivedBytes < expectedBytes && std::chrono::duration<double>(FrameClock::now() - start).count() < 30.0)
+			std::this_thread::yield();
+		double seconds = std::chrono::duration<double>(FrameClock::now() - start).count();
+
+		reading = false;
+		readerThread.join();
+		RS232_GatewayStats stats = gateway.getStats();
+		gateway.stop();
+		for (SOCKET client : clients)
+			closesocket(client);
+
+		std::cout << "Gateway benchmark, " << fastClients << " reading clients + 1 stalled client, " << GATEWAY_BENCH_FRAMES << " frames of " << GATEWAY_BENCH_FRAME_SIZE << " bytes" << std::endl;
+		std::cout << std::fixed << std::setprecision(0)
+			<< "frames/s published:        " << GATEWAY_BENCH_FRAMES / seconds << std::endl
+			<< "frame deliveries/s:        " << receivedBytes / (GATEWAY_BENCH_FRAME_SIZE + 4) / seconds << std::endl
+			<< "delivered:                 " << receivedBytes / (GATEWAY_BENCH_FRAME_SIZE + 4) << "/" << expectedBytes / (GATEWAY_BENCH_FRAME_SIZE + 4) << std::endl
+			<< "slow clients dropped:      " << stats.m_slowClientsDropped << std::endl
+			<< "client messages to device: " << deviceMessages << "/" << clients.size() << std::endl;
+	}
+
+	//signals an event every JITTER_BENCH_PERIOD_MICROS, the waiting thread records how late it woke up (microseconds)
+	static std::vector<double> measureWakeups(RS232_PortParams_Ptr portParams)
+	{
+		std::vector<double> latencies(JITTER_BENCH_WAKEUPS, 0.0); //allocated (and pre-faulted) before the measurement
+		if (portParams.get() && portParams->m_lockMemory)
+			VirtualLock(latencies.data(), latencies.size() * sizeof(double));
+
+		HANDLE wakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		std::atomic<long long> signalTime(0);
+		std::atomic<bool> waiterReady(false);
+		std::atomic<unsigned int> wakeups(0);
+
+		std::thread waiter([&]()
+		{
+			if (portParams.get())
+				RS232_PortHandler::applySchedulingParams(GetCurrentThread(), portParams);
+			waiterReady = true;
+			for (unsigned int i = 0; i < JITTER_BENCH_WAKEUPS; i++)
+			{
+				WaitForSingleObject(wakeEvent, INFINITE);
+				long long wakeTime = FrameClock::now().time_since_epoch().count();
+				latencies[i] = std::chrono::duration<double, std::micro>(FrameClock::duration(wakeTime - signalTime.load())).count();
+				wakeups++;
+			}
+		});
+
+		while (!waiterReady)
+			std::this_thread::yield();
+		for (unsigned int i = 0; i < JITTER_BENCH_WAKEUPS; i++)
+		{
+			while (wakeups < i) //a late wakeup must not merge two signals
+				std::this_thread::yield();
+			std::this_thread::sleep_for(std::chrono::microseconds(JITTER_BENCH_PERIOD_MICROS));
+			signalTime = FrameClock::now().time_since_epoch().count();
+			SetEvent(wakeEvent);
+		}
+		waiter.join();
+		CloseHandle(wakeEvent);
+
+		std::sort(latencies.begin(), latencies.end());
+		return latencies;
+	}
+
+	static void printLatencies(const std::string& name, const std::vector<double>& latencies)
+	{
+		auto percentile = [&](double p) { return latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))]; };
+		std::cout << std::left << std::setw(16) << name << std::fixed << std::setprecision(1)
+			<< std::setw(12) << percentile(0.5) << std::setw(12) << percentile(0.99) << std::setw(12) << percentile(0.999)
+			<< latencies.back() << std::endl;
+	}
+
+	void RS232_Benchmark::runJitterBenchmark(RS232_PortParams_Ptr portParams)
+	{
+		const char* priorityNames[] = { PRIORITY_NORMAL, PRIORITY_HIGH, PRIORITY_TIME_CRITICAL };
+		std::cout << "Wakeup jitter benchmark of the " << portParams->m_comPort << " reader settings, " << JITTER_BENCH_WAKEUPS << " wakeups"
+			<< " (affinity mask 0x" << std::hex << portParams->m_cpuAffinity << std::dec << ", priority " << priorityNames[portParams->m_readerPriority]
+			<< ", lock memory " << (portParams->m_lockMemory ? TRUE_STR : FALSE_STR) << ")" << std::endl;
+		std::cout << std::left << std::setw(16) << "scheduling" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "p99.9 us"
+			<< "max us" << std::endl;
+
+		//both runs share the priority class of the process, only the reader thread settings of the port differ
+		printLatencies("default", measureWakeups(RS232_PortParams_Ptr()));
+		printLatencies(portParams->m_comPort, measureWakeups(portParams));
+	}
+
+	void RS232_Benchmark::runRestartBenchmark(RS232_PortParams_Ptr portParams, unsigned int cycles)
+	{
+		std::cout << "Restart benchmark of " << portParams->m_comPort << ", " << cycles << " open/close cycles" << std::endl;
+		RS232_Device_Ptr device = RS232_Device_Ptr(new RS232_Device(portParams));
+
+		std::vector<double> openLatencies;
+		std::vector<double> closeLatencies;
+		unsigned int maxLiveThreads = 0;
+		for (unsigned int i = 0; i < cycles; i++)
+		{
+			FrameTime start = FrameClock::now();
+			device->openDevice();
+			openLatencies.push_back(elapsedNanos(start, 1) / 1000);
+			maxLiveThreads = std::max(maxLiveThreads, RS232_PortHandler::getLiveThreadCount());
+
+			start = FrameClock::now();
+			device->closeDevice();
+			closeLatencies.push_back(elapsedNanos(start, 1) / 1000);
+		}
+		if (cycles == 0)
+			return;
+
+		std::sort(openLatencies.begin(), openLatencies.end());
+		std::sort(closeLatencies.begin(), closeLatencies.end());
+		std::cout << std::left << std::setw(16) << "operation" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "p99.9 us"
+			<< "max us" << std::endl;
+		printLatencies("openDevice", openLatencies);
+		printLatencies("closeDevice", closeLatencies);
+		std::cout << "port threads while open: up to " << maxLiveThreads << ", left after the last close: " << RS232_PortHandler::getLiveThreadCount() << std::endl;
+	}
+
+	//control frames sent in controlPriority while bulk frames keep the line busy, returns the sorted queueing delays of the control frames in us
+	static std::vector<double> measureTxLanes(double charTimeMicros, TxPriority controlPriority, RS232_TxStats& stats)
+	{
+		RS232_TxScheduler scheduler;
+		auto wireTime = [charTimeMicros](unsigned int length) { return std::chrono::microseconds((long long)(length * charTimeMicros)); };
+
+		std::atomic<bool> done(false);
+		std::vector<std::thread> bulkSenders;
+		for (unsigned int i = 0; i < TX_BENCH_BULK_SENDERS; i++)
+		{
+			bulkSenders.push_back(std::thread([&]()
+			{
+				while (!done)
+					scheduler.send(TP_NORMAL, TX_BENCH_BULK_FRAME_SIZE, [&]() { std::this_thread::sleep_for(wireTime(TX_BENCH_BULK_FRAME_SIZE)); });
+			}));
+		}
+
+		std::vector<double> queueDelays;
+		for (unsigned int i = 0; i < TX_BENCH_CONTROL_FRAMES; i++)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(TX_BENCH_CONTROL_PERIOD_MILLIS));
+			FrameTime queued = FrameClock::now();
+			scheduler.send(controlPriority, TX_BENCH_CONTROL_FRAME_SIZE, [&]()
+			{
+				queueDelays.push_back(elapsedNanos(queued, 1) / 1000);
+				std::this_thread::sleep_for(wireTime(TX_BENCH_CONTROL_FRAME_SIZE));
+			});
+		}
+		done = true;
+		for (std::thread& bulkSender : bulkSenders)
+			bulkSender.join();
+
+		stats = scheduler.getStats();
+		std::sort(queueDelays.begin(), queueDelays.end());
+		return queueDelays;
+	}
+
+	void RS232_Benchmark::runTxLaneBenchmark(unsigned int baudRate)
+	{
+		RS232_PortParams portParams("BENCH", (BaudRate)baudRate, CharSize::CS_8, Parity::NONE, StopBits::SB_1, FlowControl::FC_NONE);
+		double charTimeMicros = portParams.getCharTimeMicros();
+		std::cout << "Transmit lane benchmark at " << baudRate << " baud, " << TX_BENCH_CONTROL_FRAMES << " control frames of " << TX_BENCH_CONTROL_FRAME_SIZE
+			<< " bytes behind " << TX_BENCH_BULK_SENDERS << " senders of bulk frames of " << TX_BENCH_BULK_FRAME_SIZE << " bytes (" << std::fixed << std::setprecision(1)
+			<< TX_BENCH_BULK_FRAME_SIZE * charTimeMicros / 1000 << " ms on the wire)" << std::endl;
+		std::cout << std::left << std::setw(16) << "control lane" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "p99.9 us"
+			<< "max us" << std::endl;
+
+		RS232_TxStats sharedStats;
+		RS232_TxStats laneStats;
+		printLatencies("normal", measureTxLanes(charTimeMicros, TP_NORMAL, sharedStats));
+		printLatencies("high", measureTxLanes(charTimeMicros, TP_HIGH, laneStats));
+
+		const RS232_TxLaneStats& high = laneStats.m_lanes[TP_HIGH];
+		const RS232_TxLaneStats& normal = laneStats.m_lanes[TP_NORMAL];
+		std::cout << "lane stats of the high run: high " << high.m_sentFrames << " frames, avg " << high.m_averageQueueMicros << " us, max " << high.m_maxQueueMicros
+			<< " us; normal " << normal.m_sentFrames << " frames, avg " << normal.m_averageQueueMicros << " us, max " << normal.m_maxQueueMicros << " us" << std::endl;
+	}
+
+	void RS232_Benchmark::runHalfDuplexBenchmark(unsigned int baudRate)
+	{
+		RS232_PortParams_Ptr portParams = std::make_shared<RS232_PortParams>("BENCH", (BaudRate)baudRate, CharSize::CS_8, Parity::NONE, StopBits::SB_1, FlowControl::FC_NONE);
+		portParams->m_framingMode = FM_COBS;
+		portParams->m_halfDuplexMode = HD_RTS;
+		portParams->m_echoCancel = true;
+		FrameClock::duration charTime = std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::micro>(portParams->getCharTimeMicros()));
+
+		std::vector<std::string> receivedFrames;
+		RS232_Framer_Ptr framer = RS232_Framer::create(portParams, [&](RS232_SegmentedBuffer& frame, const RS232_FrameInfo&)
+		{
+			receivedFrames.push_back(frame.toString());
+		});
+		RS232_EchoCanceller canceller(portParams);
+
+		/*
+		* simulated echoing transport in virtual time: the adapter hears every byte we send, the slave replies after a random turnaround,
+		* the echo & the reply are read back in chunks of random size like the driver hands them over
+		*/
+		std::mt19937 random(1);
+		std::uniform_int_distribution<unsigned int> turnaroundMicros(0, HALF_DUPLEX_BENCH_MAX_TURNAROUND_MICROS);
+		std::uniform_int_distribution<unsigned int> chunkSize(1, BENCHMARK_READ_CHUNK);
+		std::vector<std::string> sentReplies;
+		unsigned long long lineBytes = 0;
+		double totalTurnaroundMicros = 0.0;
+		double filterNanos = 0.0;
+		FrameTime lineTime = FrameClock::now();
+		for (unsigned int i = 0; i < HALF_DUPLEX_BENCH_EXCHANGES; i++)
+		{
+			std::string request = framer->encapsulate("READ " + std::to_string(i));
+			std::string reply = "VALUE " + std::to_string(i) + std::string(i % 32, (char)i);
+			sentReplies.push_back(reply);
+			reply = framer->encapsulate(reply);
+
+			canceller.expect((const unsigned char*)request.data(), (unsigned int)request.size(), lineTime);
+			std::string line = request;
+			if (i % HALF_DUPLEX_BENCH_COLLISION_PERIOD == 0)
+				line[line.size() / 2] ^= 0x5A;
+			else if (i % HALF_DUPLEX_BENCH_COLLISION_PERIOD == HALF_DUPLEX_BENCH_COLLISION_PERIOD / 2)
+				line[0] ^= 0x5A; //the collision hits the start of the echo
+			std::vector<FrameTime> byteEnds;
+			for (size_t b = 0; b < request.size(); b++)
+				byteEnds.push_back(lineTime + charTime * (b + 1));
+			unsigned int turnaround = turnaroundMicros(random);
+			totalTurnaroundMicros += turnaround;
+			FrameTime replyStart = byteEnds.back() + std::chrono::microseconds(turnaround);
+			line += reply;
+			for (size_t b = 0; b < reply.size(); b++)
+				byteEnds.push_back(replyStart + charTime * (b + 1));
+
+			for (size_t offset = 0; offset < line.size();)
+			{
+				unsigned int length = (unsigned int)std::min<size_t>(chunkSize(random), line.size() - offset);
+				FrameTime start = FrameClock::now();
+				canceller.filter((const unsigned char*)line.data() + offset, length, byteEnds[offset + length - 1], [&](const unsigned char* data, unsigned int dataLength, FrameTime lastByteTime)
+				{
+					framer->push(data, dataLength, lastByteTime);
+				});
+				filterNanos += elapsedNanos(start, 1);
+				offset += length;
+			}
+			lineBytes += line.size();
+			lineTime = byteEnds.back() + charTime * 4; //the master polls the next slave after a short gap
+		}
+
+		unsigned int mismatches = 0;
+		for (size_t i = 0; i < std::max(receivedFrames.size(), sentReplies.size()); i++)
+		{
+			if (i >= receivedFrames.size() || i >= sentReplies.size() || receivedFrames[i] != sentReplies[i])
+				mismatches++;
+		}
+
+		RS232_EchoStats stats = canceller.getStats();
+		std::cout << "Half duplex echo cancellation at " << baudRate << " baud, " << HALF_DUPLEX_BENCH_EXCHANGES << " request/reply exchanges, "
+			<< "every " << HALF_DUPLEX_BENCH_COLLISION_PERIOD << "th echo corrupted in the middle & every " << HALF_DUPLEX_BENCH_COLLISION_PERIOD << "th at the first byte" << std::endl;
+		std::cout << std::fixed << std::setprecision(1)
+			<< "replies: " << sentReplies.size() << " sent, " << receivedFrames.size() << " framed, " << mismatches << " mismatches (echo leaking into the framer)" << std::endl
+			<< "echo: " << stats.m_echoedBytes << " bytes removed, " << stats.m_corruptedEchoBytes << " corrupted, " << stats.m_missingEchoBytes << " missing" << std::endl
+			<< "turnaround: simulated avg " << totalTurnaroundMicros / HALF_DUPLEX_BENCH_EXCHANGES << " us, measured avg " << stats.m_averageTurnaroundMicros
+			<< " us (min " << stats.m_minTurnaroundMicros << " max " << stats.m_maxTurnaroundMicros << ", " << stats.m_turnarounds << " samples)" << std::endl
+			<< "filter cost: " << filterNanos / lineBytes << " ns/byte" << std::endl;
+	}
+
+	void RS232_Benchmark::runModbusRtuBenchmark(unsigned int baudRate)
+	{
+		RS232_PortParams_Ptr portParams = std::make_shared<RS232_PortParams>("BENCH", (BaudRate)baudRate, CharSize::CS_8, Parity::EVEN, StopBits::SB_1, FlowControl::FC_NONE);
+		portParams->m_framingMode = FM_MODBUS_RTU;
+		double charTimeMicros = portParams->getCharTimeMicros();
+		FrameClock::duration charTime = std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::micro>(charTimeMicros));
+
+		//the timing of the Modbus serial line spec, fixed above 19200 baud as the framer does
+		double t15Micros = (baudRate > 19200) ? 750.0 : charTimeMicros * 1.5;
+		double t35Micros = (baudRate > 19200) ? 1750.0 : charTimeMicros * 3.5;
+		FrameClock::duration t35 = std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::micro>(t35Micros));
+		FrameClock::duration toleratedGap = std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::micro>(t15Micros * 0.9));
+		FrameClock::duration midFrameGap = std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::micro>((t15Micros + t35Micros) / 2));
+
+		std::vector<std::string> receivedFrames;
+		RS232_Framer_Ptr framer = RS232_Framer::create(portParams, [&](RS232_SegmentedBuffer& frame, const RS232_FrameInfo&)
+		{
+			receivedFrames.push_back(frame.toString());
+		});
+
+		/*
+		* paced stream in virtual time: the bytes of a frame follow each other in chunks of random size like the driver hands them over,
+		* a frame is followed by at least t3.5 of silence, the gaps inside a frame fall on a chunk boundary as the read returns there
+		*/
+		std::mt19937 random(1);
+		std::uniform_int_distribution<unsigned int> chunkSize(1, BENCHMARK_READ_CHUNK);
+		std::uniform_int_distribution<unsigned int> extraSilenceMicros(0, (unsigned int)t35Micros);
+		std::vector<std::string> validFrames;
+		unsigned int midFrameGaps = 0;
+		unsigned int corruptedFrames = 0;
+		unsigned long long lineBytes = 0;
+		double pushNanos = 0.0;
+		FrameTime lineTime = FrameClock::now(); //end of the last byte on the line
+		for (unsigned int i = 0; i < RTU_BENCH_FRAMES; i++)
+		{
+			std::string pdu;
+			pdu += (char)(1 + i % 247); //slave address
+			pdu += (char)(3 + i % 4); //function code
+			pdu += std::string(i % 60, (char)i);
+			std::string frame = framer->encapsulate(pdu);
+
+			size_t gapOffset = frame.size() / 2;
+			FrameClock::duration gap(0);
+			if (i % RTU_BENCH_GAP_PERIOD == RTU_BENCH_GAP_PERIOD / 2)
+			{
+				gap = midFrameGap;
+				midFrameGaps++;
+			}
+			else if (i % RTU_BENCH_CRC_PERIOD == RTU_BENCH_CRC_PERIOD / 2)
+			{
+				frame[1] ^= 0x5A;
+				corruptedFrames++;
+			}
+			else
+			{
+				if (i % 2)
+					gap = toleratedGap;
+				validFrames.push_back(pdu);
+			}
+
+			for (size_t offset = 0; offset < frame.size();)
+			{
+				size_t end = std::min<size_t>(frame.size(), offset + chunkSize(random));
+				if (offset < gapOffset && end > gapOffset)
+					end = gapOffset;
+				if (offset == gapOffset)
+					lineTime += gap;
+				lineTime += charTime * (end - offset);
+				FrameTime start = FrameClock::now();
+				framer->push((const unsigned char*)frame.data() + offset, (unsigned int)(end - offset), lineTime);
+				pushNanos += elapsedNanos(start, 1);
+				offset = end;
+			}
+			lineBytes += frame.size();
+			lineTime += t35 + std::chrono::microseconds(extraSilenceMicros(random));
+		}
+		framer->poll(lineTime); //the reader polls the framer once the line is idle, the last frame ends there
+
+		unsigned int mismatches = 0;
+		for (size_t i = 0; i < std::max(receivedFrames.size(), validFrames.size()); i++)
+		{
+			if (i >= receivedFrames.size() || i >= validFrames.size() || receivedFrames[i] != validFrames[i])
+				mismatches++;
+		}
+
+		std::cout << "Modbus RTU framing at " << baudRate << " baud, " << RTU_BENCH_FRAMES << " frames, "
+			<< std::fixed << std::setprecision(1) << "t1.5 " << t15Micros << " us, t3.5 " << t35Micros << " us" << std::endl;
+		std::cout << "frames: " << validFrames.size() << " valid sent, " << receivedFrames.size() << " framed, " << mismatches << " mismatches (frames split or merged wrongly)" << std::endl
+			<< "mid-frame gaps: " << midFrameGaps << " inserted, " << framer->getMalformedFrames() << " frames dropped as malformed" << std::endl
+			<< "CRC: " << corruptedFrames << " frames corrupted, " << framer->getBadChecksumFrames() << " rejected" << std::endl
+			<< "push cost: " << pushNanos / lineBytes << " ns/byte" << std::endl;
+
+		/*
+		* the t3.5 silence between two frames passed inside the driver, the chunk carries a single arrival time: the framer sees one frame,
+		* its CRC runs on over the second frame & does not match, so both frames are dropped (the reason readMaxWait is ignored for Modbus RTU)
+		*/
+		unsigned int mergedFramed = 0;
+		RS232_Framer_Ptr mergedFramer = RS232_Framer::create(portParams, [&](RS232_SegmentedBuffer&, const RS232_FrameInfo&)
+		{
+			mergedFramed++;
+		});
+		for (unsigned int i = 0; i < RTU_BENCH_MERGED_PAIRS; i++)
+		{
+			std::string chunk = mergedFramer->encapsulate(std::string(1, (char)(1 + i)) + "\x03" + std::string(i, (char)i))
+				+ mergedFramer->encapsulate(std::string(1, (char)(2 + i)) + "\x04" + std::string(i, (char)~i));
+			lineTime += t35 + charTime * chunk.size();
+			mergedFramer->push((const unsigned char*)chunk.data(), (unsigned int)chunk.size(), lineTime);
+		}
+		mergedFramer->poll(lineTime + t35);
+		std::cout << "two frames in one chunk: " << RTU_BENCH_MERGED_PAIRS * 2 << " frames sent, " << mergedFramed << " framed, "
+			<< mergedFramer->getMalformedFrames() << " dropped as malformed, " << mergedFramer->getBadChecksumFrames() << " rejected by CRC (merged pairs)" << std::endl;
+	}
+
+	/*results of the coroutine conversations, updated on the event loop threads*/
+	struct CoroutineBenchStats
+	{
+		std::atomic<unsigned int> m_replies{ 0 };
+		std::atomic<unsigned int> m_sends{ 0 };
+		std::atomic<unsigned int> m_failedWrites{ 0 }; //AS_FAILED completions of requests & sends
+		std::atomic<unsigned int> m_errors{ 0 }; //a wrong reply, a timeout or a closed channel
+		std::mutex m_guard;
+		std::condition_variable m_finished;
+		unsigned int m_running = COROUTINE_BENCH_CONVERSATIONS;
+	};
+
+	static RS232_AsyncTask runCoroutineConversation(RS232_AsyncChannel* channel, unsigned int id, CoroutineBenchStats* stats)
+	{
+		for (unsigned int i = 0; i < COROUTINE_BENCH_REQUESTS; i++)
+		{
+			std::string request = "REQ " + std::to_string(id) + " " + std::to_string(i);
+			//named awaitables, GCC destroys a lambda temporary of a co_await expression twice
+			RS232_Awaitable<RS232_AsyncFrame> requested([channel, request](std::function<void(RS232_AsyncFrame)> resume)
+			{
+				channel->asyncRequest(request, COROUTINE_BENCH_TIMEOUT_MILLIS, resume);
+			});
+			RS232_AsyncFrame reply = co_await requested;
+			if (reply.m_status == AS_FAILED)
+				stats->m_failedWrites++;
+			else if (reply.m_status != AS_OK || reply.m_frame.m_data.toString() != "RSP" + request.substr(3))
+				stats->m_errors++;
+			else
+				stats->m_replies++;
+
+			RS232_Awaitable<AsyncStatus> sent([channel, id](std::function<void(AsyncStatus)> resume)
+			{
+				channel->asyncSend("ACK " + std::to_string(id), resume);
+			});
+			AsyncStatus status = co_await sent;
+			if (status == AS_FAILED)
+				stats->m_failedWrites++;
+			else if (status != AS_OK)
+				stats->m_errors++;
+			else
+				stats->m_sends++;
+		}
+
+		std::lock_guard<std::mutex> lock(stats->m_guard);
+		if (--stats->m_running == 0)
+			stats->m_finished.notify_one();
+	}
+
+	void RS232_Benchmark::runCoroutineBenchmark()
+	{
+		/*
+		* loopback device: every nth write fails, a written request is answered by the feeder thread
+		* in the order the requests were written, like a polled slave on the line
+		*/
+		std::mutex lineGuard;
+		std::condition_variable lineReady;
+		std::deque<std::string> replies;
+		bool lineClosed = false;
+		unsigned int writes = 0;
+		unsigned int injectedFailures = 0;
+
+		std::shared_ptr<RS232_EventLoop> eventLoop = std::make_shared<RS232_EventLoop>(COROUTINE_BENCH_THREADS);
+		RS232_AsyncChannel channel(eventLoop, [&](const std::string& message)
+		{
+			//called by the transmit thread only
+			if (++writes % COROUTINE_BENCH_FAILED_WRITE_PERIOD == 0)
+			{
+				injectedFailures++;
+				return false;
+			}
+			if (message.compare(0, 3, "REQ") == 0)
+			{
+				std::lock_guard<std::mutex> lock(lineGuard);
+				replies.push_back("RSP" + message.substr(3));
+				lineReady.notify_one();
+			}
+			return true;
+		});
+		channel.open();
+
+		std::thread feeder([&]()
+		{
+			while (true)
+			{
+				std::string reply;
+				{
+					std::unique_lock<std::mutex> lock(lineGuard);
+					lineReady.wait(lock, [&]() { return lineClosed || !replies.empty(); });
+					if (replies.empty())
+						return;
+					reply = std::move(replies.front());
+					replies.pop_front();
+				}
+				RS232_Frame frame;
+				frame.m_data.assign(reply.data(), reply.size());
+				if (!channel.deliver(std::move(frame)))
+					return;
+			}
+		});
+
+		CoroutineBenchStats stats;
+		FrameTime start = FrameClock::now();
+		for (unsigned int c = 0; c < COROUTINE_BENCH_CONVERSATIONS; c++)
+		{
+			eventLoop->post([&channel, c, &stats]()
+			{
+				runCoroutineConversation(&channel, c, &stats);
+			});
+		}
+		{
+			std::unique_lock<std::mutex> lock(stats.m_guard);
+			stats.m_finished.wait(lock, [&]() { return stats.m_running == 0; });
+		}
+		double elapsedSeconds = std::chrono::duration<double>(FrameClock::now() - start).count();
+
+		{
+			std::lock_guard<std::mutex> lock(lineGuard);
+			lineClosed = true;
+			lineReady.notify_one();
+		}
+		channel.close();
+		feeder.join();
+		eventLoop->stop();
+
+		unsigned int operations = COROUTINE_BENCH_CONVERSATIONS * COROUTINE_BENCH_REQUESTS * 2;
+		std::cout << "Coroutine benchmark: " << COROUTINE_BENCH_CONVERSATIONS << " conversations of " << COROUTINE_BENCH_REQUESTS << " co_await request & send, "
+			<< COROUTINE_BENCH_THREADS << " event loop threads, every " << COROUTINE_BENCH_FAILED_WRITE_PERIOD << "th write fails" << std::endl;
+		std::cout << std::fixed << std::setprecision(1) << "operations: " << operations << " in " << elapsedSeconds * 1000 << " ms, "
+			<< operations / elapsedSeconds << " ops/s" << std::endl
+			<< "replies: " << stats.m_replies << ", sends: " << stats.m_sends << std::endl
+			<< "failed writes: " << injectedFailures << " injected, " << stats.m_failedWrites << " completed with AS_FAILED" << std::endl
+			<< "errors (wrong reply, timeout, closed): " << stats.m_errors << std::endl;
+	}
+}
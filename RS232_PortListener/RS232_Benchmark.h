@@ -0,0 +1,61 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: offline benchmarks of the receive/transmit path, run from the command line without a serial port
+*/
+
+#include <string>
+
+#include "RS232_Util.h"
+
+namespace RS232
+{
+	class RS232_Benchmark final
+	{
+	public:
+		//compares wire overhead & encode/decode cost of STX/ETX+DLE, COBS and SLIP on the payload of a transmit data file
+		static void runFramingBenchmark(const std::string& transmitFilePath);
+
+		//measures journal throughput (frames/s) of several ports at different group commit intervals
+		static void runJournalBenchmark(const std::string& journalDirectory);
+
+		//fans frames out to clientCount reading clients over the gateway socket, plus a stalled client which has to be dropped
+		static void runGatewayBenchmark(unsigned int clientCount);
+
+		//cost of the hex dump traffic log per byte & its CPU share when both directions of a 460800 baud line are logged
+		static void runTrafficLogBenchmark(const std::string& logDirectory);
+
+		//frames/s of the text printout vs. the binary frame output, and of reading the binary records back
+		static void runFrameOutputBenchmark(const std::string& outputDirectory);
+
+		//opens & closes the device of the port cycles times, close() has to join every thread it started
+		static void runRestartBenchmark(RS232_PortParams_Ptr portParams, unsigned int cycles);
+
+		//wakeup latency percentiles of a thread waiting on an event like the reader thread, default scheduling vs. the port settings
+		static void runJitterBenchmark(RS232_PortParams_Ptr portParams);
+
+		//queueing delay of control frames sent while bulk frames keep a simulated line busy, sharing the normal lane vs. the high priority lane
+		static void runTxLaneBenchmark(unsigned int baudRate);
+
+		//removes the echo of an RS-485 adapter on a simulated echoing line & compares the measured bus turnaround with the simulated one
+		static void runHalfDuplexBenchmark(unsigned int baudRate);
+
+		//feeds the Modbus RTU framer a paced stream in virtual time: t3.5 splits the frames, a gap over t1.5 inside a frame & a bad CRC drop it,
+		//two frames in one chunk are rejected by CRC as the silence between them cannot be seen
+		static void runModbusRtuBenchmark(unsigned int baudRate);
+
+		//co_await request & send conversations over a loopback device whose every nth write fails, the failures have to complete with AS_FAILED
+		static void runCoroutineBenchmark();
+
+	private:
+		/*to protect the static class from being copied*/
+		RS232_Benchmark() = delete;
+		RS232_Benchmark(const RS232_Benchmark&) = delete;
+		RS232_Benchmark& operator=(const RS232_Benchmark&) = delete;
+		RS232_Benchmark(RS232_Benchmark&&) = delete;
+		RS232_Benchmark& operator=(RS232_Benchmark&) = delete;
+		/*to protect the static class from being copied*/
+	};
+}
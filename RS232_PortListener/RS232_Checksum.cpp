@@ -0,0 +1,239 @@
+#include "RS232_Checksum.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+
+namespace RS232
+{
+	/*slicing-by-8 tables: m_table[k][b] is the CRC of byte b followed by k zero bytes*/
+	struct CrcTables
+	{
+		CrcTables(uint32_t poly, bool reflected, uint32_t width)
+		{
+			uint32_t topBit = 1u << (width - 1);
+			uint32_t mask = (width == 32) ? 0xFFFFFFFFu : ((1u << width) - 1);
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t crc;
+				if (reflected)
+				{
+					crc = i;
+					for (int bit = 0; bit < 8; bit++)
+						crc = (crc & 1) ? (crc >> 1) ^ poly : (crc >> 1);
+				}
+				else
+				{
+					crc = i << (width - 8);
+					for (int bit = 0; bit < 8; bit++)
+						crc = (crc & topBit) ? ((crc << 1) ^ poly) & mask : (crc << 1) & mask;
+				}
+				m_table[0][i] = crc;
+			}
+			for (int k = 1; k < 8; k++)
+			{
+				for (uint32_t i = 0; i < 256; i++)
+				{
+					uint32_t prev = m_table[k - 1][i];
+					if (reflected)
+						m_table[k][i] = (prev >> 8) ^ m_table[0][prev & 0xFF];
+					else
+						m_table[k][i] = ((prev << 8) ^ m_table[0][(prev >> (width - 8)) & 0xFF]) & mask;
+				}
+			}
+		}
+
+		uint32_t m_table[8][256];
+	};
+
+	static const CrcTables& reflectedCrc16Tables()
+	{
+		static const CrcTables tables(0xA001, true, 16);
+		return tables;
+	}
+
+	static const CrcTables& ccittCrc16Tables()
+	{
+		static const CrcTables tables(0x1021, false, 16);
+		return tables;
+	}
+
+	static const CrcTables& crc32Tables()
+	{
+		static const CrcTables tables(0xEDB88320, true, 32);
+		return tables;
+	}
+
+	static inline uint32_t load32LE(const unsigned char* p)
+	{
+		return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+	}
+
+	//LSB-first CRC of width 16 or 32, the register is folded into the first bytes of each block
+	static uint32_t updateReflected(const CrcTables& tables, uint32_t crc, const unsigned char* data, size_t length)
+	{
+		const uint32_t (*t)[256] = tables.m_table;
+		while (length >= 8)
+		{
+			uint32_t one = load32LE(data) ^ crc;
+			uint32_t two = load32LE(data + 4);
+			crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+				t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+			data += 8;
+			length -= 8;
+		}
+		while (length--)
+			crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+		return crc;
+	}
+
+	//MSB-first CRC-16, the register is folded into the first two bytes of each block
+	static uint32_t updateNormal16(const CrcTables& tables, uint32_t crc, const unsigned char* data, size_t length)
+	{
+		const uint32_t (*t)[256] = tables.m_table;
+		while (length >= 8)
+		{
+			crc = t[7][data[0] ^ (crc >> 8)] ^ t[6][data[1] ^ (crc & 0xFF)] ^ t[5][data[2]] ^ t[4][data[3]] ^
+				t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+			data += 8;
+			length -= 8;
+		}
+		while (length--)
+			crc = ((crc << 8) ^ t[0][((crc >> 8) ^ *data++) & 0xFF]) & 0xFFFF;
+		return crc;
+	}
+
+	Checksum::Checksum(ChecksumType type) :
+		m_type(type),
+		m_size(0),
+		m_crc(0)
+	{
+		switch (m_type)
+		{
+		case CK_LRC:
+			m_size = 1;
+			break;
+		case CK_CRC16_MODBUS:
+		case CK_CRC16_ARC:
+		case CK_CRC16_XMODEM:
+		case CK_CRC16_CCITT:
+			m_size = 2;
+			break;
+		case CK_CRC32:
+			m_size = 4;
+			break;
+		case CK_NONE:
+		default:
+			m_size = 0;
+			break;
+		}
+		reset();
+	}
+
+	void Checksum::reset()
+	{
+		switch (m_type)
+		{
+		case CK_CRC16_MODBUS:
+		case CK_CRC16_CCITT:
+			m_crc = 0xFFFF;
+			break;
+		case CK_CRC32:
+			m_crc = 0xFFFFFFFF;
+			break;
+		default:
+			m_crc = 0;
+			break;
+		}
+	}
+
+	void Checksum::update(const unsigned char* data, size_t length)
+	{
+		switch (m_type)
+		{
+		case CK_LRC:
+		{
+			unsigned char lrc = (unsigned char)m_crc;
+			for (size_t i = 0; i < length; i++)
+				lrc ^= data[i];
+			m_crc = lrc;
+		}
+		break;
+		case CK_CRC16_MODBUS:
+		case CK_CRC16_ARC:
+			m_crc = updateReflected(reflectedCrc16Tables(), m_crc, data, length);
+			break;
+		case CK_CRC16_XMODEM:
+		case CK_CRC16_CCITT:
+			m_crc = updateNormal16(ccittCrc16Tables(), m_crc, data, length);
+			break;
+		case CK_CRC32:
+			m_crc = updateReflected(crc32Tables(), m_crc, data, length);
+			break;
+		case CK_NONE:
+		default:
+			break;
+		}
+	}
+
+	uint32_t Checksum::value() const
+	{
+		return (m_type == CK_CRC32) ? ~m_crc : m_crc;
+	}
+
+	void Checksum::encode(unsigned char* out) const
+	{
+		uint32_t val = value();
+		switch (m_type)
+		{
+		case CK_CRC16_XMODEM:
+		case CK_CRC16_CCITT:
+			out[0] = (unsigned char)(val >> 8);
+			out[1] = (unsigned char)val;
+			break;
+		default:
+			for (unsigned int i = 0; i < m_size; i++)
+				out[i] = (unsigned char)(val >> (8 * i));
+			break;
+		}
+	}
+
+	bool Checksum::verify(const unsigned char* received) const
+	{
+		unsigned char expected[4];
+		encode(expected);
+		for (unsigned int i = 0; i < m_size; i++)
+			if (expected[i] != received[i])
+				return false;
+		return true;
+	}
+
+	bool Checksum::isValidCodeword() const
+	{
+		switch (m_type)
+		{
+		case CK_NONE:
+			return true;
+		case CK_CRC32:
+			return m_crc == 0xDEBB20E3; //register residue of the IEEE CRC-32 appended low byte first
+		default:
+			return m_crc == 0;
+		}
+	}
+
+	ChecksumType Checksum::fromName(const std::string& name)
+	{
+		if (boost::iequals(name, "LRC"))
+			return CK_LRC;
+		else if (boost::iequals(name, "CRC16_MODBUS"))
+			return CK_CRC16_MODBUS;
+		else if (boost::iequals(name, "CRC16_ARC"))
+			return CK_CRC16_ARC;
+		else if (boost::iequals(name, "CRC16_XMODEM"))
+			return CK_CRC16_XMODEM;
+		else if (boost::iequals(name, "CRC16_CCITT"))
+			return CK_CRC16_CCITT;
+		else if (boost::iequals(name, "CRC32"))
+			return CK_CRC32;
+		else
+			return CK_NONE;
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: incremental frame checksum (LRC, CRC-16 variants, CRC-32) with slicing-by-8 kernels
+*/
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace RS232
+{
+	enum ChecksumType
+	{
+		CK_NONE,
+		CK_LRC,				//XOR of all payload bytes
+		CK_CRC16_MODBUS,	//poly 0x8005 reflected, init 0xFFFF, sent low byte first
+		CK_CRC16_ARC,		//poly 0x8005 reflected, init 0x0000, sent low byte first
+		CK_CRC16_XMODEM,	//poly 0x1021, init 0x0000, sent high byte first
+		CK_CRC16_CCITT,		//poly 0x1021, init 0xFFFF (CCITT-FALSE), sent high byte first
+		CK_CRC32			//poly 0x04C11DB7 reflected (IEEE 802.3), sent low byte first
+	};
+
+	class Checksum
+	{
+	public:
+		explicit Checksum(ChecksumType type = CK_NONE);
+
+		void reset();
+
+		//accumulates the payload bytes, may be called for every received chunk of the frame
+		void update(const unsigned char* data, size_t length);
+
+		//final checksum value of the bytes accumulated since the last reset()
+		uint32_t value() const;
+
+		//number of checksum bytes on the wire
+		unsigned int size() const { return m_size; }
+
+		ChecksumType type() const { return m_type; }
+
+		//writes size() bytes of the checksum in wire order
+		void encode(unsigned char* out) const;
+
+		//compares the accumulated checksum against size() received bytes
+		bool verify(const unsigned char* received) const;
+
+		//true when the accumulated bytes end with their own valid checksum (CRC residue check)
+		bool isValidCodeword() const;
+
+		//parses the checksum attribute of the portProtocol node, CK_NONE for unknown names
+		static ChecksumType fromName(const std::string& name);
+
+	private:
+		ChecksumType m_type;
+		unsigned int m_size;
+		uint32_t m_crc;
+	};
+}
@@ -1,279 +1,494 @@
-#include "RS232_Device.h"
-#include "Base64.h"
-
-#include <sstream>
-
-#include <boost/algorithm/string.hpp>
-
-namespace RS232
-{
-	RS232_Device::RS232_Device(RS232_PortParams_Ptr portParams) :
-		m_portParams(portParams),
-		m_DLEReceived(false),
-		m_firstNonPrintableCharPos(0),
-		m_receiveStatus(WaitingForSTX),
-		m_tempEOD(0x00),
-		m_tempDelims("")
-	{
-		if (m_portParams->m_dcList.size() != 0)
-			m_receiveStatus = WaitingForSOD;
-		m_bufferSize = m_portParams->m_txBufferSize;
-	}
-
-	RS232_Device::~RS232_Device()
-	{
-		m_portHandler.reset();
-		m_portParams.reset();
-	}
-
-	void RS232_Device::openDevice()
-	{
-		m_portHandler = RS232_PortHandler_Ptr(new RS232_PortHandler(shared_from_this(), m_portParams));
-		if (m_portHandler.get())
-		{
-			if (m_portHandler->is_active())
-				m_portHandler->init();
-			else
-				std::thread(&RS232_PortHandler::waitForPortToBecomeAvailable, m_portHandler).detach();
-		}
-	}
-
-	void RS232_Device::closeDevice()
-	{
-		if (m_portHandler.get())
-			m_portHandler->close();
-	}
-
-	void RS232_Device::sendMessageToDevice(const unsigned char *data, unsigned int len)
-	{
-		std::lock_guard<std::mutex> lock(m_writeGuard);
-		//startStopResponseTimer();
-
-		std::string encapsulatedMsg = encapsulateMessage(std::string(reinterpret_cast<const char *>(data), len));
-		//constructHexAndLog(WriteData, encapsulatedMsg);
-		this->writeToPort(encapsulatedMsg);
-	}
-
-	void RS232_Device::sendMessageToDevice(const std::string& msg)
-	{
-		std::lock_guard<std::mutex> lock(m_writeGuard);
-		//startStopResponseTimer();
-
-		std::string encapsulatedMsg = encapsulateMessage(msg);
-		//constructHexAndLog(WriteData, encapsulatedMsg);
-		writeToPort(encapsulatedMsg);
-
-	}
-
-	void RS232_Device::on_read(const unsigned char *readData, unsigned int dataLength)
-	{
-		std::lock_guard<std::mutex> lock(m_readGuard);
-		//startStopResponseTimer(false);
-
-		try
-		{
-			for (unsigned int i = 0; i < dataLength; i++) //for all chars in string
-			{
-				char ch = readData[i];
-				//m_toBeLoggedBuffer.push_back(ch);
-				switch (m_receiveStatus)
-				{
-				case WaitingForSOD:
-				{
-					m_tempEOD = m_portParams->getEOD(ch);
-					if(m_tempEOD != ASCII_NULL)
-					{
-						std::cout << "RS232_Device::on_read() -> message read started for device type: " << m_portParams->getDataType(ch) << std::endl;
-						m_tempDelims = m_portParams->getDelims(ch);
-						m_receiveStatus = WaitingForSTX;
-					}
-				}
-				break;
-				case WaitingForSTX:
-				{
-					if (ch == m_portParams->m_STX)
-					{
-						if (m_portParams->m_dcList.size() == 0)
-						{
-							std::cout << "RS232_Device::on_read() -> message read started!" << std::endl;
-						}
-						m_receiveStatus = WaitingForETX;
-					}
-				}
-				break;
-				case WaitingForETX:
-				{
-					if (ch == m_portParams->m_ETX)
-					{
-						if (m_DLEReceived)
-						{
-							if (m_firstNonPrintableCharPos == 0 && (ch < ASCII_SP || ch > ASCII_TLDE))
-								m_firstNonPrintableCharPos = m_receivedMessageBuffer.size();
-
-							m_receivedMessageBuffer.push_back(ch);
-							m_DLEReceived = false;
-						}
-						else
-						{
-							if (m_portParams->m_dcList.size() > 0) //we will also wait for End Of Data (EOD)!
-							{
-								m_receiveStatus = WaitingForEOD;
-							}
-							else //end of receive!
-							{
-								//constructHexAndLog(ReadData, std::string(m_toBeLoggedBuffer.begin(), m_toBeLoggedBuffer.end())); //hex dump of received string
-								//m_toBeLoggedBuffer.clear();
-
-								if (m_portParams->m_CREnabled && m_receivedMessageBuffer.back() == ASCII_CR)
-								{
-									m_receivedMessageBuffer.pop_back();
-									if (m_firstNonPrintableCharPos == m_receivedMessageBuffer.size())
-									{	//the case we receive CR at the end of the data, we should not accidentally set the m_firstNonPrintableCharPos!
-										m_firstNonPrintableCharPos = 0;
-									}
-								}
-
-								std::string receivedMessageStr(m_receivedMessageBuffer.begin(), m_receivedMessageBuffer.end());
-								
-								printReceivedData(receivedMessageStr, m_firstNonPrintableCharPos);
-								
-								m_receiveStatus = WaitingForSTX; //NOT WaitingForSOD, because we did not set the SOD & EOD in the RS232.xml!
-
-								m_receivedMessageBuffer.clear();
-								m_DLEReceived = false;
-								m_firstNonPrintableCharPos = 0;
-							}
-						}
-					}
-					else if (m_portParams->m_DLEEnabled && !m_DLEReceived && ch == ASCII_DLE)
-					{	//removing ASCII_DLE (0x10) byte from the data!
-						m_DLEReceived = true;
-					}
-					else
-					{
-						if (m_firstNonPrintableCharPos == 0 && (ch < ASCII_SP || ch > ASCII_TLDE))
-							m_firstNonPrintableCharPos = m_receivedMessageBuffer.size();
-
-						m_receivedMessageBuffer.push_back(ch);
-						m_DLEReceived = false;
-					}
-				}
-				break;
-				case WaitingForEOD:
-				{
-					if (ch == m_tempEOD)
-					{
-						//constructHexAndLog(ReadData, std::string(m_toBeLoggedBuffer.begin(), m_toBeLoggedBuffer.end())); //hex dump of received string
-						//m_toBeLoggedBuffer.clear();
-
-						if (m_portParams->m_CREnabled && m_receivedMessageBuffer.back() == ASCII_CR)
-						{
-							m_receivedMessageBuffer.pop_back();
-							if (m_firstNonPrintableCharPos == m_receivedMessageBuffer.size())
-							{	//the case we receive CR at the end of the data, we should not accidentally set the m_firstNonPrintableCharPos!
-								m_firstNonPrintableCharPos = 0;
-							}
-						}
-
-						std::string receivedMessageStr(m_receivedMessageBuffer.begin(), m_receivedMessageBuffer.end());
-						printReceivedData(receivedMessageStr, m_firstNonPrintableCharPos);
-
-						m_receiveStatus = WaitingForSOD; //we have set SOD & EOD in the RS232.xml!
-						
-						m_receivedMessageBuffer.clear();
-						m_DLEReceived = false;
-						m_firstNonPrintableCharPos = 0;
-					}
-				}
-				break;
-				default:
-				{	//DO NOTHING!!! IT IS AN ERROR!
-					std::cout << "RS232_Device::on_read() -> read procedure is in an unexpected state!" << std::endl;
-				}
-				break;
-				}
-			}//for all received bytes
-		}
-		catch (...)
-		{
-			std::cout << "RS232_Device::on_read() -> Unknown exception occurred!!" << std::endl;
-		}
-	}
-
-	void RS232_Device::on_socket_error(PortError portError)
-	{
-		if (m_portHandler->is_active())
-			m_portHandler->close();
-
-		std::thread(&RS232_PortHandler::waitForPortToBecomeAvailable, m_portHandler).detach();
-	}
-
-	void RS232_Device::on_serialstate_changed(RS232_PinStatus pinStatus)
-	{
-		//std::stringstream o_str;
-		std::cout << "!!!serial status changed!!!" << std::endl;
-		std::cout << "Current Modem state is >> " << std::endl;
-		std::cout
-			<< "Modem CTS  Pin " << (pinStatus.m_CTS_on ? "Active" : "Deactive") << std::endl
-			<< "Modem DSR  Pin " << (pinStatus.m_DSR_on ? "Active" : "Deactive") << std::endl
-			<< "Modem Ring Pin " << (pinStatus.m_RI_on ? "Active" : "Deactive") << std::endl
-			<< "Modem RLSD Pin " << (pinStatus.m_RLSD_on ? "Active" : "Deactive") << std::endl;
-	}
-
-	std::string RS232_Device::encapsulateMessage(const std::string& message)
-	{
-		std::string str;
-		str += m_portParams->m_STX;
-		if (m_portParams->m_DLEEnabled)
-		{
-			for (unsigned char data : message)
-			{
-				if (data < ASCII_SP && data >= ASCII_NULL)
-					str += ASCII_DLE;
-				str += data;
-			}
-		}
-		else
-		{
-			str += message;
-		}
-		str += m_portParams->m_ETX;
-		return str;
-	}
-
-	void RS232_Device::printReceivedData(const std::string& receivedData, unsigned int firstNonPrintableCharPos)
-	{
-		std::cout << "[Received Data]" << std::endl;
-		if (m_tempDelims.size())
-		{
-			std::vector<std::string> trackDataVector;
-			boost::split(trackDataVector, receivedData, [=](char ch) {return m_tempDelims.find(ch) != std::string::npos; });
-			trackDataVector.erase(
-				std::remove_if(
-					trackDataVector.begin(),
-					trackDataVector.end(),
-					[](std::string iter) {return iter.empty(); }),
-				trackDataVector.end());
-
-			for (auto iter : trackDataVector)
-				std::cout << iter << std::endl;
-
-			m_tempDelims.clear();
-
-		}
-		else if (firstNonPrintableCharPos > 0)
-		{
-			std::string msgTillNonPrintable = receivedData.substr(0, firstNonPrintableCharPos);
-			std::cout << "Printable Part: " << msgTillNonPrintable << std::endl;
-			std::string msgAfterNonPrintable = receivedData.substr(firstNonPrintableCharPos);
-			std::string encodedBinaryMsg = Base64::Encode((const unsigned char*)msgAfterNonPrintable.c_str(), msgAfterNonPrintable.size());
-
-			std::cout << "Non-Printable Part (Base64-Encoded): " << encodedBinaryMsg << std::endl;
-		}
-		else
-		{
-			std::cout << receivedData << std::endl;
-		}
-	}
-
-}
+#include "RS232_Device.h"
+#include "Base64.h"
+#include "RS232_Journal.h"
+#include "RS232_FrameOutput.h"
+#include "RS232_TrafficLogger.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace RS232
+{
+	RS232_Device::RS232_Device(RS232_PortParams_Ptr portParams) :
+		m_portParams(portParams),
+		m_receivedFrames(0),
+		m_frameQueue(portParams),
+		m_frameRouter(portParams)
+	{
+		m_frameRouter.setDefaultSink([this](const RS232_Frame& frame)
+		{
+			if (RS232_FrameOutput::getInstance()->isOpen())
+				RS232_FrameOutput::getInstance()->write(m_portParams->m_comPort, frame);
+			else
+				printReceivedData(frame.m_data, frame.m_info);
+		});
+
+		m_framer = RS232_Framer::create(m_portParams, [this](RS232_SegmentedBuffer& frame, const RS232_FrameInfo& frameInfo)
+		{
+			deliverFrame(frame, frameInfo);
+		});
+		m_bufferSize = m_portParams->m_txBufferSize;
+
+		if (m_portParams->m_halfDuplexMode != HD_NONE)
+			m_echoCanceller = RS232_EchoCanceller_Ptr(new RS232_EchoCanceller(m_portParams));
+
+		if (m_portParams->m_flowHighWatermark > 0)
+		{	//the sender is stopped by the fill level of the receive queue, before the driver buffer fills up
+			m_frameQueue.setFlowHandler([this](bool throttle)
+			{
+				RS232_PortHandler_Ptr portHandler = getPortHandler();
+				if (portHandler.get())
+					portHandler->throttleInput(throttle);
+			});
+		}
+
+		if (m_portParams->m_addressSize > 0)
+			m_multidrop = RS232_Multidrop_Ptr(new RS232_Multidrop(m_portParams));
+
+		if (m_portParams->m_busSize > 0)
+			m_frameBus = RS232_FrameBus::create(m_portParams->m_comPort, m_portParams->m_busSize);
+
+		if (!m_portParams->m_gatewaySocketPath.empty())
+		{
+			m_gateway = RS232_Gateway_Ptr(new RS232_Gateway(m_portParams->m_gatewaySocketPath, m_portParams->m_gatewayClientQueue, [this](const std::string& message)
+			{
+				sendMessageToDevice(message);
+			}));
+		}
+	}
+
+	RS232_Device::~RS232_Device()
+	{
+		if (m_gateway.get())
+			m_gateway->stop();
+		if (m_asyncChannel.get())
+			m_asyncChannel->close();
+		m_frameRouter.stop(); //releases the consumer thread waiting for room in a route
+		stopConsumer();
+		releasePortHandler();
+		m_portParams.reset();
+	}
+
+	void RS232_Device::openDevice()
+	{
+		if (!m_consumerThread.joinable())
+		{
+			m_frameQueue.reopen();
+			if (m_asyncChannel.get())
+				m_asyncChannel->open();
+			m_frameRouter.start();
+			if (m_multidrop.get())
+				m_multidrop->setDispatching(true);
+			m_consumerThread = std::thread(&RS232_Device::consumeFrames, this);
+		}
+
+		if (m_gateway.get())
+			m_gateway->start();
+
+		releasePortHandler(); //the port is opened exclusively, a handler still holding it has to let it go first
+		RS232_PortHandler_Ptr portHandler = RS232_PortHandler_Ptr(new RS232_PortHandler(shared_from_this(), m_portParams));
+		{
+			std::lock_guard<std::mutex> lock(m_subscribersGuard);
+			std::lock_guard<std::mutex> handlerLock(m_guard);
+			m_portHandler = portHandler;
+			for (const RS232_PortSubscriber_Ptr& subscriber : m_portSubscribers)
+				m_portHandler->addSubscriber(subscriber);
+		}
+		if (portHandler->is_active())
+			portHandler->init();
+		else
+			portHandler->reconnect();
+	}
+
+	void RS232_Device::closeDevice()
+	{
+		releasePortHandler();
+		if (m_gateway.get())
+			m_gateway->stop();
+		if (m_asyncChannel.get())
+			m_asyncChannel->close(); //releases the consumer thread waiting for an operation
+		m_frameRouter.stop(); //& the one waiting for room in a route
+		stopConsumer();
+		if (m_multidrop.get())
+			m_multidrop->setDispatching(false); //the consumer thread is joined, drops may be attached again
+	}
+
+	void RS232_Device::releasePortHandler()
+	{
+		RS232_PortHandler_Ptr portHandler = getPortHandler();
+		if (!portHandler.get())
+			return;
+
+		//outside the locks: a write waiting for the line holds m_guard until close() cancels it & the reader may call back until it is joined
+		portHandler->close();
+
+		std::lock_guard<std::mutex> lock(m_subscribersGuard);
+		std::lock_guard<std::mutex> handlerLock(m_guard);
+		if (m_portHandler == portHandler)
+			m_portHandler.reset(); //the handler holds the device as a subscriber, the cycle is broken here
+	}
+
+	RS232_PortHandler_Ptr RS232_Device::getPortHandler() const
+	{
+		std::lock_guard<std::mutex> lock(m_subscribersGuard);
+		return m_portHandler;
+	}
+
+	void RS232_Device::stopConsumer()
+	{
+		m_frameQueue.close();
+		if (m_consumerThread.joinable() && m_consumerThread.get_id() != std::this_thread::get_id())
+			m_consumerThread.join();
+	}
+
+	void RS232_Device::consumeFrames()
+	{
+		RS232_Frame frame;
+		while (m_frameQueue.pop(frame))
+		{
+			try
+			{
+				if (m_multidrop.get() && m_multidrop->dispatch(frame))
+					continue; //taken by the sink of its drop
+				if (m_asyncChannel.get())
+					m_asyncChannel->deliver(std::move(frame));
+				else
+					m_frameRouter.dispatch(std::move(frame));
+			}
+			catch (...)
+			{
+				std::cout << "RS232_Device::consumeFrames() -> Unknown exception occurred!!" << std::endl;
+			}
+		}
+	}
+
+	bool RS232_Device::sendMessageToDevice(const unsigned char *data, unsigned int len, TxPriority priority)
+	{
+		return sendMessageToDevice(std::string(reinterpret_cast<const char *>(data), len), priority);
+	}
+
+	bool RS232_Device::sendMessageToDevice(const std::string& msg, TxPriority priority)
+	{
+		//startStopResponseTimer();
+
+		//encapsulated before queueing, the line is held only for the write itself
+		std::string encapsulatedMsg = encapsulateMessage(msg);
+		bool written = false;
+		m_txScheduler.send(priority, (unsigned int)encapsulatedMsg.size(), [&]()
+		{
+			RS232_TrafficLogger::getInstance()->log(TD_TX, m_portParams->m_comPort, (const unsigned char*)encapsulatedMsg.data(), (unsigned int)encapsulatedMsg.size());
+			written = writeToPort(encapsulatedMsg);
+		});
+		return written;
+	}
+
+	void RS232_Device::on_read(const unsigned char *readData, unsigned int dataLength, FrameTime readTime)
+	{
+		std::lock_guard<std::mutex> lock(m_readGuard);
+		//startStopResponseTimer(false);
+
+		RS232_TrafficLogger::getInstance()->log(TD_RX, m_portParams->m_comPort, readData, dataLength);
+		try
+		{
+			if (m_echoCanceller.get())
+			{
+				m_echoCanceller->filter(readData, dataLength, readTime, [this](const unsigned char* data, unsigned int length, FrameTime lastByteTime)
+				{
+					m_framer->push(data, length, lastByteTime);
+				});
+			}
+			else
+			{
+				m_framer->push(readData, dataLength, readTime);
+			}
+		}
+		catch (...)
+		{
+			std::cout << "RS232_Device::on_read() -> Unknown exception occurred!!" << std::endl;
+		}
+	}
+
+	RS232_FrameStats RS232_Device::getFrameStats() const
+	{
+		RS232_FrameStats stats;
+		stats.m_receivedFrames = m_receivedFrames;
+		stats.m_badChecksumFrames = m_framer->getBadChecksumFrames();
+		stats.m_malformedFrames = m_framer->getMalformedFrames();
+		return stats;
+	}
+
+	RS232_ReadStats RS232_Device::getReadStats() const
+	{
+		RS232_PortHandler_Ptr portHandler = getPortHandler();
+		if (portHandler.get())
+			return portHandler->getReadStats();
+		return RS232_ReadStats();
+	}
+
+	RS232_FlowStats RS232_Device::getFlowStats() const
+	{
+		RS232_PortHandler_Ptr portHandler = getPortHandler();
+		if (portHandler.get())
+			return portHandler->getFlowStats();
+		return RS232_FlowStats();
+	}
+
+	RS232_ErrorStats RS232_Device::getErrorStats() const
+	{
+		RS232_PortHandler_Ptr portHandler = getPortHandler();
+		if (portHandler.get())
+			return portHandler->getErrorStats();
+		return RS232_ErrorStats();
+	}
+
+	RS232_RtsToggleStats RS232_Device::getRtsToggleStats() const
+	{
+		RS232_PortHandler_Ptr portHandler = getPortHandler();
+		if (portHandler.get())
+			return portHandler->getRtsToggleStats();
+		return RS232_RtsToggleStats();
+	}
+
+	RS232_EchoStats RS232_Device::getEchoStats() const
+	{
+		if (m_echoCanceller.get())
+			return m_echoCanceller->getStats();
+		return RS232_EchoStats();
+	}
+
+	RS232_QueueStats RS232_Device::getQueueStats() const
+	{
+		return m_frameQueue.getStats();
+	}
+
+	RS232_GatewayStats RS232_Device::getGatewayStats() const
+	{
+		if (m_gateway.get())
+			return m_gateway->getStats();
+		return RS232_GatewayStats();
+	}
+
+	RS232_TxStats RS232_Device::getTxStats() const
+	{
+		return m_txScheduler.getStats();
+	}
+
+	std::vector<RS232_LogicalDeviceStats> RS232_Device::getLogicalDeviceStats() const
+	{
+		if (m_multidrop.get())
+			return m_multidrop->getStats();
+		return std::vector<RS232_LogicalDeviceStats>();
+	}
+
+	RS232_LogicalDevice_Ptr RS232_Device::attachLogicalDevice(unsigned int address)
+	{
+		if (!m_multidrop.get())
+		{
+			std::cout << "RS232_Device::attachLogicalDevice() -> " << m_portParams->m_comPort << " has no address field!" << std::endl;
+			return RS232_LogicalDevice_Ptr();
+		}
+
+		std::weak_ptr<RS232_Device> device = shared_from_this(); //the logical device may outlive the device
+		return m_multidrop->attach(address, [device](const std::string& message, TxPriority priority)
+		{
+			RS232_Device_Ptr sender = device.lock();
+			if (sender.get())
+				sender->sendMessageToDevice(message, priority);
+		});
+	}
+
+	void RS232_Device::addPortSubscriber(RS232_PortSubscriber_Ptr subscriber)
+	{
+		std::lock_guard<std::mutex> lock(m_subscribersGuard);
+		if (std::find(m_portSubscribers.begin(), m_portSubscribers.end(), subscriber) != m_portSubscribers.end())
+			return;
+		m_portSubscribers.push_back(subscriber);
+		if (m_portHandler.get())
+			m_portHandler->addSubscriber(subscriber);
+	}
+
+	void RS232_Device::removePortSubscriber(const RS232_PortSubscriber_Ptr& subscriber)
+	{
+		std::lock_guard<std::mutex> lock(m_subscribersGuard);
+		m_portSubscribers.erase(std::remove(m_portSubscribers.begin(), m_portSubscribers.end(), subscriber), m_portSubscribers.end());
+		if (m_portHandler.get())
+			m_portHandler->removeSubscriber(subscriber);
+	}
+
+	void RS232_Device::setExecutor(RS232_Executor_Ptr executor)
+	{
+		if (!executor.get())
+			executor = std::make_shared<RS232_EventLoop>();
+
+		m_asyncChannel = RS232_AsyncChannel_Ptr(new RS232_AsyncChannel(executor, [this](const std::string& message)
+		{
+			return sendMessageToDevice(message);
+		}));
+	}
+
+	void RS232_Device::asyncNextFrame(DWORD timeoutMillis, RS232_AsyncChannel::FrameHandler frameHandler)
+	{
+		if (!m_asyncChannel.get())
+		{
+			std::cout << "RS232_Device::asyncNextFrame() -> no executor is set!" << std::endl;
+			frameHandler(RS232_AsyncFrame());
+			return;
+		}
+		m_asyncChannel->asyncNextFrame(timeoutMillis, frameHandler);
+	}
+
+	void RS232_Device::asyncSend(const std::string& msg, RS232_AsyncChannel::SendHandler sendHandler)
+	{
+		if (!m_asyncChannel.get())
+		{
+			std::cout << "RS232_Device::asyncSend() -> no executor is set!" << std::endl;
+			sendHandler(AS_CLOSED);
+			return;
+		}
+		m_asyncChannel->asyncSend(msg, sendHandler);
+	}
+
+	void RS232_Device::asyncRequest(const std::string& msg, DWORD timeoutMillis, RS232_AsyncChannel::FrameHandler frameHandler)
+	{
+		if (!m_asyncChannel.get())
+		{
+			std::cout << "RS232_Device::asyncRequest() -> no executor is set!" << std::endl;
+			frameHandler(RS232_AsyncFrame());
+			return;
+		}
+		m_asyncChannel->asyncRequest(msg, timeoutMillis, frameHandler);
+	}
+
+	RS232_Awaitable<RS232_AsyncFrame> RS232_Device::nextFrame(DWORD timeoutMillis)
+	{
+		return RS232_Awaitable<RS232_AsyncFrame>([this, timeoutMillis](std::function<void(RS232_AsyncFrame)> resume)
+		{
+			asyncNextFrame(timeoutMillis, resume);
+		});
+	}
+
+	RS232_Awaitable<AsyncStatus> RS232_Device::send(const std::string& msg)
+	{
+		return RS232_Awaitable<AsyncStatus>([this, msg](std::function<void(AsyncStatus)> resume)
+		{
+			asyncSend(msg, resume);
+		});
+	}
+
+	RS232_Awaitable<RS232_AsyncFrame> RS232_Device::request(const std::string& msg, DWORD timeoutMillis)
+	{
+		return RS232_Awaitable<RS232_AsyncFrame>([this, msg, timeoutMillis](std::function<void(RS232_AsyncFrame)> resume)
+		{
+			asyncRequest(msg, timeoutMillis, resume);
+		});
+	}
+
+	void RS232_Device::deliverFrame(RS232_SegmentedBuffer& frame, const RS232_FrameInfo& frameInfo)
+	{
+		m_receivedFrames++;
+
+		//journaled before the queue, so the overflow policy cannot lose it
+		RS232_Journal::getInstance()->append(m_portParams->m_comPort, frame);
+
+		if (m_frameBus.get() && !m_frameBus->publish(frame, frameInfo.m_firstNonPrintableCharPos))
+			std::cout << "RS232_Device::deliverFrame() -> frame of " << frame.size() << " bytes does not fit in the frame bus!" << std::endl;
+
+		if (m_gateway.get())
+			m_gateway->publish(frame);
+
+		RS232_Frame receivedFrame;
+		receivedFrame.m_data = std::move(frame); //the segments are handed over, the framer starts a new chain
+		receivedFrame.m_info = frameInfo;
+		m_frameQueue.push(std::move(receivedFrame));
+	}
+
+	void RS232_Device::on_socket_error(PortError portError)
+	{
+		//the port handler opens the port again by itself once it is available
+		std::cout << "RS232_Device::on_socket_error() -> " << m_portParams->m_comPort << " error: " << portError << std::endl;
+	}
+
+	void RS232_Device::on_idle()
+	{
+		std::lock_guard<std::mutex> lock(m_readGuard);
+		m_framer->poll(FrameClock::now());
+	}
+
+	DWORD RS232_Device::getIdleTimeout() const
+	{
+		return m_framer->getIdleTimeout();
+	}
+
+	void RS232_Device::on_tx_start(const unsigned char* data, unsigned int length, FrameTime txStart)
+	{
+		//the write lock is held, the time does not include the wait for the line or a write of another thread in front of it
+		if (m_echoCanceller.get())
+			m_echoCanceller->expect(data, length, txStart);
+	}
+
+	void RS232_Device::on_serialstate_changed(RS232_PinStatus pinStatus)
+	{
+		//std::stringstream o_str;
+		std::cout << "!!!serial status changed!!!" << std::endl;
+		std::cout << "Current Modem state is >> " << std::endl;
+		std::cout
+			<< "Modem CTS  Pin " << (pinStatus.m_CTS_on ? "Active" : "Deactive") << std::endl
+			<< "Modem DSR  Pin " << (pinStatus.m_DSR_on ? "Active" : "Deactive") << std::endl
+			<< "Modem Ring Pin " << (pinStatus.m_RI_on ? "Active" : "Deactive") << std::endl
+			<< "Modem RLSD Pin " << (pinStatus.m_RLSD_on ? "Active" : "Deactive") << std::endl;
+	}
+
+	std::string RS232_Device::encapsulateMessage(const std::string& message)
+	{
+		return m_framer->encapsulate(message);
+	}
+
+	void RS232_Device::printReceivedData(const RS232_SegmentedBuffer& receivedData, const RS232_FrameInfo& frameInfo)
+	{
+		unsigned int firstNonPrintableCharPos = frameInfo.m_firstNonPrintableCharPos;
+
+		std::cout << "[Received Data]" << std::endl;
+		if (frameInfo.m_address != NO_DROP_ADDRESS)
+			std::cout << "Address: " << frameInfo.m_address << std::endl;
+		if (frameInfo.m_dataControl.get() && !frameInfo.m_dataControl->m_delimSet.empty())
+		{
+			std::string scratch;
+			RS232_BufferView data = receivedData.getContiguous(scratch);
+			TrackTokenizer tokenizer(frameInfo.m_dataControl->m_delimSet, (const char*)data.m_data, data.m_length);
+			boost::string_view trackData;
+			while (tokenizer.next(trackData))
+				std::cout.write(trackData.data(), trackData.size()) << std::endl;
+		}
+		else if (firstNonPrintableCharPos != NO_NON_PRINTABLE_CHAR)
+		{
+			if (firstNonPrintableCharPos > 0)
+			{
+				std::cout << "Printable Part: ";
+				writeSegments(receivedData, firstNonPrintableCharPos);
+				std::cout << std::endl;
+			}
+			std::vector<unsigned char> msgAfterNonPrintable(receivedData.size() - firstNonPrintableCharPos);
+			receivedData.copyTo(msgAfterNonPrintable.data(), firstNonPrintableCharPos, msgAfterNonPrintable.size());
+			std::string encodedBinaryMsg = Base64::Encode(msgAfterNonPrintable.data(), (unsigned int)msgAfterNonPrintable.size());
+
+			std::cout << "Non-Printable Part (Base64-Encoded): " << encodedBinaryMsg << std::endl;
+		}
+		else
+		{
+			writeSegments(receivedData, receivedData.size());
+			std::cout << std::endl;
+		}
+	}
+
+	void RS232_Device::writeSegments(const RS232_SegmentedBuffer& receivedData, size_t length)
+	{
+		for (size_t i = 0; i < receivedData.getSegmentCount() && length > 0; i++)
+		{
+			RS232_BufferView segment = receivedData.getSegment(i);
+			size_t chunk = std::min(length, segment.m_length);
+			std::cout.write((const char*)segment.m_data, chunk);
+			length -= chunk;
+		}
+	}
+
+}
@@ -1,56 +1,169 @@
-/*
-@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
-* @version 1.0
-* @since   09-07-2018
-* @Purpose: manages the RS232 Serial Device read/write/status update
-*/
-
-#include "RS232_PortHandler.h"
-
-namespace RS232
-{
-	class RS232_Device : public RS232_PortSubscriber, public std::enable_shared_from_this<RS232_Device>
-	{
-	public:
-		RS232_Device(RS232_PortParams_Ptr);
-		virtual ~RS232_Device();
-
-		void sendMessageToDevice(const unsigned char *data, unsigned int len);
-
-		void sendMessageToDevice(const std::string& msg);
-
-		void openDevice();
-		void closeDevice();
-
-	private:
-		/*inherited from RS232_PortSubscriber*/
-		void on_read(const unsigned char *readData, unsigned int dataLength) override;
-
-		void on_socket_error(PortError portError) override;
-
-		void on_serialstate_changed(RS232_PinStatus pinStatus) override;
-
-		std::string encapsulateMessage(const std::string& message);
-
-		void printReceivedData(const std::string& receivedData, unsigned int firstNonPrintableCharPos);
-
-		RS232_PortParams_Ptr m_portParams;
-
-		/*to protect writing/reading processes from multiple access*/
-		std::mutex m_writeGuard;
-		std::mutex m_readGuard;
-
-		ReceiveStatus m_receiveStatus;
-		std::vector<char> m_receivedMessageBuffer;
-		bool m_DLEReceived;
-		unsigned int m_firstNonPrintableCharPos;
-
-		char m_tempEOD;
-		std::string m_tempDelims;
-
-		RS232_Device(const RS232_Device&) = delete;
-
-	};
-	using RS232_Device_Ptr = std::shared_ptr<RS232_Device>;
-}
-
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   09-07-2018
+* @Purpose: manages the RS232 Serial Device read/write/status update
+*/
+
+#include "RS232_PortHandler.h"
+#include "RS232_Framer.h"
+#include "RS232_FrameQueue.h"
+#include "RS232_FrameBus.h"
+#include "RS232_Gateway.h"
+#include "RS232_Async.h"
+#include "RS232_FrameRouter.h"
+#include "RS232_TxScheduler.h"
+#include "RS232_Multidrop.h"
+#include "RS232_EchoCanceller.h"
+
+#include <atomic>
+#include <thread>
+
+namespace RS232
+{
+	/*received frame counters of a device*/
+	struct RS232_FrameStats
+	{
+		unsigned long long m_receivedFrames = 0;
+		unsigned long long m_badChecksumFrames = 0; //dropped because of checksum mismatch
+		unsigned long long m_malformedFrames = 0; //dropped because of framing errors (e.g. RTU inter-character gap)
+	};
+
+	class RS232_Device : public RS232_PortSubscriber, public std::enable_shared_from_this<RS232_Device>
+	{
+	public:
+		RS232_Device(RS232_PortParams_Ptr);
+		virtual ~RS232_Device();
+
+		//blocks until the frame is written, a TP_HIGH frame goes out before the TP_NORMAL frames waiting for the line
+		bool sendMessageToDevice(const unsigned char *data, unsigned int len, TxPriority priority = TP_NORMAL);
+
+		bool sendMessageToDevice(const std::string& msg, TxPriority priority = TP_NORMAL);
+
+		void openDevice();
+		void closeDevice();
+
+		RS232_FrameStats getFrameStats() const;
+
+		RS232_ReadStats getReadStats() const;
+
+		RS232_FlowStats getFlowStats() const;
+
+		RS232_ErrorStats getErrorStats() const;
+
+		RS232_RtsToggleStats getRtsToggleStats() const;
+
+		RS232_EchoStats getEchoStats() const;
+
+		RS232_QueueStats getQueueStats() const;
+
+		RS232_GatewayStats getGatewayStats() const;
+
+		RS232_TxStats getTxStats() const;
+
+		//the attached drops of a multidrop line, empty for a single peer
+		std::vector<RS232_LogicalDeviceStats> getLogicalDeviceStats() const;
+
+		//handlers per dataControl type, the default sink prints the frames
+		RS232_FrameRouter& getFrameRouter() { return m_frameRouter; }
+
+		/*
+		* multidrop line (addressSize > 0): the logical device of the drop with the address, to be called before openDevice(),
+		* NULL when the port has no address field, the address does not fit in it or the device is open
+		*/
+		RS232_LogicalDevice_Ptr attachLogicalDevice(unsigned int address);
+
+		/*further subscribers of the port next to the device itself (e.g. a logger), kept when the port is re-opened*/
+		void addPortSubscriber(RS232_PortSubscriber_Ptr subscriber);
+		void removePortSubscriber(const RS232_PortSubscriber_Ptr& subscriber);
+
+		/*
+		* to be called before openDevice(): the received frames are handed to the asynchronous operations instead of being printed,
+		* the completions run on the executor (NULL gives the device an event loop of its own)
+		*/
+		void setExecutor(RS232_Executor_Ptr executor);
+
+		void asyncNextFrame(DWORD timeoutMillis, RS232_AsyncChannel::FrameHandler frameHandler);
+
+		void asyncSend(const std::string& msg, RS232_AsyncChannel::SendHandler sendHandler);
+
+		void asyncRequest(const std::string& msg, DWORD timeoutMillis, RS232_AsyncChannel::FrameHandler frameHandler);
+
+		/*co_await device->nextFrame(), co_await device->send(msg), co_await device->request(msg, timeout)*/
+		RS232_Awaitable<RS232_AsyncFrame> nextFrame(DWORD timeoutMillis = INFINITE);
+
+		RS232_Awaitable<AsyncStatus> send(const std::string& msg);
+
+		RS232_Awaitable<RS232_AsyncFrame> request(const std::string& msg, DWORD timeoutMillis);
+
+		//text printout of a received frame, used unless the binary frame output is open
+		static void printReceivedData(const RS232_SegmentedBuffer& receivedData, const RS232_FrameInfo& frameInfo);
+
+		//writes the first length bytes to std::cout segment by segment
+		static void writeSegments(const RS232_SegmentedBuffer& receivedData, size_t length);
+
+	private:
+		/*inherited from RS232_PortSubscriber*/
+		void on_read(const unsigned char *readData, unsigned int dataLength, FrameTime readTime) override;
+
+		void on_socket_error(PortError portError) override;
+
+		void on_serialstate_changed(RS232_PinStatus pinStatus) override;
+
+		void on_idle() override;
+
+		DWORD getIdleTimeout() const override;
+
+		void on_tx_start(const unsigned char* data, unsigned int length, FrameTime txStart) override;
+
+		std::string encapsulateMessage(const std::string& message);
+
+		/*common path of the frames of all framing modes*/
+		void deliverFrame(RS232_SegmentedBuffer& frame, const RS232_FrameInfo& frameInfo);
+
+		/*consumer thread: takes the frames out of the receive queue & routes them*/
+		void consumeFrames();
+
+		void stopConsumer();
+
+		//closes & drops the port handler, its threads are joined
+		void releasePortHandler();
+
+		//copy of the current port handler taken under the lock, NULL while the device is closed
+		RS232_PortHandler_Ptr getPortHandler() const;
+
+		RS232_PortParams_Ptr m_portParams;
+
+		/*to protect writing/reading processes from multiple access*/
+		RS232_TxScheduler m_txScheduler; //one frame on the line at a time, taken from the transmit lanes by priority
+		std::mutex m_readGuard;
+
+		RS232_Framer_Ptr m_framer; //splits the received data into frames according to the configured framing mode
+
+		RS232_EchoCanceller_Ptr m_echoCanceller; //half duplex: our echo is removed before the framer, NULL for full duplex
+
+		std::atomic<unsigned long long> m_receivedFrames;
+
+		RS232_FrameQueue m_frameQueue; //bounded, decouples the reader thread from a slow consumer
+		std::thread m_consumerThread;
+
+		RS232_FrameRouter m_frameRouter;
+
+		RS232_FrameBus_Ptr m_frameBus; //frames published to the local reader processes, NULL when disabled
+
+		RS232_Gateway_Ptr m_gateway; //port exposed over a Unix domain socket, NULL when disabled
+
+		RS232_AsyncChannel_Ptr m_asyncChannel; //NULL unless setExecutor() is called
+
+		RS232_Multidrop_Ptr m_multidrop; //frames demultiplexed by the address field, NULL for a single peer
+
+		mutable std::mutex m_subscribersGuard; //guards m_portSubscribers & m_portHandler
+		std::vector<RS232_PortSubscriber_Ptr> m_portSubscribers;
+
+		RS232_Device(const RS232_Device&) = delete;
+
+	};
+	using RS232_Device_Ptr = std::shared_ptr<RS232_Device>;
+}
+
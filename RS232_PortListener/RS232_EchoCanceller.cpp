@@ -0,0 +1,123 @@
+#include "RS232_EchoCanceller.h"
+
+#include <algorithm>
+
+namespace RS232
+{
+	RS232_EchoCanceller::RS232_EchoCanceller(RS232_PortParams_Ptr portParams) :
+		m_portParams(portParams),
+		m_charTime(std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::micro>(portParams->getCharTimeMicros()))),
+		m_awaitingReply(false),
+		m_totalTurnaroundMicros(0)
+	{
+	}
+
+	void RS232_EchoCanceller::expect(const unsigned char* data, unsigned int length, FrameTime txStart)
+	{
+		if (length == 0)
+			return;
+
+		FrameTime wireEnd = txStart + m_charTime * length;
+		std::lock_guard<std::mutex> lock(m_guard);
+		m_lastTxEnd = wireEnd;
+		m_awaitingReply = true;
+		if (!m_portParams->m_echoCancel)
+			return; //the adapter does not listen to its own line, only the turnaround is measured
+
+		PendingEcho echo;
+		echo.m_bytes.assign((const char*)data, length);
+		echo.m_matched = 0;
+		echo.m_firstByteEnd = txStart + m_charTime;
+		echo.m_expiry = wireEnd + std::chrono::milliseconds(m_portParams->m_echoTimeoutMillis);
+		m_pending.push_back(std::move(echo));
+	}
+
+	void RS232_EchoCanceller::filter(const unsigned char* data, unsigned int length, FrameTime readTime, const DataHandler& dataHandler)
+	{
+		m_runs.clear();
+		m_runTimes.clear();
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			FrameTime firstByteEnd = readTime - m_charTime * (length > 0 ? length - 1 : 0);
+			while (!m_pending.empty() && m_pending.front().m_expiry < firstByteEnd)
+			{
+				m_stats.m_missingEchoBytes += m_pending.front().m_bytes.size() - m_pending.front().m_matched;
+				m_pending.pop_front();
+			}
+
+			unsigned int runStart = 0;
+			for (unsigned int i = 0; i < length; i++)
+			{
+				bool echoByte = false;
+				while (!m_pending.empty())
+				{
+					PendingEcho& echo = m_pending.front();
+					bool matches = ((unsigned char)echo.m_bytes[echo.m_matched] == data[i]);
+					if (matches || (echo.m_matched == 0 && readTime - m_charTime * (length - 1 - i) >= echo.m_firstByteEnd))
+					{	//our own byte, the first one is taken even if a collision changed it
+						if (matches)
+							m_stats.m_echoedBytes++;
+						else
+							m_stats.m_corruptedEchoBytes++;
+						if (++echo.m_matched == echo.m_bytes.size())
+							m_pending.pop_front();
+						echoByte = true;
+						break;
+					}
+					if (echo.m_matched == 0)
+						break; //received before our first byte could be back
+
+					//the echo broke off (a collision or the other side talking over us): the rest is given up, the byte is data unless a later echo starts with it
+					m_stats.m_corruptedEchoBytes += echo.m_bytes.size() - echo.m_matched;
+					m_pending.pop_front();
+				}
+
+				if (echoByte)
+				{	//hand on the data in front of it
+					if (i > runStart)
+					{
+						m_runs.push_back({ data + runStart, i - runStart });
+						m_runTimes.push_back(readTime - m_charTime * (length - i));
+					}
+					runStart = i + 1;
+					continue;
+				}
+
+				if (m_awaitingReply && m_pending.empty())
+					recordTurnaround(readTime - m_charTime * (length - i)); //start bit of the first reply byte
+			}
+			if (length > runStart)
+			{
+				m_runs.push_back({ data + runStart, length - runStart });
+				m_runTimes.push_back(readTime);
+			}
+		}
+
+		//outside the lock: the frame handlers may send (& expect an echo) from this thread
+		for (size_t i = 0; i < m_runs.size(); i++)
+			dataHandler(m_runs[i].m_data, (unsigned int)m_runs[i].m_length, m_runTimes[i]);
+	}
+
+	void RS232_EchoCanceller::recordTurnaround(FrameTime replyStart)
+	{
+		m_awaitingReply = false;
+		if (replyStart < m_lastTxEnd)
+			return; //the reply began before we stopped sending, not a turnaround
+
+		unsigned long long turnaroundMicros = (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(replyStart - m_lastTxEnd).count();
+		m_stats.m_turnarounds++;
+		m_totalTurnaroundMicros += turnaroundMicros;
+		if (m_stats.m_turnarounds == 1 || turnaroundMicros < m_stats.m_minTurnaroundMicros)
+			m_stats.m_minTurnaroundMicros = turnaroundMicros;
+		m_stats.m_maxTurnaroundMicros = std::max(m_stats.m_maxTurnaroundMicros, turnaroundMicros);
+	}
+
+	RS232_EchoStats RS232_EchoCanceller::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		RS232_EchoStats stats = m_stats;
+		if (stats.m_turnarounds > 0)
+			stats.m_averageTurnaroundMicros = (double)m_totalTurnaroundMicros / stats.m_turnarounds;
+		return stats;
+	}
+}
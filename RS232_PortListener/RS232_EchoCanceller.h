@@ -0,0 +1,82 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: removes the echo of the sent bytes from the received data of a half duplex (RS-485) line & measures the bus turnaround
+*/
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "RS232_Util.h"
+
+namespace RS232
+{
+	/*echo & turnaround counters of a half duplex line*/
+	struct RS232_EchoStats
+	{
+		unsigned long long m_echoedBytes = 0; //removed from the received data
+		unsigned long long m_missingEchoBytes = 0; //sent bytes whose echo did not arrive within the echo timeout
+		unsigned long long m_corruptedEchoBytes = 0; //echo differs from the sent byte, i.e. a collision on the line (the echo given up after it included)
+		unsigned long long m_turnarounds = 0;
+		double m_averageTurnaroundMicros = 0.0; //from the last stop bit we sent until the start bit of the reply
+		unsigned long long m_minTurnaroundMicros = 0;
+		unsigned long long m_maxTurnaroundMicros = 0;
+	};
+
+	/*
+	* the sent bytes are matched against the received ones as they arrive, nothing is held back: the bytes which are not echo
+	* are handed on in place as runs of the read buffer; a first byte which differs from the expected echo is taken as our own byte
+	* corrupted on the line, unless it ended before the first echo byte could be back: then it is data (the tail of a late reply);
+	* a difference after the first byte ends the echo, that byte & the rest are handed on as data
+	*/
+	class RS232_EchoCanceller final
+	{
+	public:
+		//a run of received bytes which are not echo, lastByteTime is the end of its last stop bit
+		using DataHandler = std::function<void(const unsigned char* data, unsigned int length, FrameTime lastByteTime)>;
+
+		RS232_EchoCanceller(RS232_PortParams_Ptr portParams);
+
+		//to be called under the write lock of the port right before the bytes are handed to the driver, txStart is the time the first start bit goes out
+		void expect(const unsigned char* data, unsigned int length, FrameTime txStart);
+
+		//readTime is the end of the last byte read, called on the reader thread only
+		void filter(const unsigned char* data, unsigned int length, FrameTime readTime, const DataHandler& dataHandler);
+
+		RS232_EchoStats getStats() const;
+
+	private:
+		struct PendingEcho
+		{
+			std::string m_bytes;
+			size_t m_matched;
+			FrameTime m_firstByteEnd; //end of our first byte on the wire, a byte received earlier is not its echo
+			FrameTime m_expiry;
+		};
+
+		void recordTurnaround(FrameTime replyStart);
+
+		RS232_EchoCanceller(const RS232_EchoCanceller&) = delete;
+		RS232_EchoCanceller& operator=(const RS232_EchoCanceller&) = delete;
+
+		RS232_PortParams_Ptr m_portParams;
+		FrameClock::duration m_charTime;
+
+		mutable std::mutex m_guard;
+		std::deque<PendingEcho> m_pending;
+		//last stop bit of our last transmission by the baud rate, the reply turnaround is measured from it: the echo cannot tell,
+		//a read holding the end of the echo & the start of the reply does not show the gap between them
+		FrameTime m_lastTxEnd;
+		bool m_awaitingReply;
+		std::vector<RS232_BufferView> m_runs; //data runs of the current read, handed on outside the lock
+		std::vector<FrameTime> m_runTimes;
+		RS232_EchoStats m_stats;
+		unsigned long long m_totalTurnaroundMicros;
+	};
+	using RS232_EchoCanceller_Ptr = std::unique_ptr<RS232_EchoCanceller>;
+}
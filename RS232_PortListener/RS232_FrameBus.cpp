@@ -0,0 +1,391 @@
+#include "RS232_FrameBus.h"
+
+#include <atomic>
+#include <new>
+
+namespace RS232
+{
+	constexpr unsigned int FRAME_BUS_MAGIC = 0x53554252; //"RBUS"
+	constexpr unsigned int FRAME_BUS_MAX_READERS = 32;
+	constexpr unsigned int FRAME_BUS_RECORD_HEADER = 16; //sequence(8) length(4) firstNonPrintableCharPos(4)
+	constexpr unsigned int FRAME_BUS_PADDING = 0xFFFFFFFF; //length of the record filling the end of the ring
+	constexpr size_t FRAME_BUS_MIN_CAPACITY = 4096;
+
+	static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the frame bus needs lock-free 64 bit atomics in shared memory");
+
+	/*reader slot in the shared header, a reader process owns one slot while it is attached*/
+	struct FrameBusReaderSlot
+	{
+		std::atomic<unsigned long> m_ownerProcessId; //0 when the slot is free
+		std::atomic<unsigned long> m_generation; //incremented on every claim, part of the event name
+		std::atomic<unsigned long> m_waiting; //the reader sleeps on its event, the writer has to signal it
+		unsigned long m_reserved;
+	};
+
+	/*start of the file mapping, followed by the ring*/
+	struct FrameBusHeader
+	{
+		unsigned int m_magic;
+		unsigned int m_headerSize;
+		unsigned long long m_capacity; //power of two
+		std::atomic<unsigned long long> m_reservePosition; //end of the region the writer may be overwriting
+		std::atomic<unsigned long long> m_writePosition; //end of the last complete frame
+		std::atomic<unsigned long long> m_publishedFrames;
+		std::atomic<unsigned long> m_writerOpen;
+		FrameBusReaderSlot m_readers[FRAME_BUS_MAX_READERS];
+	};
+
+	static std::string getMappingName(const std::string& portName)
+	{
+		return FRAME_BUS_NAME_PREFIX + portName;
+	}
+
+	static std::string getEventName(const std::string& portName, unsigned int slot, unsigned long generation)
+	{
+		return getMappingName(portName) + "_" + std::to_string(slot) + "_" + std::to_string(generation);
+	}
+
+	static size_t getHeaderSize()
+	{
+		return (sizeof(FrameBusHeader) + 63) & ~(size_t)63; //the ring starts on its own cache line
+	}
+
+	static unsigned int getRecordSize(unsigned int length)
+	{
+		return FRAME_BUS_RECORD_HEADER + ((length + 7) & ~7u); //records stay 8 byte aligned
+	}
+
+	static bool isProcessAlive(unsigned long processId)
+	{
+		HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, processId);
+		if (process == NULL)
+			return GetLastError() == ERROR_ACCESS_DENIED; //exists, but belongs to another user
+		bool alive = (WaitForSingleObject(process, 0) == WAIT_TIMEOUT);
+		CloseHandle(process);
+		return alive;
+	}
+
+	RS232_FrameBus::RS232_FrameBus(const std::string& portName) :
+		m_portName(portName),
+		m_mapping(NULL),
+		m_header(nullptr),
+		m_ring(nullptr),
+		m_readerEvents(FRAME_BUS_MAX_READERS, (HANDLE)NULL),
+		m_readerGenerations(FRAME_BUS_MAX_READERS, 0)
+	{
+	}
+
+	std::unique_ptr<RS232_FrameBus> RS232_FrameBus::create(const std::string& portName, size_t capacity)
+	{
+		size_t ringSize = FRAME_BUS_MIN_CAPACITY;
+		while (ringSize < capacity)
+			ringSize <<= 1;
+		unsigned long long mappingSize = getHeaderSize() + ringSize;
+
+		std::unique_ptr<RS232_FrameBus> frameBus(new RS232_FrameBus(portName));
+		frameBus->m_mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(mappingSize >> 32), (DWORD)mappingSize, getMappingName(portName).c_str());
+		if (frameBus->m_mapping == NULL)
+		{
+			std::cout << "RS232_FrameBus::create() -> CreateFileMapping failed for " << portName << " error: " << GetLastError() << std::endl;
+			return nullptr;
+		}
+		bool attached = (GetLastError() == ERROR_ALREADY_EXISTS); //readers kept the ring of the previous run alive
+
+		void* view = MapViewOfFile(frameBus->m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)mappingSize);
+		if (view == NULL)
+		{
+			std::cout << "RS232_FrameBus::create() -> MapViewOfFile failed for " << portName << " error: " << GetLastError() << std::endl;
+			return nullptr;
+		}
+		frameBus->m_header = (FrameBusHeader*)view;
+		frameBus->m_ring = (unsigned char*)view + getHeaderSize();
+
+		FrameBusHeader* header = frameBus->m_header;
+		if (!attached || header->m_magic != FRAME_BUS_MAGIC || header->m_capacity != ringSize)
+		{
+			header = new (view) FrameBusHeader();
+			header->m_headerSize = (unsigned int)getHeaderSize();
+			header->m_capacity = ringSize;
+			header->m_reservePosition = 0;
+			header->m_writePosition = 0;
+			header->m_publishedFrames = 0;
+			for (FrameBusReaderSlot& slot : header->m_readers)
+			{
+				slot.m_ownerProcessId = 0;
+				slot.m_generation = 0;
+				slot.m_waiting = 0;
+			}
+			header->m_magic = FRAME_BUS_MAGIC;
+		}
+		header->m_writerOpen = 1;
+		return frameBus;
+	}
+
+	RS232_FrameBus::~RS232_FrameBus()
+	{
+		if (m_header != nullptr)
+		{
+			m_header->m_writerOpen = 0;
+			wakeReaders();
+			UnmapViewOfFile(m_header);
+		}
+		for (HANDLE readerEvent : m_readerEvents)
+			if (readerEvent != NULL)
+				CloseHandle(readerEvent);
+		if (m_mapping != NULL)
+			CloseHandle(m_mapping);
+	}
+
+	bool RS232_FrameBus::publish(const RS232_SegmentedBuffer& frame, unsigned int firstNonPrintableCharPos)
+	{
+		unsigned int length = (unsigned int)frame.size();
+		unsigned long long capacity = m_header->m_capacity;
+		unsigned int recordSize = getRecordSize(length);
+		if (recordSize > capacity)
+			return false;
+
+		unsigned long long position = m_header->m_writePosition.load(std::memory_order_relaxed); //single writer
+		unsigned long long offset = position & (capacity - 1);
+		unsigned long long padding = (capacity - offset < recordSize) ? capacity - offset : 0; //records do not wrap around
+		unsigned long long end = position + padding + recordSize;
+
+		//seqlock: the readers see the region as overwritten before its first byte changes
+		m_header->m_reservePosition.store(end, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release); //the record is not written before the reservation
+
+		if (padding >= FRAME_BUS_RECORD_HEADER)
+		{
+			unsigned int paddingLength = FRAME_BUS_PADDING;
+			memcpy(m_ring + offset + 8, &paddingLength, sizeof(paddingLength));
+		}
+		if (padding > 0)
+			offset = 0;
+
+		unsigned long long sequence = m_header->m_publishedFrames.load(std::memory_order_relaxed) + 1;
+		unsigned char* record = m_ring + offset;
+		memcpy(record, &sequence, sizeof(sequence));
+		memcpy(record + 8, &length, sizeof(length));
+		memcpy(record + 12, &firstNonPrintableCharPos, sizeof(firstNonPrintableCharPos));
+		frame.copyTo(record + FRAME_BUS_RECORD_HEADER, 0, length);
+
+		m_header->m_writePosition.store(end);
+		m_header->m_publishedFrames.store(sequence);
+		wakeReaders();
+		return true;
+	}
+
+	unsigned long long RS232_FrameBus::getPublishedFrames() const
+	{
+		return m_header->m_publishedFrames;
+	}
+
+	void RS232_FrameBus::wakeReaders()
+	{
+		for (unsigned int slot = 0; slot < FRAME_BUS_MAX_READERS; slot++)
+		{
+			FrameBusReaderSlot& readerSlot = m_header->m_readers[slot];
+			if (!readerSlot.m_waiting) //no system call while the readers are busy
+				continue;
+
+			unsigned long generation = readerSlot.m_generation;
+			if (m_readerEvents[slot] == NULL || m_readerGenerations[slot] != generation)
+			{
+				if (m_readerEvents[slot] != NULL)
+					CloseHandle(m_readerEvents[slot]);
+				m_readerEvents[slot] = OpenEvent(EVENT_MODIFY_STATE, FALSE, getEventName(m_portName, slot, generation).c_str());
+				m_readerGenerations[slot] = generation;
+			}
+			if (m_readerEvents[slot] != NULL)
+				SetEvent(m_readerEvents[slot]);
+		}
+	}
+
+	RS232_FrameBusReader::RS232_FrameBusReader(const std::string& portName) :
+		m_mapping(NULL),
+		m_event(NULL),
+		m_header(nullptr),
+		m_ring(nullptr),
+		m_slot(FRAME_BUS_MAX_READERS),
+		m_cursor(0),
+		m_nextSequence(0),
+		m_sequenceKnown(false),
+		m_lostFrames(0)
+	{
+	}
+
+	std::unique_ptr<RS232_FrameBusReader> RS232_FrameBusReader::open(const std::string& portName)
+	{
+		std::unique_ptr<RS232_FrameBusReader> reader(new RS232_FrameBusReader(portName));
+		reader->m_mapping = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE, getMappingName(portName).c_str());
+		if (reader->m_mapping == NULL)
+		{
+			std::cout << "RS232_FrameBusReader::open() -> no frame bus for " << portName << std::endl;
+			return nullptr;
+		}
+
+		void* view = MapViewOfFile(reader->m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+		if (view == NULL)
+		{
+			std::cout << "RS232_FrameBusReader::open() -> MapViewOfFile failed for " << portName << " error: " << GetLastError() << std::endl;
+			return nullptr;
+		}
+		reader->m_header = (FrameBusHeader*)view;
+		if (reader->m_header->m_magic != FRAME_BUS_MAGIC)
+		{
+			std::cout << "RS232_FrameBusReader::open() -> frame bus of " << portName << " is not initialized!" << std::endl;
+			return nullptr;
+		}
+		reader->m_ring = (const unsigned char*)view + reader->m_header->m_headerSize;
+
+		//claims a free slot, or the slot of a reader process which died without releasing it
+		unsigned long processId = GetCurrentProcessId();
+		for (unsigned int slot = 0; slot < FRAME_BUS_MAX_READERS && reader->m_slot == FRAME_BUS_MAX_READERS; slot++)
+		{
+			FrameBusReaderSlot& readerSlot = reader->m_header->m_readers[slot];
+			unsigned long owner = readerSlot.m_ownerProcessId;
+			if ((owner == 0 || (owner != processId && !isProcessAlive(owner))) && readerSlot.m_ownerProcessId.compare_exchange_strong(owner, processId))
+				reader->m_slot = slot;
+		}
+		if (reader->m_slot == FRAME_BUS_MAX_READERS)
+		{
+			std::cout << "RS232_FrameBusReader::open() -> all " << FRAME_BUS_MAX_READERS << " reader slots of " << portName << " are taken!" << std::endl;
+			return nullptr;
+		}
+
+		FrameBusReaderSlot& readerSlot = reader->m_header->m_readers[reader->m_slot];
+		readerSlot.m_waiting = 0;
+		unsigned long generation = ++readerSlot.m_generation;
+		reader->m_event = CreateEvent(NULL, FALSE, FALSE, getEventName(portName, reader->m_slot, generation).c_str());
+		if (reader->m_event == NULL)
+		{
+			std::cout << "RS232_FrameBusReader::open() -> CreateEvent failed, error: " << GetLastError() << std::endl;
+			return nullptr;
+		}
+
+		/*
+		* the frames published before attaching are skipped, the sequence of the first frame read is taken from its record:
+		* the count may lag the position by the frame being published, it is read first & only bounds a lap before that frame
+		*/
+		unsigned long long publishedFrames = reader->m_header->m_publishedFrames;
+		reader->m_cursor = reader->m_header->m_writePosition;
+		reader->m_nextSequence = publishedFrames + 1;
+		reader->m_sequenceKnown = false;
+		return reader;
+	}
+
+	RS232_FrameBusReader::~RS232_FrameBusReader()
+	{
+		if (m_header != nullptr)
+		{
+			if (m_slot < FRAME_BUS_MAX_READERS)
+			{
+				m_header->m_readers[m_slot].m_waiting = 0;
+				m_header->m_readers[m_slot].m_ownerProcessId = 0;
+			}
+			UnmapViewOfFile(m_header);
+		}
+		if (m_event != NULL)
+			CloseHandle(m_event);
+		if (m_mapping != NULL)
+			CloseHandle(m_mapping);
+	}
+
+	bool RS232_FrameBusReader::isOverwritten(unsigned long long position) const
+	{
+		std::atomic_thread_fence(std::memory_order_acquire); //the ring bytes are read before the reserve position
+		return m_header->m_reservePosition.load(std::memory_order_relaxed) > position + m_header->m_capacity;
+	}
+
+	bool RS232_FrameBusReader::validate(const RS232_BusFrame& frame)
+	{
+		if (!isOverwritten(frame.m_position))
+			return true;
+		m_lostFrames++; //the following frames are counted by the sequence gap of the next read
+		return false;
+	}
+
+	BusReadStatus RS232_FrameBusReader::waitFrame(RS232_BusFrame& frame, DWORD timeoutMillis)
+	{
+		unsigned long long capacity = m_header->m_capacity;
+		FrameBusReaderSlot& readerSlot = m_header->m_readers[m_slot];
+		bool lapped = false;
+
+		while (true)
+		{
+			if (m_cursor == m_header->m_writePosition)
+			{
+				if (!m_header->m_writerOpen)
+				{	//no frame will follow to reveal the sequence gap of a lap
+					unsigned long long publishedFrames = m_header->m_publishedFrames;
+					if (m_sequenceKnown && publishedFrames >= m_nextSequence)
+						m_lostFrames += publishedFrames + 1 - m_nextSequence;
+					m_nextSequence = publishedFrames + 1;
+					return BR_CLOSED;
+				}
+
+				//announces the sleep first, so the writer either sees the flag or the reader sees the new frame
+				readerSlot.m_waiting = 1;
+				if (m_cursor != m_header->m_writePosition || !m_header->m_writerOpen)
+				{
+					readerSlot.m_waiting = 0;
+					continue;
+				}
+				DWORD waitResult = WaitForSingleObject(m_event, timeoutMillis);
+				readerSlot.m_waiting = 0;
+				if (waitResult == WAIT_TIMEOUT)
+					return BR_TIMEOUT;
+				if (waitResult != WAIT_OBJECT_0)
+					return BR_CLOSED;
+				continue;
+			}
+
+			if (isOverwritten(m_cursor))
+			{	//the unread frames are gone, continues with the frames published from now on
+				m_cursor = m_header->m_writePosition;
+				lapped = true;
+				continue;
+			}
+
+			unsigned long long offset = m_cursor & (capacity - 1);
+			if (capacity - offset < FRAME_BUS_RECORD_HEADER)
+			{	//too small for the padding record
+				m_cursor += capacity - offset;
+				continue;
+			}
+
+			const unsigned char* record = m_ring + offset;
+			unsigned long long sequence;
+			unsigned int length;
+			unsigned int firstNonPrintableCharPos;
+			memcpy(&sequence, record, sizeof(sequence));
+			memcpy(&length, record + 8, sizeof(length));
+			memcpy(&firstNonPrintableCharPos, record + 12, sizeof(firstNonPrintableCharPos));
+			if (isOverwritten(m_cursor))
+				continue; //torn header, handled as lapped above
+
+			if (length == FRAME_BUS_PADDING)
+			{
+				m_cursor += capacity - offset;
+				continue;
+			}
+
+			frame.m_data = record + FRAME_BUS_RECORD_HEADER;
+			frame.m_length = length;
+			frame.m_firstNonPrintableCharPos = firstNonPrintableCharPos;
+			frame.m_sequence = sequence;
+			frame.m_position = m_cursor;
+			m_cursor += getRecordSize(length);
+
+			if (!m_sequenceKnown && !lapped)
+				m_nextSequence = sequence; //the first frame after attaching
+			m_sequenceKnown = true;
+			if (sequence > m_nextSequence)
+			{
+				m_lostFrames += sequence - m_nextSequence;
+				lapped = true;
+			}
+			m_nextSequence = sequence + 1;
+			return lapped ? BR_LAPPED : BR_FRAME;
+		}
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: shared memory ring publishing the received frames of a port to any number of local reader processes
+*/
+
+#include <memory>
+#include <vector>
+
+#include "RS232_Util.h"
+
+namespace RS232
+{
+	struct FrameBusHeader;
+
+	/*
+	* the frames are written once into a named file mapping (Local\RS232_FrameBus_<port>),
+	* every reader process follows the ring with its own cursor & sleeps on its own event while the ring is empty
+	*/
+	class RS232_FrameBus
+	{
+	public:
+		//creates (or re-attaches to) the ring of the port, capacity is rounded up to a power of two
+		static std::unique_ptr<RS232_FrameBus> create(const std::string& portName, size_t capacity);
+
+		virtual ~RS232_FrameBus();
+
+		//copies the frame into the ring & wakes up the waiting readers, false if the frame is larger than the ring
+		bool publish(const RS232_SegmentedBuffer& frame, unsigned int firstNonPrintableCharPos);
+
+		unsigned long long getPublishedFrames() const;
+
+	private:
+		RS232_FrameBus(const std::string& portName);
+
+		void wakeReaders();
+
+		std::string m_portName;
+		HANDLE m_mapping;
+		FrameBusHeader* m_header;
+		unsigned char* m_ring;
+
+		/*event handles of the reader slots, re-opened when a slot changes owner*/
+		std::vector<HANDLE> m_readerEvents;
+		std::vector<unsigned long> m_readerGenerations;
+
+		RS232_FrameBus(const RS232_FrameBus&) = delete;
+		RS232_FrameBus& operator=(const RS232_FrameBus&) = delete;
+	};
+	using RS232_FrameBus_Ptr = std::unique_ptr<RS232_FrameBus>;
+
+	/*a frame inside the ring, only valid until the writer laps the reader*/
+	struct RS232_BusFrame
+	{
+		const unsigned char* m_data = nullptr;
+		unsigned int m_length = 0;
+		unsigned int m_firstNonPrintableCharPos = NO_NON_PRINTABLE_CHAR;
+		unsigned long long m_sequence = 0; //1 for the first frame published on the port
+		unsigned long long m_position = 0; //ring position of the frame, used by validate()
+	};
+
+	enum BusReadStatus
+	{
+		BR_FRAME,	//a frame is returned
+		BR_TIMEOUT,	//nothing published within the timeout
+		BR_LAPPED,	//a frame is returned, but the writer overwrote unread frames before it (see getLostFrames())
+		BR_CLOSED	//the listener closed the ring
+	};
+
+	class RS232_FrameBusReader
+	{
+	public:
+		//attaches to the ring of the port, NULL if the listener does not publish it or all reader slots are taken
+		static std::unique_ptr<RS232_FrameBusReader> open(const std::string& portName);
+
+		virtual ~RS232_FrameBusReader();
+
+		//zero-copy: frame points into the shared memory, the previous frame is released
+		BusReadStatus waitFrame(RS232_BusFrame& frame, DWORD timeoutMillis);
+
+		//true if the frame was not overwritten while it was being consumed, otherwise it is counted as lost
+		bool validate(const RS232_BusFrame& frame);
+
+		//frames overwritten before this reader could read them
+		unsigned long long getLostFrames() const { return m_lostFrames; }
+
+	private:
+		RS232_FrameBusReader(const std::string& portName);
+
+		bool isOverwritten(unsigned long long position) const;
+
+		HANDLE m_mapping;
+		HANDLE m_event;
+		FrameBusHeader* m_header;
+		const unsigned char* m_ring;
+		unsigned int m_slot;
+
+		unsigned long long m_cursor; //ring position of the next frame
+		unsigned long long m_nextSequence;
+		bool m_sequenceKnown; //false until the first frame after attaching is read
+		unsigned long long m_lostFrames;
+
+		RS232_FrameBusReader(const RS232_FrameBusReader&) = delete;
+		RS232_FrameBusReader& operator=(const RS232_FrameBusReader&) = delete;
+	};
+	using RS232_FrameBusReader_Ptr = std::unique_ptr<RS232_FrameBusReader>;
+}
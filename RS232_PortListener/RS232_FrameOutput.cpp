@@ -0,0 +1,220 @@
+#include "RS232_FrameOutput.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace RS232
+{
+	constexpr unsigned int FRAME_OUTPUT_MAX_PENDING_BUFFERS = 4; //write() waits for the flush thread beyond it
+
+	static void putLittleEndian(char* out, unsigned long long value, unsigned int size)
+	{
+		for (unsigned int i = 0; i < size; i++)
+			out[i] = (char)(value >> (8 * i));
+	}
+
+	RS232_FrameOutput_Ptr RS232_FrameOutput::m_instance = nullptr;
+
+	RS232_FrameOutput_Ptr& RS232_FrameOutput::getInstance()
+	{
+		if (m_instance == nullptr)
+			m_instance = std::unique_ptr<RS232_FrameOutput>(new RS232_FrameOutput());
+		return m_instance;
+	}
+
+	RS232_FrameOutput::RS232_FrameOutput() :
+		m_open(false),
+		m_closing(false),
+		m_outputHandle(INVALID_HANDLE_VALUE),
+		m_stdout(false),
+		m_coutBuffer(nullptr),
+		m_clockOffsetMicros(0)
+	{
+	}
+
+	RS232_FrameOutput::~RS232_FrameOutput()
+	{
+		close();
+	}
+
+	bool RS232_FrameOutput::open(RS232_FrameOutputParams_Ptr frameOutputParams)
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		if (m_open)
+			return true;
+
+		m_frameOutputParams = frameOutputParams;
+		m_stdout = (m_frameOutputParams->m_path == FRAME_OUTPUT_STDOUT);
+		if (m_stdout)
+			m_outputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+		else
+			m_outputHandle = CreateFileA(m_frameOutputParams->m_path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (m_outputHandle == INVALID_HANDLE_VALUE || m_outputHandle == NULL)
+		{
+			std::cout << "RS232_FrameOutput::open() -> cannot open " << m_frameOutputParams->m_path << " error: " << GetLastError() << std::endl;
+			m_outputHandle = INVALID_HANDLE_VALUE;
+			return false;
+		}
+
+		if (m_stdout)
+		{	//the console messages would corrupt the record stream
+			std::cout.flush();
+			m_coutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+		}
+
+		FrameTime steadyNow = FrameClock::now();
+		long long systemMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		m_clockOffsetMicros = systemMicros - std::chrono::duration_cast<std::chrono::microseconds>(steadyNow.time_since_epoch()).count();
+
+		m_stats = RS232_FrameOutputStats();
+		m_buffer.clear();
+		m_buffer.reserve(m_frameOutputParams->m_bufferSize);
+		m_flushBuffer.clear();
+		m_flushBuffer.reserve(m_frameOutputParams->m_bufferSize);
+
+		char header[FRAME_OUTPUT_FILE_HEADER_SIZE];
+		memcpy(header, FRAME_OUTPUT_MAGIC, sizeof(FRAME_OUTPUT_MAGIC));
+		putLittleEndian(header + sizeof(FRAME_OUTPUT_MAGIC), FRAME_OUTPUT_VERSION, 4);
+		m_buffer.insert(m_buffer.end(), header, header + sizeof(header));
+
+		m_closing = false;
+		m_open = true;
+		m_flushThread = std::thread(&RS232_FrameOutput::flushLoop, this);
+		std::cout << "RS232_FrameOutput::open() -> writing the received frames to " << (m_stdout ? "stdout" : m_frameOutputParams->m_path) << std::endl;
+		return true;
+	}
+
+	void RS232_FrameOutput::close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			if (!m_open)
+				return;
+			m_open = false;
+			m_closing = true;
+			m_flushRequested.notify_one();
+		}
+
+		if (m_flushThread.joinable())
+			m_flushThread.join();
+
+		std::lock_guard<std::mutex> lock(m_guard);
+		if (!m_stdout && m_outputHandle != INVALID_HANDLE_VALUE)
+			CloseHandle(m_outputHandle);
+		m_outputHandle = INVALID_HANDLE_VALUE;
+		if (m_coutBuffer != nullptr)
+		{
+			std::cout.rdbuf(m_coutBuffer);
+			m_coutBuffer = nullptr;
+		}
+		m_closing = false;
+		m_flushed.notify_all();
+	}
+
+	void RS232_FrameOutput::write(const std::string& portName, const RS232_Frame& frame)
+	{
+		if (!m_open)
+			return;
+
+		unsigned int portNameLength = (unsigned int)std::min<size_t>(portName.size(), 0xFF);
+		size_t recordSize = FRAME_OUTPUT_RECORD_HEADER_SIZE + portNameLength + frame.m_data.size();
+		if (recordSize > FRAME_OUTPUT_MAX_RECORD_SIZE)
+		{
+			std::cout << "RS232_FrameOutput::write() -> frame of " << frame.m_data.size() << " bytes is too long for a record!" << std::endl;
+			return;
+		}
+
+		unsigned int flags = 0;
+		if (frame.m_info.m_firstNonPrintableCharPos != NO_NON_PRINTABLE_CHAR)
+			flags |= FRAME_FLAG_BINARY;
+		int typeId = frame.m_info.m_dataControl.get() ? (int)frame.m_info.m_dataControl->m_typeId : -1;
+
+		char header[FRAME_OUTPUT_RECORD_HEADER_SIZE];
+		putLittleEndian(header, recordSize - 4, 4);
+		putLittleEndian(header + 4, flags, 2);
+		putLittleEndian(header + 6, (unsigned short)typeId, 2);
+		putLittleEndian(header + 8, toSystemMicros(frame.m_info.m_startTime), 8);
+		putLittleEndian(header + 16, toSystemMicros(frame.m_info.m_endTime), 8);
+		header[24] = (char)portNameLength;
+
+		std::unique_lock<std::mutex> lock(m_guard);
+		size_t maxPending = (size_t)m_frameOutputParams->m_bufferSize * FRAME_OUTPUT_MAX_PENDING_BUFFERS;
+		if (m_open && m_buffer.size() >= maxPending)
+		{
+			m_stats.m_throttledRecords++;
+			m_flushed.wait(lock, [&]() { return !m_open || m_buffer.size() < maxPending; });
+		}
+		if (!m_open)
+			return;
+
+		m_buffer.insert(m_buffer.end(), header, header + sizeof(header));
+		m_buffer.insert(m_buffer.end(), portName.data(), portName.data() + portNameLength);
+		for (size_t i = 0; i < frame.m_data.getSegmentCount(); i++)
+		{
+			RS232_BufferView segment = frame.m_data.getSegment(i);
+			m_buffer.insert(m_buffer.end(), (const char*)segment.m_data, (const char*)segment.m_data + segment.m_length);
+		}
+		m_stats.m_writtenRecords++;
+		if (m_buffer.size() >= m_frameOutputParams->m_bufferSize)
+			m_flushRequested.notify_one();
+	}
+
+	RS232_FrameOutputStats RS232_FrameOutput::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		return m_stats;
+	}
+
+	void RS232_FrameOutput::flushLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_guard);
+		while (true)
+		{
+			m_flushRequested.wait_for(lock, std::chrono::milliseconds(m_frameOutputParams->m_flushIntervalMillis),
+				[&]() { return m_closing || m_buffer.size() >= m_frameOutputParams->m_bufferSize; });
+
+			bool closing = m_closing;
+			m_flushBuffer.swap(m_buffer);
+			m_flushed.notify_all();
+			lock.unlock();
+
+			bool written = true;
+			if (!m_flushBuffer.empty())
+				written = writeToOutput(m_flushBuffer.data(), m_flushBuffer.size());
+
+			lock.lock();
+			if (!m_flushBuffer.empty())
+			{
+				m_stats.m_writes++;
+				if (written)
+					m_stats.m_writtenBytes += m_flushBuffer.size();
+				else
+					m_stats.m_failed = true;
+			}
+			m_flushBuffer.clear();
+			if (closing)
+				return;
+		}
+	}
+
+	bool RS232_FrameOutput::writeToOutput(const char* data, size_t length)
+	{
+		size_t written = 0;
+		while (written < length)
+		{
+			DWORD bytesWritten = 0;
+			if (!WriteFile(m_outputHandle, data + written, (DWORD)(length - written), &bytesWritten, NULL))
+			{
+				std::cout << "RS232_FrameOutput::writeToOutput() -> write failed, error: " << GetLastError() << std::endl;
+				return false;
+			}
+			written += bytesWritten;
+		}
+		return true;
+	}
+
+	long long RS232_FrameOutput::toSystemMicros(FrameTime time) const
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count() + m_clockOffsetMicros;
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: writes the received frames as length-prefixed binary records (see RS232_FrameReader.h) to stdout or a file
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RS232_Util.h"
+#include "RS232_FrameQueue.h"
+#include "RS232_FrameReader.h"
+
+namespace RS232
+{
+	/*frame output counters*/
+	struct RS232_FrameOutputStats
+	{
+		unsigned long long m_writtenRecords = 0;
+		unsigned long long m_writtenBytes = 0; //records & stream header
+		unsigned long long m_writes = 0; //WriteFile calls, each covering a buffer of records
+		unsigned long long m_throttledRecords = 0; //the writer waited for the output to catch up
+		bool m_failed = false;
+	};
+
+	class RS232_FrameOutput;
+	using RS232_FrameOutput_Ptr = std::unique_ptr<RS232_FrameOutput>;
+
+	/*
+	* write() only serializes the record into the buffer, the flush thread writes the buffer once it is full or every flushInterval,
+	* a writer waits when the output falls behind by several buffers; the writer is the route thread of the default sink, so its
+	* route fills up next & applies the overflow policy of the port: block & spill hold up the consumer until the receive queue
+	* blocks the reader or spills, the drop policies drop the frames at the route (counted in its RS232_RouteStats)
+	*/
+	class RS232_FrameOutput final
+	{
+	public:
+		static RS232_FrameOutput_Ptr& getInstance();
+
+		virtual ~RS232_FrameOutput();
+
+		//opens the output & writes the stream header
+		bool open(RS232_FrameOutputParams_Ptr frameOutputParams);
+
+		//writes the buffered records & closes the output
+		void close();
+
+		bool isOpen() const { return m_open; }
+
+		void write(const std::string& portName, const RS232_Frame& frame);
+
+		RS232_FrameOutputStats getStats() const;
+
+	private:
+		RS232_FrameOutput();
+
+		void flushLoop();
+		bool writeToOutput(const char* data, size_t length);
+
+		//microseconds since the epoch of the system clock
+		long long toSystemMicros(FrameTime time) const;
+
+		/*to protect the Singleton class from being copied*/
+		RS232_FrameOutput(const RS232_FrameOutput&) = delete;
+		RS232_FrameOutput& operator=(const RS232_FrameOutput&) = delete;
+		RS232_FrameOutput(RS232_FrameOutput&&) = delete;
+		RS232_FrameOutput& operator=(RS232_FrameOutput&) = delete;
+		/*to protect the Singleton class from being copied*/
+
+		static RS232_FrameOutput_Ptr m_instance;
+
+		RS232_FrameOutputParams_Ptr m_frameOutputParams;
+		std::atomic<bool> m_open;
+
+		mutable std::mutex m_guard;
+		std::condition_variable m_flushRequested; //wakes up the flush thread
+		std::condition_variable m_flushed; //wakes up the throttled writers
+		std::vector<char> m_buffer; //serialized records waiting for the flush thread
+		std::vector<char> m_flushBuffer; //the one being written, swapped with m_buffer so the capacity is kept
+		bool m_closing;
+
+		HANDLE m_outputHandle;
+		bool m_stdout;
+		std::streambuf* m_coutBuffer; //restored at close() when the console messages were moved to stderr
+		long long m_clockOffsetMicros; //system clock - FrameClock, sampled at open()
+
+		std::thread m_flushThread;
+		RS232_FrameOutputStats m_stats;
+	};
+}
@@ -0,0 +1,273 @@
+#include "RS232_FrameQueue.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace RS232
+{
+	/*spill file record header, followed by the frame payload*/
+	struct SpillRecordHeader
+	{
+		uint32_t m_length;
+		uint32_t m_firstNonPrintableCharPos;
+		int32_t m_dataControlIndex; //index in RS232_PortParams::m_dcList, -1 for none
+		int64_t m_startTicks; //FrameClock ticks, the spill file does not outlive the process
+		int64_t m_endTicks;
+	};
+
+	RS232_FrameQueue::RS232_FrameQueue(RS232_PortParams_Ptr portParams) :
+		m_portParams(portParams),
+		m_memoryBytes(0),
+		m_closed(false),
+		m_flowThrottled(false),
+		m_spillPending(0),
+		m_spillFileBytes(0),
+		m_unspilling(false)
+	{
+	}
+
+	RS232_FrameQueue::~RS232_FrameQueue()
+	{
+		close();
+	}
+
+	size_t RS232_FrameQueue::frameCost(const RS232_Frame& frame)
+	{
+		return frame.m_data.capacity() + sizeof(RS232_Frame);
+	}
+
+	void RS232_FrameQueue::push(RS232_Frame&& frame)
+	{
+		std::unique_lock<std::mutex> lock(m_guard);
+		if (m_closed)
+			return;
+
+		size_t cost = frameCost(frame);
+		size_t capacity = m_portParams->m_rxQueueSize;
+		bool fits = (m_memoryBytes + cost <= capacity) || m_frames.empty(); //a single oversized frame is still accepted
+
+		if (!fits || m_spillPending > 0)
+		{
+			switch (m_portParams->m_overflowPolicy)
+			{
+			case OP_DROP_NEWEST:
+			{
+				dropFrame(frame.m_data.size());
+				return;
+			}
+			case OP_DROP_OLDEST:
+			{
+				while (!m_frames.empty() && m_memoryBytes + cost > capacity)
+				{
+					m_memoryBytes -= frameCost(m_frames.front());
+					dropFrame(m_frames.front().m_data.size());
+					m_frames.pop_front();
+				}
+			}
+			break;
+			case OP_SPILL:
+			{	//once spilling has started, the newer frames follow the older ones to the file
+				if (!spillFrame(frame))
+					dropFrame(frame.m_data.size());
+				updateFlow();
+				m_notEmpty.notify_one();
+				return;
+			}
+			case OP_BLOCK:
+			default:
+			{
+				std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+				m_notFull.wait(lock, [&]() { return m_closed || m_frames.empty() || m_memoryBytes + cost <= capacity; });
+				m_stats.m_blockedMicros += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - waitStart).count();
+				if (m_closed)
+					return;
+			}
+			break;
+			}
+		}
+
+		m_memoryBytes += cost;
+		m_frames.push_back(std::move(frame));
+		if (m_memoryBytes > m_stats.m_peakBytes)
+			m_stats.m_peakBytes = m_memoryBytes;
+		updateFlow();
+		m_notEmpty.notify_one();
+	}
+
+	bool RS232_FrameQueue::pop(RS232_Frame& frame)
+	{
+		std::unique_lock<std::mutex> lock(m_guard);
+		while (true)
+		{
+			m_notEmpty.wait(lock, [&]() { return m_closed || !m_frames.empty() || m_spillPending > 0; });
+			if (m_closed)
+				return false;
+
+			if (!m_frames.empty())
+			{	//the frames in memory are always older than the spilled ones
+				frame = std::move(m_frames.front());
+				m_frames.pop_front();
+				m_memoryBytes -= frameCost(frame);
+				updateFlow();
+				m_notFull.notify_one();
+				return true;
+			}
+			if (unspillFrame(frame, lock))
+				return true;
+		}
+	}
+
+	void RS232_FrameQueue::close()
+	{
+		std::unique_lock<std::mutex> lock(m_guard);
+		m_closed = true;
+		m_unspillDone.wait(lock, [&]() { return !m_unspilling; }); //the spill reader is in use until then
+		m_frames.clear();
+		m_memoryBytes = 0;
+		m_flowThrottled = false; //the port is opened again with the sender released
+		m_spillPending = 0;
+		if (m_spillWriter.is_open())
+			m_spillWriter.close();
+		if (m_spillReader.is_open())
+			m_spillReader.close();
+		m_notEmpty.notify_all();
+		m_notFull.notify_all();
+	}
+
+	void RS232_FrameQueue::reopen()
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		m_closed = false;
+	}
+
+	void RS232_FrameQueue::updateFlow()
+	{
+		if (!m_flowHandler)
+			return;
+
+		size_t capacity = m_portParams->m_rxQueueSize;
+		if (!m_flowThrottled && m_memoryBytes * 100 >= capacity * m_portParams->m_flowHighWatermark)
+		{
+			m_flowThrottled = true;
+			m_flowHandler(true);
+		}
+		else if (m_flowThrottled && m_memoryBytes * 100 <= capacity * m_portParams->m_flowLowWatermark)
+		{
+			m_flowThrottled = false;
+			m_flowHandler(false);
+		}
+	}
+
+	RS232_QueueStats RS232_FrameQueue::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		RS232_QueueStats stats = m_stats;
+		stats.m_queuedFrames = m_frames.size() + m_spillPending;
+		stats.m_queuedBytes = m_memoryBytes;
+		return stats;
+	}
+
+	void RS232_FrameQueue::dropFrame(size_t bytes)
+	{
+		m_stats.m_droppedFrames++;
+		m_stats.m_droppedBytes += bytes;
+	}
+
+	bool RS232_FrameQueue::spillFrame(const RS232_Frame& frame)
+	{
+		if (m_portParams->m_spillMaxSize > 0 && m_spillFileBytes + sizeof(SpillRecordHeader) + frame.m_data.size() > m_portParams->m_spillMaxSize)
+			return false;
+
+		if (!m_spillWriter.is_open())
+		{	//the file is truncated whenever the backlog is drained
+			m_spillWriter.open(m_portParams->m_spillFilePath, std::ios::binary | std::ios::out | std::ios::trunc);
+			m_spillReader.open(m_portParams->m_spillFilePath, std::ios::binary | std::ios::in);
+			m_spillFileBytes = 0;
+			if (!m_spillWriter.is_open() || !m_spillReader.is_open())
+			{
+				std::cout << "RS232_FrameQueue::spillFrame() -> cannot open spill file " << m_portParams->m_spillFilePath << std::endl;
+				m_spillWriter.close();
+				m_spillReader.close();
+				return false;
+			}
+		}
+
+		SpillRecordHeader header;
+		header.m_length = (uint32_t)frame.m_data.size();
+		header.m_firstNonPrintableCharPos = frame.m_info.m_firstNonPrintableCharPos;
+		header.m_dataControlIndex = frame.m_info.m_dataControl.get() ? (int32_t)frame.m_info.m_dataControl->m_typeId : -1;
+		header.m_startTicks = frame.m_info.m_startTime.time_since_epoch().count();
+		header.m_endTicks = frame.m_info.m_endTime.time_since_epoch().count();
+
+		m_spillWriter.write((const char*)&header, sizeof(header));
+		for (size_t i = 0; i < frame.m_data.getSegmentCount(); i++)
+		{
+			RS232_BufferView segment = frame.m_data.getSegment(i);
+			m_spillWriter.write((const char*)segment.m_data, segment.m_length);
+		}
+		m_spillWriter.flush(); //the reader stream has to see the record
+		if (!m_spillWriter.good())
+		{
+			std::cout << "RS232_FrameQueue::spillFrame() -> write to spill file failed!" << std::endl;
+			return false;
+		}
+
+		m_spillPending++;
+		m_spillFileBytes += sizeof(header) + frame.m_data.size();
+		m_stats.m_spilledFrames++;
+		m_stats.m_spilledBytes += frame.m_data.size();
+		return true;
+	}
+
+	bool RS232_FrameQueue::unspillFrame(RS232_Frame& frame, std::unique_lock<std::mutex>& lock)
+	{
+		//the producer only appends to the file through m_spillWriter & a record is flushed before m_spillPending counts it
+		m_unspilling = true;
+		lock.unlock();
+
+		SpillRecordHeader header;
+		m_spillReader.clear(); //the previous read may have hit the end of the file that grew since then
+		m_spillReader.read((char*)&header, sizeof(header));
+		frame.m_data.clear();
+		unsigned char chunk[SEGMENT_MAX_SIZE];
+		for (uint32_t remaining = header.m_length; remaining > 0 && m_spillReader.good(); )
+		{
+			uint32_t chunkLength = std::min<uint32_t>(remaining, SEGMENT_MAX_SIZE);
+			if (m_spillReader.read((char*)chunk, chunkLength))
+				frame.m_data.append(chunk, chunkLength);
+			remaining -= chunkLength;
+		}
+		bool readOK = m_spillReader.good();
+
+		lock.lock();
+		m_unspilling = false;
+		m_unspillDone.notify_all();
+		if (m_closed)
+			return false; //the backlog is discarded by close()
+
+		if (!readOK)
+		{	//the spilled backlog is lost, account it as dropped
+			std::cout << "RS232_FrameQueue::unspillFrame() -> read from spill file failed!" << std::endl;
+			m_stats.m_droppedFrames += m_spillPending;
+			m_spillPending = 0;
+		}
+		else
+		{
+			frame.m_info.m_firstNonPrintableCharPos = header.m_firstNonPrintableCharPos;
+			frame.m_info.m_dataControl.reset();
+			if (header.m_dataControlIndex >= 0 && (size_t)header.m_dataControlIndex < m_portParams->m_dcList.size())
+				frame.m_info.m_dataControl = m_portParams->m_dcList[header.m_dataControlIndex];
+			frame.m_info.m_startTime = FrameTime(FrameClock::duration(header.m_startTicks));
+			frame.m_info.m_endTime = FrameTime(FrameClock::duration(header.m_endTicks));
+			m_spillPending--;
+		}
+
+		if (m_spillPending == 0)
+		{	//backlog drained, start over with an empty file
+			m_spillWriter.close();
+			m_spillReader.close();
+			m_spillFileBytes = 0;
+		}
+		return readOK;
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: bounded queue of received frames between the port reader thread and the frame consumer
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+
+#include "RS232_Framer.h"
+
+namespace RS232
+{
+	/*a received frame owned by the queue*/
+	struct RS232_Frame
+	{
+		RS232_SegmentedBuffer m_data; //segments handed over by the framer, never copied on the way to the consumer
+		RS232_FrameInfo m_info;
+	};
+
+	/*overflow counters of a frame queue*/
+	struct RS232_QueueStats
+	{
+		unsigned long long m_queuedFrames = 0; //frames waiting in memory & in the spill file
+		unsigned long long m_queuedBytes = 0; //memory held by the queued frames
+		unsigned long long m_peakBytes = 0; //highest memory use so far
+		unsigned long long m_droppedFrames = 0;
+		unsigned long long m_droppedBytes = 0;
+		unsigned long long m_spilledFrames = 0;
+		unsigned long long m_spilledBytes = 0;
+		unsigned long long m_blockedMicros = 0; //time the reader thread waited for the consumer (OP_BLOCK)
+	};
+
+	class RS232_FrameQueue
+	{
+	public:
+		//called under the queue lock with true when the memory held crosses the high flow watermark & with false at the low one
+		using FlowHandler = std::function<void(bool throttle)>;
+
+		RS232_FrameQueue(RS232_PortParams_Ptr portParams);
+		virtual ~RS232_FrameQueue();
+
+		//called by the reader thread, applies the overflow policy of the port when the queue is full
+		void push(RS232_Frame&& frame);
+
+		//blocks until a frame is available, returns false once the queue is closed
+		bool pop(RS232_Frame& frame);
+
+		//wakes up the blocked producer & consumer, the remaining frames are discarded
+		void close();
+
+		//re-opens a closed queue (i.e. the device is opened again)
+		void reopen();
+
+		RS232_QueueStats getStats() const;
+
+		//watermark flow control of the port, to be set before the frames are pushed
+		void setFlowHandler(FlowHandler flowHandler) { m_flowHandler = flowHandler; }
+
+		//memory accounted for a queued frame, the segments allocated for the payload plus the bookkeeping
+		static size_t frameCost(const RS232_Frame& frame);
+
+	private:
+		void dropFrame(size_t bytes);
+		bool spillFrame(const RS232_Frame& frame);
+		//reads the oldest spilled frame with the lock released, the queue state is updated once it is locked again
+		bool unspillFrame(RS232_Frame& frame, std::unique_lock<std::mutex>& lock);
+
+		//stops/releases the sender when the memory held crosses a flow watermark
+		void updateFlow();
+
+		RS232_PortParams_Ptr m_portParams;
+
+		mutable std::mutex m_guard;
+		std::condition_variable m_notEmpty;
+		std::condition_variable m_notFull;
+
+		std::deque<RS232_Frame> m_frames;
+		size_t m_memoryBytes;
+		bool m_closed;
+
+		FlowHandler m_flowHandler;
+		bool m_flowThrottled;
+
+		/*OP_SPILL: frames that do not fit in memory wait in a file, in order, behind the frames in memory*/
+		std::ofstream m_spillWriter;
+		std::ifstream m_spillReader;
+		unsigned long long m_spillPending;
+		unsigned long long m_spillFileBytes;
+		bool m_unspilling; //the consumer reads m_spillReader outside the lock, close() waits for it
+		std::condition_variable m_unspillDone;
+
+		RS232_QueueStats m_stats;
+
+		/*to protect the class from being copied*/
+		RS232_FrameQueue(const RS232_FrameQueue&) = delete;
+		RS232_FrameQueue& operator=(const RS232_FrameQueue&) = delete;
+		RS232_FrameQueue(RS232_FrameQueue&&) = delete;
+		RS232_FrameQueue& operator=(RS232_FrameQueue&) = delete;
+		/*to protect the class from being copied*/
+	};
+}
@@ -0,0 +1,82 @@
+#include "RS232_FrameReader.h"
+
+namespace RS232
+{
+	static unsigned long long getLittleEndian(const unsigned char* in, unsigned int size)
+	{
+		unsigned long long value = 0;
+		for (unsigned int i = 0; i < size; i++)
+			value |= (unsigned long long)in[i] << (8 * i);
+		return value;
+	}
+
+	RS232_FrameReader::RS232_FrameReader(std::istream& input) :
+		m_input(input),
+		m_valid(false),
+		m_readRecords(0)
+	{
+		//the listener may have printed to stdout before the output was opened
+		unsigned int matched = 0;
+		unsigned int skipped = 0;
+		char ch;
+		while (matched < sizeof(FRAME_OUTPUT_MAGIC) && skipped <= FRAME_OUTPUT_MAX_PREAMBLE && m_input.get(ch))
+		{
+			if (ch == FRAME_OUTPUT_MAGIC[matched])
+				matched++;
+			else
+			{
+				skipped += matched + 1;
+				matched = (ch == FRAME_OUTPUT_MAGIC[0]) ? 1 : 0;
+			}
+		}
+
+		unsigned char version[4];
+		if (matched == sizeof(FRAME_OUTPUT_MAGIC) && m_input.read((char*)version, sizeof(version)) &&
+			getLittleEndian(version, 4) == FRAME_OUTPUT_VERSION)
+		{
+			m_valid = true;
+		}
+	}
+
+	bool RS232_FrameReader::next(RS232_FrameRecord& record)
+	{
+		if (!m_valid)
+			return false;
+
+		unsigned char lengthBytes[4];
+		if (!m_input.read((char*)lengthBytes, sizeof(lengthBytes)))
+			return false; //end of the stream
+
+		unsigned int length = (unsigned int)getLittleEndian(lengthBytes, 4);
+		if (length < FRAME_OUTPUT_RECORD_HEADER_SIZE - 4 || length > FRAME_OUTPUT_MAX_RECORD_SIZE)
+		{
+			m_valid = false;
+			return false;
+		}
+
+		//the whole record in one read, the fields are picked from the buffer
+		m_record.resize(length);
+		if (!m_input.read(m_record.data(), length))
+		{
+			m_valid = false; //torn record at the end of the stream
+			return false;
+		}
+
+		const unsigned char* in = (const unsigned char*)m_record.data();
+		unsigned int portNameLength = in[20];
+		if (FRAME_OUTPUT_RECORD_HEADER_SIZE - 4 + portNameLength > length)
+		{
+			m_valid = false;
+			return false;
+		}
+
+		record.m_flags = (unsigned int)getLittleEndian(in, 2);
+		record.m_typeId = (int)(short)getLittleEndian(in + 2, 2);
+		record.m_startMicros = (long long)getLittleEndian(in + 4, 8);
+		record.m_endMicros = (long long)getLittleEndian(in + 12, 8);
+		record.m_portName.assign((const char*)in + 21, portNameLength);
+		record.m_data.assign((const char*)in + 21 + portNameLength, length - 21 - portNameLength);
+		m_readRecords++;
+		return true;
+	}
+}
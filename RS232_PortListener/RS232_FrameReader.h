@@ -0,0 +1,66 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: reads the binary frame records written by RS232_FrameOutput, standard C++ only so the ingest side can build it as is
+*/
+
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace RS232
+{
+	/*
+	* stream layout: magic(8) version(4), then records back to back, each one is
+	* length(4) flags(2) typeId(2) startTime(8) endTime(8) portNameLength(1) portName payload
+	* length counts the bytes after the length field, the integers are little endian,
+	* the times are microseconds since the epoch of the system clock
+	*/
+	constexpr char FRAME_OUTPUT_MAGIC[8] = { 'R', 'S', '2', '3', '2', 'F', 'R', 'M' };
+	constexpr unsigned int FRAME_OUTPUT_VERSION = 1;
+	constexpr unsigned int FRAME_OUTPUT_FILE_HEADER_SIZE = 12; //magic(8) version(4)
+	constexpr unsigned int FRAME_OUTPUT_RECORD_HEADER_SIZE = 25; //length(4) flags(2) typeId(2) startTime(8) endTime(8) portNameLength(1)
+	constexpr unsigned int FRAME_OUTPUT_MAX_RECORD_SIZE = 64 * 1024 * 1024; //anything longer is a corrupted stream
+	constexpr unsigned int FRAME_OUTPUT_MAX_PREAMBLE = 64 * 1024; //console text printed to stdout before the stream header
+
+	/*record flags*/
+	constexpr unsigned int FRAME_FLAG_BINARY = 0x0001; //the payload has non-printable chars
+
+	/*a frame record read back from the stream*/
+	struct RS232_FrameRecord
+	{
+		unsigned int m_flags = 0;
+		int m_typeId = -1; //index of the dataControl type of the port, -1 when SOD/EOD are not used
+		long long m_startMicros = 0; //start bit of the first byte
+		long long m_endMicros = 0; //stop bit of the last byte
+		std::string m_portName;
+		std::string m_data;
+	};
+
+	/*the stream has to be opened in binary mode (std::ios::binary, _setmode() for stdin)*/
+	class RS232_FrameReader final
+	{
+	public:
+		//reads & checks the stream header, skipping the console text printed before it
+		explicit RS232_FrameReader(std::istream& input);
+
+		//false when the stream header is missing or of another version
+		bool isValid() const { return m_valid; }
+
+		//false at the end of the stream or at a torn/corrupted record
+		bool next(RS232_FrameRecord& record);
+
+		unsigned long long getReadRecords() const { return m_readRecords; }
+
+	private:
+		RS232_FrameReader(const RS232_FrameReader&) = delete;
+		RS232_FrameReader& operator=(const RS232_FrameReader&) = delete;
+
+		std::istream& m_input;
+		std::vector<char> m_record; //reused, grows to the longest record
+		bool m_valid;
+		unsigned long long m_readRecords;
+	};
+}
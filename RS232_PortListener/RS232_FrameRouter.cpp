@@ -0,0 +1,218 @@
+#include "RS232_FrameRouter.h"
+
+#include <atomic>
+#include <thread>
+
+namespace RS232
+{
+	/*a route of the router, its queue is bounded by the rxQueueSize of the port*/
+	struct FrameRoute
+	{
+		std::atomic<bool> m_registered{ false }; //false routes the frames to the default sink
+
+		std::mutex m_guard;
+		std::condition_variable m_notEmpty;
+		std::condition_variable m_notFull;
+		std::deque<RS232_Frame> m_frames;
+		size_t m_queuedBytes = 0;
+		bool m_overflowing = false; //the drops are reported once until the route catches up
+		RS232_FrameRouter::RouteHandler m_handler;
+		unsigned int m_latencyBudgetMicros = DEFAULT_ROUTE_LATENCY_BUDGET;
+		bool m_running = false;
+		std::thread m_thread;
+
+		RS232_RouteStats m_stats;
+	};
+
+	RS232_FrameRouter::RS232_FrameRouter(RS232_PortParams_Ptr portParams) :
+		m_portParams(portParams)
+	{
+		for (const DataControl_Ptr& dataControl : m_portParams->m_dcList)
+		{
+			m_routes.push_back(std::unique_ptr<FrameRoute>(new FrameRoute()));
+			m_routes.back()->m_stats.m_typeName = dataControl->m_typeName;
+		}
+		m_routes.push_back(std::unique_ptr<FrameRoute>(new FrameRoute())); //the default sink
+	}
+
+	RS232_FrameRouter::~RS232_FrameRouter()
+	{
+		stop();
+	}
+
+	bool RS232_FrameRouter::registerHandler(const std::string& typeName, RouteHandler handler, unsigned int latencyBudgetMicros)
+	{
+		for (const DataControl_Ptr& dataControl : m_portParams->m_dcList)
+		{
+			if (dataControl->m_typeName == typeName)
+			{
+				FrameRoute& route = *m_routes[dataControl->m_typeId];
+				std::lock_guard<std::mutex> lock(route.m_guard);
+				route.m_handler = handler;
+				route.m_latencyBudgetMicros = latencyBudgetMicros;
+				route.m_registered = true;
+				return true;
+			}
+		}
+		std::cout << "RS232_FrameRouter::registerHandler() -> " << typeName << " is not a dataControl type of " << m_portParams->m_comPort << std::endl;
+		return false;
+	}
+
+	void RS232_FrameRouter::setDefaultSink(RouteHandler handler, unsigned int latencyBudgetMicros)
+	{
+		FrameRoute& route = *m_routes.back();
+		std::lock_guard<std::mutex> lock(route.m_guard);
+		route.m_handler = handler;
+		route.m_latencyBudgetMicros = latencyBudgetMicros;
+		route.m_registered = true;
+	}
+
+	void RS232_FrameRouter::start()
+	{
+		for (std::unique_ptr<FrameRoute>& route : m_routes)
+		{
+			std::lock_guard<std::mutex> lock(route->m_guard);
+			if (route->m_running)
+				continue;
+			route->m_running = true;
+			FrameRoute* routePtr = route.get();
+			route->m_thread = std::thread([this, routePtr]() { runRoute(*routePtr); });
+		}
+	}
+
+	void RS232_FrameRouter::stop()
+	{
+		for (std::unique_ptr<FrameRoute>& route : m_routes)
+		{
+			{
+				std::lock_guard<std::mutex> lock(route->m_guard);
+				route->m_running = false;
+				route->m_frames.clear();
+				route->m_queuedBytes = 0;
+				route->m_stats.m_queuedFrames = 0;
+				route->m_stats.m_queuedBytes = 0;
+				route->m_notEmpty.notify_all();
+				route->m_notFull.notify_all();
+			}
+			if (route->m_thread.joinable())
+				route->m_thread.join();
+		}
+	}
+
+	void RS232_FrameRouter::dispatch(RS232_Frame&& frame)
+	{
+		FrameRoute* route = m_routes.back().get();
+		if (frame.m_info.m_dataControl.get() && frame.m_info.m_dataControl->m_typeId + 1 < m_routes.size())
+		{
+			FrameRoute* typeRoute = m_routes[frame.m_info.m_dataControl->m_typeId].get();
+			if (typeRoute->m_registered)
+				route = typeRoute;
+		}
+
+		size_t cost = RS232_FrameQueue::frameCost(frame);
+		size_t capacity = m_portParams->m_rxQueueSize;
+		std::unique_lock<std::mutex> lock(route->m_guard);
+		bool fits = (route->m_queuedBytes + cost <= capacity) || route->m_frames.empty(); //a single oversized frame is still accepted
+		if (route->m_running && !fits)
+		{
+			switch (m_portParams->m_overflowPolicy)
+			{
+			case OP_DROP_NEWEST:
+			{
+				dropFrame(*route, frame.m_data.size());
+				return;
+			}
+			case OP_DROP_OLDEST:
+			{
+				while (!route->m_frames.empty() && route->m_queuedBytes + cost > capacity)
+				{
+					route->m_queuedBytes -= RS232_FrameQueue::frameCost(route->m_frames.front());
+					dropFrame(*route, route->m_frames.front().m_data.size());
+					route->m_frames.pop_front();
+				}
+			}
+			break;
+			case OP_SPILL: //the receive queue spills while the consumer waits here
+			case OP_BLOCK:
+			default:
+			{
+				route->m_notFull.wait(lock, [&]() { return !route->m_running || route->m_frames.empty() || route->m_queuedBytes + cost <= capacity; });
+			}
+			break;
+			}
+		}
+		if (!route->m_running)
+			return; //stopped, discarded like the queued frames
+
+		route->m_queuedBytes += cost;
+		route->m_frames.push_back(std::move(frame));
+		route->m_stats.m_queuedFrames = route->m_frames.size();
+		route->m_stats.m_queuedBytes = route->m_queuedBytes;
+		route->m_notEmpty.notify_one();
+	}
+
+	void RS232_FrameRouter::dropFrame(FrameRoute& route, size_t bytes)
+	{
+		if (!route.m_overflowing)
+		{
+			std::cout << "RS232_FrameRouter::dispatch() -> route " << (route.m_stats.m_typeName.empty() ? "of the default sink" : route.m_stats.m_typeName)
+				<< " of " << m_portParams->m_comPort << " is full, frames are dropped!" << std::endl;
+			route.m_overflowing = true;
+		}
+		route.m_stats.m_droppedFrames++;
+		route.m_stats.m_droppedBytes += bytes;
+	}
+
+	std::vector<RS232_RouteStats> RS232_FrameRouter::getStats() const
+	{
+		std::vector<RS232_RouteStats> stats;
+		for (const std::unique_ptr<FrameRoute>& route : m_routes)
+		{
+			std::lock_guard<std::mutex> lock(route->m_guard);
+			stats.push_back(route->m_stats);
+		}
+		return stats;
+	}
+
+	void RS232_FrameRouter::runRoute(FrameRoute& route)
+	{
+		std::unique_lock<std::mutex> lock(route.m_guard);
+		while (true)
+		{
+			route.m_notEmpty.wait(lock, [&]() { return !route.m_running || !route.m_frames.empty(); });
+			if (!route.m_running)
+				return;
+
+			RS232_Frame frame = std::move(route.m_frames.front());
+			route.m_frames.pop_front();
+			route.m_queuedBytes -= RS232_FrameQueue::frameCost(frame);
+			route.m_stats.m_queuedFrames = route.m_frames.size();
+			route.m_stats.m_queuedBytes = route.m_queuedBytes;
+			route.m_notFull.notify_one();
+			if (route.m_frames.empty())
+				route.m_overflowing = false; //the route caught up
+			RouteHandler handler = route.m_handler;
+			lock.unlock();
+
+			FrameTime start = FrameClock::now();
+			try
+			{
+				if (handler)
+					handler(frame);
+			}
+			catch (...)
+			{
+				std::cout << "RS232_FrameRouter::runRoute() -> Unknown exception occurred!!" << std::endl;
+			}
+			unsigned long long handlerMicros = std::chrono::duration_cast<std::chrono::microseconds>(FrameClock::now() - start).count();
+
+			lock.lock();
+			route.m_stats.m_frames++;
+			route.m_stats.m_bytes += frame.m_data.size();
+			if (handlerMicros > route.m_latencyBudgetMicros)
+				route.m_stats.m_overBudgetFrames++;
+			if (handlerMicros > route.m_stats.m_maxHandlerMicros)
+				route.m_stats.m_maxHandlerMicros = handlerMicros;
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: routes the received frames to the handlers registered per dataControl type, each type on its own thread
+*/
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "RS232_FrameQueue.h"
+
+namespace RS232
+{
+	/*counters of a route*/
+	struct RS232_RouteStats
+	{
+		std::string m_typeName; //empty for the default sink
+		unsigned long long m_frames = 0; //handled
+		unsigned long long m_bytes = 0;
+		unsigned long long m_droppedFrames = 0; //the queue of the route was full (OP_DROP_OLDEST, OP_DROP_NEWEST)
+		unsigned long long m_droppedBytes = 0;
+		unsigned long long m_overBudgetFrames = 0; //the handler took longer than the latency budget
+		unsigned long long m_maxHandlerMicros = 0;
+		size_t m_queuedFrames = 0;
+		size_t m_queuedBytes = 0; //memory held by the queued frames, bounded by rxQueueSize
+	};
+
+	struct FrameRoute;
+
+	/*
+	* the route of a frame is looked up by the type id of its dataControl, no string is compared per frame;
+	* every route has its own queue & thread, the queue holds up to rxQueueSize bytes like the receive queue; a full route applies
+	* the overflow policy of the port: the drop policies drop at the route, so a slow handler cannot hold up the other types,
+	* block & spill hold up the consumer thread, so the receive queue fills up & blocks the reader or spills
+	*/
+	class RS232_FrameRouter
+	{
+	public:
+		using RouteHandler = std::function<void(const RS232_Frame& frame)>;
+
+		RS232_FrameRouter(RS232_PortParams_Ptr portParams);
+		virtual ~RS232_FrameRouter();
+
+		//false if typeName is not a dataControl type of the port, can be called while frames are routed
+		bool registerHandler(const std::string& typeName, RouteHandler handler, unsigned int latencyBudgetMicros = DEFAULT_ROUTE_LATENCY_BUDGET);
+
+		//the frames without a dataControl type & the frames of the types without a handler
+		void setDefaultSink(RouteHandler handler, unsigned int latencyBudgetMicros = DEFAULT_ROUTE_LATENCY_BUDGET);
+
+		//starts the thread of every route
+		void start();
+
+		//joins the threads, the queued frames are discarded
+		void stop();
+
+		//called by the consumer thread, waits for room in a full route unless the overflow policy drops frames
+		void dispatch(RS232_Frame&& frame);
+
+		//one entry per dataControl type of the port, the default sink is the last one
+		std::vector<RS232_RouteStats> getStats() const;
+
+	private:
+		void runRoute(FrameRoute& route);
+
+		void dropFrame(FrameRoute& route, size_t bytes);
+
+		RS232_PortParams_Ptr m_portParams;
+		std::vector<std::unique_ptr<FrameRoute>> m_routes; //indexed by the type id, sized once so dispatch() needs no lock
+
+		RS232_FrameRouter(const RS232_FrameRouter&) = delete;
+		RS232_FrameRouter& operator=(const RS232_FrameRouter&) = delete;
+	};
+}
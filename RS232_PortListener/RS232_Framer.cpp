@@ -0,0 +1,609 @@
+#include "RS232_Framer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace RS232
+{
+	constexpr unsigned int MODBUS_MIN_FRAME_SIZE = 4; //address + function code + CRC
+	constexpr unsigned int MODBUS_MAX_FRAME_SIZE = 256;
+	constexpr unsigned int MODBUS_FIXED_TIMING_BAUD = 19200; //above this baud rate t1.5 & t3.5 are fixed
+
+	constexpr unsigned int COBS_MAX_BLOCK = 0xFF; //code byte of a block with 254 data bytes & no implicit zero
+
+	RS232_Framer_Ptr RS232_Framer::create(RS232_PortParams_Ptr portParams, FrameHandler frameHandler)
+	{
+		switch (portParams->m_framingMode)
+		{
+		case FM_MODBUS_RTU:
+			return RS232_Framer_Ptr(new ModbusRtuFramer(portParams, frameHandler));
+		case FM_COBS:
+			return RS232_Framer_Ptr(new CobsFramer(portParams, frameHandler));
+		case FM_SLIP:
+			return RS232_Framer_Ptr(new SlipFramer(portParams, frameHandler));
+		case FM_STX_ETX:
+		default:
+			return RS232_Framer_Ptr(new StxEtxFramer(portParams, frameHandler));
+		}
+	}
+
+	RS232_Framer::RS232_Framer(RS232_PortParams_Ptr portParams, FrameHandler frameHandler) :
+		m_portParams(portParams),
+		m_frameHandler(frameHandler),
+		m_charTime(std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::micro>(portParams->getCharTimeMicros()))),
+		m_badChecksumFrames(0),
+		m_malformedFrames(0)
+	{
+	}
+
+	void RS232_Framer::emitBinaryFrame(RS232_SegmentedBuffer& frame, FrameTime startTime, FrameTime endTime)
+	{
+		RS232_FrameInfo info;
+		info.m_startTime = startTime;
+		info.m_endTime = endTime;
+		size_t firstNonPrintableCharPos = frame.findFirstNotInRange(ASCII_SP, ASCII_TLDE);
+		if (firstNonPrintableCharPos != RS232_SegmentedBuffer::npos)
+			info.m_firstNonPrintableCharPos = (unsigned int)firstNonPrintableCharPos;
+		m_frameHandler(frame, info);
+	}
+
+	/*StxEtxFramer*/
+
+	StxEtxFramer::StxEtxFramer(RS232_PortParams_Ptr portParams, FrameHandler frameHandler) :
+		RS232_Framer(portParams, frameHandler),
+		m_receiveStatus(WaitingForSTX),
+		m_DLEReceived(false),
+		m_firstNonPrintableCharPos(NO_NON_PRINTABLE_CHAR),
+		m_tempEOD(0x00),
+		m_rxChecksum(portParams->m_checksumType),
+		m_receivedChecksumLength(0),
+		m_checksumValid(true)
+	{
+		if (m_portParams->m_dcList.size() != 0)
+			m_receiveStatus = WaitingForSOD;
+
+		for (const DataControl_Ptr& dataControl : m_portParams->m_dcList)
+		{
+			if (!m_sodTable[(unsigned char)dataControl->m_SOD].get()) //the first one wins, as in RS232_PortParams::getDataControl()
+				m_sodTable[(unsigned char)dataControl->m_SOD] = dataControl;
+		}
+	}
+
+	void StxEtxFramer::push(const unsigned char* data, unsigned int length, FrameTime arrival)
+	{
+		for (unsigned int i = 0; i < length; i++) //for all chars in string
+		{
+			char ch = data[i];
+			switch (m_receiveStatus)
+			{
+			case WaitingForSOD:
+			{
+				const DataControl_Ptr& dataControl = m_sodTable[(unsigned char)ch];
+				if (dataControl.get() && dataControl->m_EOD != ASCII_NULL)
+				{
+					if (m_portParams->m_printFrameStart)
+						std::cout << "StxEtxFramer::push() -> message read started for device type: " << dataControl->m_typeName << std::endl;
+					m_frameStartTime = byteEndTime(arrival, length - 1 - i) - m_charTime;
+					m_tempEOD = dataControl->m_EOD;
+					m_tempDataControl = dataControl;
+					m_receiveStatus = WaitingForSTX;
+				}
+			}
+			break;
+			case WaitingForSTX:
+			{
+				if (ch == m_portParams->m_STX)
+				{
+					if (m_portParams->m_dcList.size() == 0)
+					{
+						if (m_portParams->m_printFrameStart)
+							std::cout << "StxEtxFramer::push() -> message read started!" << std::endl;
+						m_frameStartTime = byteEndTime(arrival, length - 1 - i) - m_charTime;
+					}
+					m_receiveStatus = WaitingForETX;
+				}
+			}
+			break;
+			case WaitingForETX:
+			{
+				if (ch == m_portParams->m_ETX && !m_DLEReceived)
+				{
+					if (m_rxChecksum.size() > 0) //checksum bytes follow the ETX!
+					{
+						m_receivedChecksumLength = 0;
+						m_receiveStatus = WaitingForChecksum;
+					}
+					else
+					{
+						onPayloadCompleted(byteEndTime(arrival, length - 1 - i));
+					}
+				}
+				else if (m_portParams->m_DLEEnabled && !m_DLEReceived && ch == ASCII_DLE)
+				{	//removing ASCII_DLE (0x10) byte from the data!
+					m_DLEReceived = true;
+				}
+				else
+				{	//collect the whole run of payload bytes up to the next ETX or DLE at once
+					unsigned int runEnd = i + 1;
+					while (runEnd < length && (char)data[runEnd] != m_portParams->m_ETX &&
+						!(m_portParams->m_DLEEnabled && data[runEnd] == ASCII_DLE))
+					{
+						runEnd++;
+					}
+					appendPayload(data + i, runEnd - i);
+					i = runEnd - 1;
+				}
+			}
+			break;
+			case WaitingForChecksum:
+			{
+				m_receivedChecksum[m_receivedChecksumLength++] = (unsigned char)ch;
+				if (m_receivedChecksumLength == m_rxChecksum.size())
+				{
+					m_checksumValid = m_rxChecksum.verify(m_receivedChecksum);
+					onPayloadCompleted(byteEndTime(arrival, length - 1 - i));
+				}
+			}
+			break;
+			case WaitingForEOD:
+			{
+				if (ch == m_tempEOD)
+				{
+					completeFrame(byteEndTime(arrival, length - 1 - i));
+					m_receiveStatus = WaitingForSOD; //we have set SOD & EOD in the RS232.xml!
+				}
+			}
+			break;
+			default:
+			{	//DO NOTHING!!! IT IS AN ERROR!
+				std::cout << "StxEtxFramer::push() -> read procedure is in an unexpected state!" << std::endl;
+			}
+			break;
+			}
+		}//for all received bytes
+	}
+
+	std::string StxEtxFramer::encapsulate(const std::string& message) const
+	{
+		Checksum checksum(m_portParams->m_checksumType);
+
+		std::string str;
+		str.reserve(message.size() + checksum.size() + 2);
+		str += m_portParams->m_STX;
+		if (m_portParams->m_DLEEnabled)
+		{
+			for (unsigned char data : message)
+			{
+				if (data < ASCII_SP && data >= ASCII_NULL)
+					str += ASCII_DLE;
+				str += data;
+			}
+		}
+		else
+		{
+			str += message;
+		}
+		str += m_portParams->m_ETX;
+		if (checksum.size() > 0)
+		{	//checksum of the unescaped message is sent right after ETX
+			unsigned char checksumBytes[4];
+			checksum.update((const unsigned char*)message.data(), message.size());
+			checksum.encode(checksumBytes);
+			str.append((const char*)checksumBytes, checksum.size());
+		}
+		return str;
+	}
+
+	void StxEtxFramer::appendPayload(const unsigned char* data, unsigned int length)
+	{
+		size_t frameSize = m_receivedMessageBuffer.size();
+		if (!appendBounded(m_receivedMessageBuffer, data, length))
+		{
+			abortFrame();
+			return;
+		}
+
+		for (unsigned int i = 0; i < length && m_firstNonPrintableCharPos == NO_NON_PRINTABLE_CHAR; i++)
+		{
+			if (data[i] < ASCII_SP || data[i] > ASCII_TLDE)
+				m_firstNonPrintableCharPos = (unsigned int)frameSize + i;
+		}
+
+		m_rxChecksum.update(data, length); //verified incrementally, no second pass over the frame
+		m_DLEReceived = false;
+	}
+
+	void StxEtxFramer::onPayloadCompleted(FrameTime endTime)
+	{
+		if (m_portParams->m_dcList.size() > 0) //we will also wait for End Of Data (EOD)!
+		{
+			m_receiveStatus = WaitingForEOD;
+		}
+		else //end of receive!
+		{
+			completeFrame(endTime);
+			m_receiveStatus = WaitingForSTX; //NOT WaitingForSOD, because we did not set the SOD & EOD in the RS232.xml!
+		}
+	}
+
+	void StxEtxFramer::completeFrame(FrameTime endTime)
+	{
+		if (!m_checksumValid)
+		{
+			m_badChecksumFrames++;
+			std::cout << "StxEtxFramer::completeFrame() -> checksum mismatch! Frame is dropped!" << std::endl;
+			resetFrame();
+			return;
+		}
+
+		if (m_portParams->m_CREnabled && !m_receivedMessageBuffer.empty() && m_receivedMessageBuffer.back() == ASCII_CR)
+		{
+			m_receivedMessageBuffer.truncate(1);
+			if (m_firstNonPrintableCharPos == m_receivedMessageBuffer.size())
+			{	//the case we receive CR at the end of the data, we should not accidentally set the m_firstNonPrintableCharPos!
+				m_firstNonPrintableCharPos = NO_NON_PRINTABLE_CHAR;
+			}
+		}
+
+		RS232_FrameInfo info;
+		info.m_dataControl = m_tempDataControl;
+		info.m_firstNonPrintableCharPos = m_firstNonPrintableCharPos;
+		info.m_startTime = m_frameStartTime;
+		info.m_endTime = endTime;
+		m_frameHandler(m_receivedMessageBuffer, info);
+
+		resetFrame();
+	}
+
+	void StxEtxFramer::abortFrame()
+	{
+		m_malformedFrames++;
+		std::cout << "StxEtxFramer::abortFrame() -> frame exceeds " << m_portParams->m_maxFrameSize << " bytes! Frame is dropped!" << std::endl;
+		resetFrame();
+		m_receiveStatus = (m_portParams->m_dcList.size() > 0) ? WaitingForSOD : WaitingForSTX;
+	}
+
+	void StxEtxFramer::resetFrame()
+	{
+		m_receivedMessageBuffer.clear();
+		m_DLEReceived = false;
+		m_firstNonPrintableCharPos = NO_NON_PRINTABLE_CHAR;
+		m_rxChecksum.reset();
+		m_checksumValid = true;
+	}
+
+	/*ModbusRtuFramer*/
+
+	ModbusRtuFramer::ModbusRtuFramer(RS232_PortParams_Ptr portParams, FrameHandler frameHandler) :
+		RS232_Framer(portParams, frameHandler),
+		m_crc(CK_CRC16_MODBUS),
+		m_frameCorrupted(false)
+	{
+		double charTimeMicros = portParams->getCharTimeMicros();
+		if (ConvertBaudRate(portParams->m_baudRate) > MODBUS_FIXED_TIMING_BAUD)
+		{
+			m_t15 = std::chrono::microseconds(750);
+			m_t35 = std::chrono::microseconds(1750);
+		}
+		else
+		{
+			m_t15 = std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::micro>(charTimeMicros * 1.5));
+			m_t35 = std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::micro>(charTimeMicros * 3.5));
+		}
+	}
+
+	void ModbusRtuFramer::push(const unsigned char* data, unsigned int length, FrameTime arrival)
+	{
+		if (length == 0)
+			return;
+
+		//the driver hands over the chunk at once, so the first byte ended (length - 1) character times before the last one
+		FrameTime firstByteTime = byteEndTime(arrival, length - 1);
+		if (!m_frameBuffer.empty())
+		{
+			FrameClock::duration silence = firstByteTime - m_lastByteTime - m_charTime;
+			if (silence >= m_t35)
+				completeFrame();
+			else if (silence > m_t15)
+				m_frameCorrupted = true;
+		}
+		if (m_frameBuffer.empty())
+			m_frameStartTime = firstByteTime - m_charTime;
+
+		if (m_frameBuffer.size() + length > MODBUS_MAX_FRAME_SIZE)
+		{	//runaway frame, keep collecting until the next silence but do not grow the buffer
+			m_frameCorrupted = true;
+			length = std::min<unsigned int>(length, MODBUS_MAX_FRAME_SIZE - (unsigned int)std::min<size_t>(m_frameBuffer.size(), MODBUS_MAX_FRAME_SIZE));
+		}
+
+		m_frameBuffer.append(data, length);
+		m_crc.update(data, length);
+		m_lastByteTime = arrival;
+	}
+
+	void ModbusRtuFramer::poll(FrameTime now)
+	{
+		if (!m_frameBuffer.empty() && now - m_lastByteTime >= m_t35)
+			completeFrame();
+	}
+
+	DWORD ModbusRtuFramer::getIdleTimeout() const
+	{
+		//milliseconds granularity of the wait, rounded up so the silence is at least t3.5
+		auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(m_t35 + std::chrono::milliseconds(1) - FrameClock::duration(1));
+		return std::max<DWORD>(1, (DWORD)millis.count());
+	}
+
+	std::string ModbusRtuFramer::encapsulate(const std::string& message) const
+	{
+		Checksum crc(CK_CRC16_MODBUS);
+		unsigned char crcBytes[2];
+		crc.update((const unsigned char*)message.data(), message.size());
+		crc.encode(crcBytes);
+
+		std::string str;
+		str.reserve(message.size() + 2);
+		str += message;
+		str.append((const char*)crcBytes, 2);
+		return str;
+	}
+
+	void ModbusRtuFramer::completeFrame()
+	{
+		if (m_frameCorrupted || m_frameBuffer.size() < MODBUS_MIN_FRAME_SIZE)
+		{
+			m_malformedFrames++;
+			std::cout << "ModbusRtuFramer::completeFrame() -> malformed frame (" << m_frameBuffer.size() << " bytes) is dropped!" << std::endl;
+		}
+		else if (!m_crc.isValidCodeword())
+		{
+			m_badChecksumFrames++;
+			std::cout << "ModbusRtuFramer::completeFrame() -> CRC mismatch! Frame is dropped!" << std::endl;
+		}
+		else
+		{
+			m_frameBuffer.truncate(2); //CRC
+			emitBinaryFrame(m_frameBuffer, m_frameStartTime, m_lastByteTime);
+		}
+
+		m_frameBuffer.clear();
+		m_crc.reset();
+		m_frameCorrupted = false;
+	}
+
+	/*CobsFramer*/
+
+	CobsFramer::CobsFramer(RS232_PortParams_Ptr portParams, FrameHandler frameHandler) :
+		RS232_Framer(portParams, frameHandler),
+		m_rxChecksum(portParams->m_checksumType),
+		m_blockRemaining(0),
+		m_blockCode(0),
+		m_frameCorrupted(false)
+	{
+	}
+
+	void CobsFramer::push(const unsigned char* data, unsigned int length, FrameTime arrival)
+	{
+		const unsigned char* end = data + length;
+		while (data < end)
+		{
+			if (*data == ASCII_NULL)
+			{	//frame delimiter
+				completeFrame(byteEndTime(arrival, (unsigned int)(end - data - 1)));
+				data++;
+			}
+			else if (m_blockRemaining == 0)
+			{	//code byte: implicit zero of the previous block unless it was a full block
+				if (m_blockCode == 0)
+				{
+					m_frameStartTime = byteEndTime(arrival, (unsigned int)(end - data - 1)) - m_charTime;
+				}
+				else if (m_blockCode != COBS_MAX_BLOCK && !m_frameCorrupted)
+				{
+					unsigned char zero = ASCII_NULL;
+					if (appendBounded(m_frameBuffer, &zero, 1))
+						m_rxChecksum.update(&zero, 1);
+					else
+						m_frameCorrupted = true; //runaway frame, dropped at the next delimiter
+				}
+				m_blockCode = *data++;
+				m_blockRemaining = m_blockCode - 1;
+			}
+			else
+			{	//data bytes of the block, up to the end of the block or a premature delimiter
+				unsigned int runLength = (unsigned int)std::min<ptrdiff_t>(m_blockRemaining, end - data);
+				const void* delimiter = memchr(data, ASCII_NULL, runLength);
+				if (delimiter != nullptr)
+				{
+					runLength = (unsigned int)((const unsigned char*)delimiter - data);
+					m_frameCorrupted = true; //the block is cut short by the delimiter
+				}
+				if (!m_frameCorrupted && appendBounded(m_frameBuffer, data, runLength))
+					m_rxChecksum.update(data, runLength);
+				else
+					m_frameCorrupted = true; //runaway frame, dropped at the next delimiter
+				m_blockRemaining -= runLength;
+				data += runLength;
+			}
+		}
+	}
+
+	std::string CobsFramer::encapsulate(const std::string& message) const
+	{
+		Checksum checksum(m_portParams->m_checksumType);
+		unsigned char checksumBytes[4];
+		checksum.update((const unsigned char*)message.data(), message.size());
+		checksum.encode(checksumBytes);
+
+		size_t payloadLength = message.size() + checksum.size();
+		std::string str;
+		str.reserve(payloadLength + payloadLength / 254 + 2);
+
+		size_t codePos = 0;
+		unsigned char code = 1;
+		str += (char)code; //placeholder of the first code byte
+		for (size_t i = 0; i < payloadLength; i++)
+		{
+			unsigned char data = (i < message.size()) ? (unsigned char)message[i] : checksumBytes[i - message.size()];
+			if (data != ASCII_NULL)
+			{
+				str += (char)data;
+				code++;
+			}
+			if (data == ASCII_NULL || code == COBS_MAX_BLOCK)
+			{	//close the block
+				str[codePos] = (char)code;
+				codePos = str.size();
+				code = 1;
+				str += (char)code;
+			}
+		}
+		str[codePos] = (char)code;
+		str += (char)ASCII_NULL;
+		return str;
+	}
+
+	void CobsFramer::completeFrame(FrameTime endTime)
+	{
+		if (m_blockCode != 0) //ignore empty frames (back to back delimiters)
+		{
+			if (m_frameCorrupted || m_blockRemaining != 0)
+			{
+				m_malformedFrames++;
+				std::cout << "CobsFramer::completeFrame() -> malformed frame is dropped!" << std::endl;
+			}
+			else if (m_frameBuffer.size() < m_rxChecksum.size() || !m_rxChecksum.isValidCodeword())
+			{
+				m_badChecksumFrames++;
+				std::cout << "CobsFramer::completeFrame() -> checksum mismatch! Frame is dropped!" << std::endl;
+			}
+			else
+			{
+				m_frameBuffer.truncate(m_rxChecksum.size());
+				emitBinaryFrame(m_frameBuffer, m_frameStartTime, endTime);
+			}
+		}
+
+		m_frameBuffer.clear();
+		m_rxChecksum.reset();
+		m_blockRemaining = 0;
+		m_blockCode = 0;
+		m_frameCorrupted = false;
+	}
+
+	/*SlipFramer*/
+
+	SlipFramer::SlipFramer(RS232_PortParams_Ptr portParams, FrameHandler frameHandler) :
+		RS232_Framer(portParams, frameHandler),
+		m_rxChecksum(portParams->m_checksumType),
+		m_escReceived(false),
+		m_frameCorrupted(false)
+	{
+	}
+
+	void SlipFramer::push(const unsigned char* data, unsigned int length, FrameTime arrival)
+	{
+		for (unsigned int i = 0; i < length; i++)
+		{
+			unsigned char ch = data[i];
+			if (ch == SLIP_END)
+			{
+				completeFrame(byteEndTime(arrival, length - 1 - i));
+				continue;
+			}
+
+			if (m_frameBuffer.empty() && !m_escReceived)
+				m_frameStartTime = byteEndTime(arrival, length - 1 - i) - m_charTime;
+
+			if (m_escReceived)
+			{
+				if (ch == SLIP_ESC_END)
+					ch = SLIP_END;
+				else if (ch == SLIP_ESC_ESC)
+					ch = SLIP_ESC;
+				else
+					m_frameCorrupted = true; //protocol violation, RFC 1055 keeps the byte as is
+				if (appendBounded(m_frameBuffer, &ch, 1))
+					m_rxChecksum.update(&ch, 1);
+				else
+					m_frameCorrupted = true; //runaway frame, dropped at the next END
+				m_escReceived = false;
+			}
+			else if (ch == SLIP_ESC)
+			{
+				m_escReceived = true;
+			}
+			else
+			{	//collect the whole run of plain bytes up to the next END or ESC at once
+				unsigned int runEnd = i + 1;
+				while (runEnd < length && data[runEnd] != SLIP_END && data[runEnd] != SLIP_ESC)
+					runEnd++;
+				if (appendBounded(m_frameBuffer, data + i, runEnd - i))
+					m_rxChecksum.update(data + i, runEnd - i);
+				else
+					m_frameCorrupted = true; //runaway frame, dropped at the next END
+				i = runEnd - 1;
+			}
+		}
+	}
+
+	std::string SlipFramer::encapsulate(const std::string& message) const
+	{
+		Checksum checksum(m_portParams->m_checksumType);
+		unsigned char checksumBytes[4];
+		checksum.update((const unsigned char*)message.data(), message.size());
+		checksum.encode(checksumBytes);
+
+		size_t payloadLength = message.size() + checksum.size();
+		std::string str;
+		str.reserve(payloadLength + payloadLength / 64 + 2); //END & ESC are rare in typical payloads
+		str += (char)SLIP_END; //flushes any line noise received before the frame
+		for (size_t i = 0; i < payloadLength; i++)
+		{
+			unsigned char data = (i < message.size()) ? (unsigned char)message[i] : checksumBytes[i - message.size()];
+			if (data == SLIP_END)
+			{
+				str += (char)SLIP_ESC;
+				str += (char)SLIP_ESC_END;
+			}
+			else if (data == SLIP_ESC)
+			{
+				str += (char)SLIP_ESC;
+				str += (char)SLIP_ESC_ESC;
+			}
+			else
+			{
+				str += (char)data;
+			}
+		}
+		str += (char)SLIP_END;
+		return str;
+	}
+
+	void SlipFramer::completeFrame(FrameTime endTime)
+	{
+		if (!m_frameBuffer.empty() || m_frameCorrupted) //ignore empty frames (back to back END bytes)
+		{
+			if (m_frameCorrupted || m_escReceived)
+			{
+				m_malformedFrames++;
+				std::cout << "SlipFramer::completeFrame() -> malformed frame is dropped!" << std::endl;
+			}
+			else if (m_frameBuffer.size() < m_rxChecksum.size() || !m_rxChecksum.isValidCodeword())
+			{
+				m_badChecksumFrames++;
+				std::cout << "SlipFramer::completeFrame() -> checksum mismatch! Frame is dropped!" << std::endl;
+			}
+			else
+			{
+				m_frameBuffer.truncate(m_rxChecksum.size());
+				emitBinaryFrame(m_frameBuffer, m_frameStartTime, endTime);
+			}
+		}
+
+		m_frameBuffer.clear();
+		m_rxChecksum.reset();
+		m_escReceived = false;
+		m_frameCorrupted = false;
+	}
+}
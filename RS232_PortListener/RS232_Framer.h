@@ -0,0 +1,190 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: splits the received byte stream into frames & encapsulates the transmitted messages (STX/ETX, Modbus RTU, COBS, SLIP)
+*/
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "RS232_Util.h"
+
+namespace RS232
+{
+	/*metadata delivered together with a received frame*/
+	struct RS232_FrameInfo
+	{
+		DataControl_Ptr m_dataControl; //dataControl type of the frame, NULL when SOD/EOD are not used
+		unsigned int m_firstNonPrintableCharPos = NO_NON_PRINTABLE_CHAR;
+		FrameTime m_startTime; //start bit of the first byte, interpolated back from the read time with the character time
+		FrameTime m_endTime; //stop bit of the last byte (delimiter/checksum included)
+		int m_address = NO_DROP_ADDRESS; //address field of the payload on a multidrop line, set by RS232_Multidrop
+	};
+
+	class RS232_Framer;
+	using RS232_Framer_Ptr = std::unique_ptr<RS232_Framer>;
+
+	/*splits the received byte stream into frames, independent of the serial port so it can be fed by any paced stream*/
+	class RS232_Framer
+	{
+	public:
+		//called for every valid frame, the protocol overhead (escaping, checksum etc.) is already removed
+		//the handler may move the segments out of the frame, the framer starts the next frame with an empty buffer anyway
+		using FrameHandler = std::function<void(RS232_SegmentedBuffer& frame, const RS232_FrameInfo& info)>;
+
+		//creates the framer of the framing mode configured for the port
+		static RS232_Framer_Ptr create(RS232_PortParams_Ptr portParams, FrameHandler frameHandler);
+
+		RS232_Framer(RS232_PortParams_Ptr portParams, FrameHandler frameHandler);
+
+		virtual ~RS232_Framer() {};
+
+		//arrival is the time the read of the chunk returned (i.e. the end of its last byte)
+		virtual void push(const unsigned char* data, unsigned int length, FrameTime arrival) = 0;
+
+		//called when no data has arrived for getIdleTimeout() milliseconds
+		virtual void poll(FrameTime now) {};
+
+		//INFINITE for the framers which do not depend on line silence
+		virtual DWORD getIdleTimeout() const { return INFINITE; }
+
+		//wraps the message to be transmitted, safe to be called while another thread is pushing
+		virtual std::string encapsulate(const std::string& message) const = 0;
+
+		unsigned long long getBadChecksumFrames() const { return m_badChecksumFrames; }
+		unsigned long long getMalformedFrames() const { return m_malformedFrames; }
+
+	protected:
+		//for binary framers: locates the first non-printable char & calls the frame handler
+		void emitBinaryFrame(RS232_SegmentedBuffer& frame, FrameTime startTime, FrameTime endTime);
+
+		//false (& nothing is appended) when the frame would exceed the max frame size of the port
+		bool appendBounded(RS232_SegmentedBuffer& frame, const unsigned char* data, size_t length) const
+		{
+			if (frame.size() + length > m_portParams->m_maxFrameSize)
+				return false;
+			frame.append(data, length);
+			return true;
+		}
+
+		//end of the byte which is followed by bytesAfter more bytes of a chunk read at arrival
+		FrameTime byteEndTime(FrameTime arrival, unsigned int bytesAfter) const { return arrival - m_charTime * bytesAfter; }
+
+		RS232_PortParams_Ptr m_portParams;
+		FrameHandler m_frameHandler;
+		FrameClock::duration m_charTime;
+
+		std::atomic<unsigned long long> m_badChecksumFrames;
+		std::atomic<unsigned long long> m_malformedFrames;
+
+	private:
+		RS232_Framer(const RS232_Framer&) = delete;
+		RS232_Framer& operator=(const RS232_Framer&) = delete;
+	};
+
+	/*STX data ETX [checksum], DLE escaping and SOD/EOD wrapping are optional*/
+	class StxEtxFramer final : public RS232_Framer
+	{
+	public:
+		StxEtxFramer(RS232_PortParams_Ptr portParams, FrameHandler frameHandler);
+
+		void push(const unsigned char* data, unsigned int length, FrameTime arrival) override;
+
+		std::string encapsulate(const std::string& message) const override;
+
+	private:
+		void appendPayload(const unsigned char* data, unsigned int length);
+		void onPayloadCompleted(FrameTime endTime);
+		void completeFrame(FrameTime endTime);
+		void abortFrame(); //runaway frame, waits for the start of the next one
+		void resetFrame();
+
+		ReceiveStatus m_receiveStatus;
+		RS232_SegmentedBuffer m_receivedMessageBuffer;
+		bool m_DLEReceived;
+		unsigned int m_firstNonPrintableCharPos;
+		FrameTime m_frameStartTime; //of the SOD or STX byte
+
+		char m_tempEOD;
+		DataControl_Ptr m_tempDataControl; //dataControl type of the frame being received
+		DataControl_Ptr m_sodTable[256]; //dataControl type of every SOD byte, NULL for the bytes which do not start a frame
+
+		Checksum m_rxChecksum; //accumulated while the payload bytes are appended
+		unsigned char m_receivedChecksum[4];
+		unsigned int m_receivedChecksumLength;
+		bool m_checksumValid;
+	};
+
+	/*Modbus RTU: frames are separated by 3.5 character times of silence, a gap over 1.5 character times inside a frame corrupts it*/
+	class ModbusRtuFramer final : public RS232_Framer
+	{
+	public:
+		ModbusRtuFramer(RS232_PortParams_Ptr portParams, FrameHandler frameHandler);
+
+		void push(const unsigned char* data, unsigned int length, FrameTime arrival) override;
+
+		void poll(FrameTime now) override;
+
+		DWORD getIdleTimeout() const override;
+
+		//appends the CRC-16 (Modbus) of the message, low byte first
+		std::string encapsulate(const std::string& message) const override;
+
+	private:
+		void completeFrame();
+
+		FrameClock::duration m_t15; //max silence between two characters of a frame
+		FrameClock::duration m_t35; //min silence between two frames
+
+		RS232_SegmentedBuffer m_frameBuffer;
+		Checksum m_crc; //running over the address, PDU and the CRC itself; the residue is zero for a valid frame
+		FrameTime m_frameStartTime;
+		FrameTime m_lastByteTime;
+		bool m_frameCorrupted;
+	};
+
+	/*Consistent Overhead Byte Stuffing: 0x00 terminates a frame, at most 1 byte overhead per 254 payload bytes*/
+	class CobsFramer final : public RS232_Framer
+	{
+	public:
+		CobsFramer(RS232_PortParams_Ptr portParams, FrameHandler frameHandler);
+
+		void push(const unsigned char* data, unsigned int length, FrameTime arrival) override;
+
+		std::string encapsulate(const std::string& message) const override;
+
+	private:
+		void completeFrame(FrameTime endTime);
+
+		RS232_SegmentedBuffer m_frameBuffer;
+		Checksum m_rxChecksum; //running over the decoded bytes including the trailing checksum
+		FrameTime m_frameStartTime; //of the first code byte
+		unsigned int m_blockRemaining; //data bytes left in the current COBS block
+		unsigned char m_blockCode; //code byte of the current block, 0 before the first block
+		bool m_frameCorrupted;
+	};
+
+	/*Serial Line IP (RFC 1055): END terminates a frame, END & ESC inside the payload are escaped*/
+	class SlipFramer final : public RS232_Framer
+	{
+	public:
+		SlipFramer(RS232_PortParams_Ptr portParams, FrameHandler frameHandler);
+
+		void push(const unsigned char* data, unsigned int length, FrameTime arrival) override;
+
+		std::string encapsulate(const std::string& message) const override;
+
+	private:
+		void completeFrame(FrameTime endTime);
+
+		RS232_SegmentedBuffer m_frameBuffer;
+		Checksum m_rxChecksum; //running over the decoded bytes including the trailing checksum
+		FrameTime m_frameStartTime; //of the first byte after END
+		bool m_escReceived;
+		bool m_frameCorrupted;
+	};
+}
@@ -0,0 +1,460 @@
+//Winsock has to be included before Windows.h (pulled in by RS232_Util.h)
+#include <winsock2.h>
+#include <afunix.h>
+
+#include "RS232_Gateway.h"
+
+#pragma comment(lib, "Ws2_32.lib")
+
+namespace RS232
+{
+	constexpr unsigned int GATEWAY_LENGTH_PREFIX = 4;
+	constexpr unsigned int GATEWAY_MAX_MESSAGE = 65536; //longer client messages are protocol errors
+	constexpr unsigned int GATEWAY_RECEIVE_CHUNK = 4096;
+	constexpr size_t GATEWAY_SEND_BATCH = 65536;
+	constexpr size_t GATEWAY_MAX_TX_MESSAGES = 1024; //client messages waiting for the device, a flooding client loses the rest
+	constexpr int GATEWAY_POLL_TIMEOUT = 1000; //stop() wakes the loop up anyway
+	constexpr auto GATEWAY_WAKE_SUFFIX = ".wake";
+
+	/*a connected client, owned by the socket loop*/
+	struct GatewayClient
+	{
+		SOCKET m_socket = INVALID_SOCKET;
+		std::deque<std::shared_ptr<const std::string>> m_sendQueue; //length prefixed frames, shared by all clients
+		size_t m_sendOffset = 0; //bytes of the front frame already sent
+		size_t m_queuedBytes = 0;
+		std::string m_receiveBuffer;
+		bool m_closed = false;
+	};
+
+	static bool setNonBlocking(SOCKET s)
+	{
+		u_long nonBlocking = 1;
+		return ioctlsocket(s, FIONBIO, &nonBlocking) == 0;
+	}
+
+	static bool fillAddress(const std::string& socketPath, sockaddr_un& address)
+	{
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (socketPath.size() >= sizeof(address.sun_path))
+			return false;
+		memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+		return true;
+	}
+
+	static SOCKET listenOn(const std::string& socketPath)
+	{
+		sockaddr_un address;
+		if (!fillAddress(socketPath, address))
+			return INVALID_SOCKET;
+
+		DeleteFileA(socketPath.c_str()); //left over by a previous run
+		SOCKET listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listenSocket == INVALID_SOCKET)
+			return INVALID_SOCKET;
+		if (bind(listenSocket, (sockaddr*)&address, sizeof(address)) == SOCKET_ERROR || listen(listenSocket, SOMAXCONN) == SOCKET_ERROR)
+		{
+			closesocket(listenSocket);
+			return INVALID_SOCKET;
+		}
+		return listenSocket;
+	}
+
+	static void closeSocket(UINT_PTR& s)
+	{
+		if ((SOCKET)s != INVALID_SOCKET)
+			closesocket((SOCKET)s);
+		s = (UINT_PTR)INVALID_SOCKET;
+	}
+
+	RS232_Gateway::RS232_Gateway(const std::string& socketPath, size_t maxClientQueue, MessageHandler messageHandler) :
+		m_socketPath(socketPath),
+		m_maxClientQueue(maxClientQueue),
+		m_messageHandler(messageHandler),
+		m_listenSocket((UINT_PTR)INVALID_SOCKET),
+		m_wakeReader((UINT_PTR)INVALID_SOCKET),
+		m_wakeWriter((UINT_PTR)INVALID_SOCKET),
+		m_wakePending(false),
+		m_outboxOpen(false),
+		m_running(false)
+	{
+	}
+
+	RS232_Gateway::~RS232_Gateway()
+	{
+		stop();
+	}
+
+	bool RS232_Gateway::start()
+	{
+		if (m_running)
+			return true;
+
+		WSADATA wsaData;
+		if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+		{
+			std::cout << "RS232_Gateway::start() -> WSAStartup failed!" << std::endl;
+			return false;
+		}
+
+		//the wake up pair is connected over its own socket, so no client can take its place in the accept queue
+		std::string wakePath = m_socketPath + GATEWAY_WAKE_SUFFIX;
+		SOCKET wakeListener = listenOn(wakePath);
+		sockaddr_un wakeAddress;
+		if (wakeListener != INVALID_SOCKET && fillAddress(wakePath, wakeAddress))
+		{
+			m_wakeWriter = (UINT_PTR)socket(AF_UNIX, SOCK_STREAM, 0);
+			if ((SOCKET)m_wakeWriter != INVALID_SOCKET && connect((SOCKET)m_wakeWriter, (sockaddr*)&wakeAddress, sizeof(wakeAddress)) != SOCKET_ERROR)
+				m_wakeReader = (UINT_PTR)accept(wakeListener, NULL, NULL);
+		}
+		if (wakeListener != INVALID_SOCKET)
+			closesocket(wakeListener);
+		DeleteFileA(wakePath.c_str());
+
+		m_listenSocket = (UINT_PTR)listenOn(m_socketPath);
+		if ((SOCKET)m_listenSocket == INVALID_SOCKET || (SOCKET)m_wakeReader == INVALID_SOCKET
+			|| !setNonBlocking((SOCKET)m_listenSocket) || !setNonBlocking((SOCKET)m_wakeReader) || !setNonBlocking((SOCKET)m_wakeWriter))
+		{
+			std::cout << "RS232_Gateway::start() -> cannot listen on " << m_socketPath << " error: " << WSAGetLastError() << std::endl;
+			closeSocket(m_listenSocket);
+			closeSocket(m_wakeReader);
+			closeSocket(m_wakeWriter);
+			WSACleanup();
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_outboxGuard);
+			m_outboxOpen = true;
+		}
+		m_running = true;
+		m_socketThread = std::thread(&RS232_Gateway::socketLoop, this);
+		m_transmitThread = std::thread(&RS232_Gateway::transmitLoop, this);
+		std::cout << "RS232_Gateway::start() -> listening on " << m_socketPath << std::endl;
+		return true;
+	}
+
+	void RS232_Gateway::stop()
+	{
+		if (!m_running.exchange(false))
+			return;
+
+		wakeSocketLoop();
+		if (m_socketThread.joinable())
+			m_socketThread.join();
+		{
+			std::lock_guard<std::mutex> lock(m_txGuard);
+			m_txReady.notify_all();
+		}
+		if (m_transmitThread.joinable())
+			m_transmitThread.join();
+
+		for (std::unique_ptr<GatewayClient>& client : m_clients)
+			closesocket(client->m_socket);
+		m_clients.clear();
+		m_outbox.clear();
+		m_txMessages.clear();
+		m_wakePending = false;
+
+		closeSocket(m_listenSocket);
+		closeSocket(m_wakeReader);
+		closeSocket(m_wakeWriter);
+		DeleteFileA(m_socketPath.c_str());
+		WSACleanup();
+
+		std::lock_guard<std::mutex> lock(m_statsGuard);
+		m_stats.m_connectedClients = 0;
+	}
+
+	void RS232_Gateway::publish(const RS232_SegmentedBuffer& frame)
+	{
+		unsigned int length = (unsigned int)frame.size();
+		{
+			std::lock_guard<std::mutex> lock(m_statsGuard);
+			if (!m_running || m_stats.m_connectedClients == 0)
+				return;
+			m_stats.m_framesPublished++;
+		}
+
+		//encoded once, the clients share the same buffer
+		std::shared_ptr<std::string> message = std::make_shared<std::string>(GATEWAY_LENGTH_PREFIX + length, '\0');
+		for (unsigned int i = 0; i < GATEWAY_LENGTH_PREFIX; i++)
+			(*message)[i] = (char)(length >> (8 * i));
+		frame.copyTo((unsigned char*)&(*message)[GATEWAY_LENGTH_PREFIX], 0, length);
+
+		bool wake = false;
+		{
+			std::lock_guard<std::mutex> lock(m_outboxGuard);
+			if (!m_outboxOpen)
+				return;
+			m_outbox.push_back(message);
+			wake = !m_wakePending;
+			m_wakePending = true;
+		}
+		if (wake)
+			wakeSocketLoop();
+	}
+
+	RS232_GatewayStats RS232_Gateway::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_statsGuard);
+		return m_stats;
+	}
+
+	void RS232_Gateway::wakeSocketLoop()
+	{
+		char wakeByte = 1;
+		send((SOCKET)m_wakeWriter, &wakeByte, 1, 0); //a full pipe means the loop is already due to wake up
+	}
+
+	void RS232_Gateway::socketLoop()
+	{
+		std::vector<WSAPOLLFD> pollFds;
+		while (m_running)
+		{
+			pollFds.resize(2 + m_clients.size());
+			pollFds[0].fd = (SOCKET)m_listenSocket;
+			pollFds[0].events = POLLRDNORM;
+			pollFds[1].fd = (SOCKET)m_wakeReader;
+			pollFds[1].events = POLLRDNORM;
+			for (size_t i = 0; i < m_clients.size(); i++)
+			{
+				pollFds[2 + i].fd = m_clients[i]->m_socket;
+				pollFds[2 + i].events = POLLRDNORM | (m_clients[i]->m_sendQueue.empty() ? 0 : POLLWRNORM);
+			}
+			for (WSAPOLLFD& pollFd : pollFds)
+				pollFd.revents = 0;
+
+			if (WSAPoll(pollFds.data(), (ULONG)pollFds.size(), GATEWAY_POLL_TIMEOUT) == SOCKET_ERROR)
+			{
+				if (WSAGetLastError() == WSAEINTR)
+					continue;
+				std::cout << "RS232_Gateway::socketLoop() -> WSAPoll failed, error: " << WSAGetLastError() << std::endl;
+				break;
+			}
+
+			size_t polledClients = pollFds.size() - 2; //the clients accepted below are polled in the next round
+			if (pollFds[1].revents & POLLRDNORM)
+			{
+				char drain[64];
+				while (recv((SOCKET)m_wakeReader, drain, sizeof(drain), 0) > 0);
+				fanOut();
+			}
+			if (pollFds[0].revents & POLLRDNORM)
+				acceptClients();
+
+			for (size_t i = 0; i < polledClients; i++)
+			{
+				GatewayClient& client = *m_clients[i];
+				short revents = pollFds[2 + i].revents;
+				if (client.m_closed || revents == 0)
+					continue;
+				if ((revents & (POLLRDNORM | POLLHUP | POLLERR | POLLNVAL)) && !readFromClient(client))
+					client.m_closed = true;
+				else if ((revents & POLLWRNORM) && !writeToClient(client))
+					client.m_closed = true;
+			}
+
+			size_t connectedClients = m_clients.size();
+			for (auto iter = m_clients.begin(); iter != m_clients.end();)
+			{
+				if ((*iter)->m_closed)
+				{
+					closesocket((*iter)->m_socket);
+					iter = m_clients.erase(iter);
+				}
+				else
+					++iter;
+			}
+			if (connectedClients != m_clients.size())
+			{
+				std::lock_guard<std::mutex> lock(m_statsGuard);
+				m_stats.m_connectedClients = m_clients.size();
+			}
+		}
+
+		//stopped or failed: the publishers must not queue frames nobody takes out
+		{
+			std::lock_guard<std::mutex> lock(m_outboxGuard);
+			m_outboxOpen = false;
+			m_outbox.clear();
+		}
+		std::lock_guard<std::mutex> lock(m_statsGuard);
+		m_stats.m_connectedClients = 0;
+	}
+
+	void RS232_Gateway::acceptClients()
+	{
+		while (true)
+		{
+			SOCKET clientSocket = accept((SOCKET)m_listenSocket, NULL, NULL);
+			if (clientSocket == INVALID_SOCKET)
+				break; //WSAEWOULDBLOCK, no more pending connections
+			if (!setNonBlocking(clientSocket))
+			{
+				closesocket(clientSocket);
+				continue;
+			}
+
+			std::unique_ptr<GatewayClient> client(new GatewayClient());
+			client->m_socket = clientSocket;
+			m_clients.push_back(std::move(client));
+
+			std::lock_guard<std::mutex> lock(m_statsGuard);
+			m_stats.m_acceptedClients++;
+			m_stats.m_connectedClients = m_clients.size();
+		}
+	}
+
+	bool RS232_Gateway::readFromClient(GatewayClient& client)
+	{
+		char chunk[GATEWAY_RECEIVE_CHUNK];
+		while (true)
+		{
+			int received = recv(client.m_socket, chunk, sizeof(chunk), 0);
+			if (received == 0)
+				return false; //disconnected
+			if (received == SOCKET_ERROR)
+			{
+				if (WSAGetLastError() == WSAEWOULDBLOCK)
+					break;
+				return false;
+			}
+			client.m_receiveBuffer.append(chunk, received);
+		}
+
+		size_t pos = 0;
+		while (client.m_receiveBuffer.size() - pos >= GATEWAY_LENGTH_PREFIX)
+		{
+			const unsigned char* prefix = (const unsigned char*)client.m_receiveBuffer.data() + pos;
+			unsigned int length = prefix[0] | (prefix[1] << 8) | (prefix[2] << 16) | ((unsigned int)prefix[3] << 24);
+			if (length > GATEWAY_MAX_MESSAGE)
+			{
+				std::cout << "RS232_Gateway::readFromClient() -> message of " << length << " bytes, client disconnected!" << std::endl;
+				std::lock_guard<std::mutex> lock(m_statsGuard);
+				m_stats.m_protocolErrors++;
+				return false;
+			}
+			if (client.m_receiveBuffer.size() - pos < GATEWAY_LENGTH_PREFIX + length)
+				break;
+
+			bool dropped = false;
+			{
+				std::lock_guard<std::mutex> lock(m_txGuard);
+				if (m_txMessages.size() < GATEWAY_MAX_TX_MESSAGES)
+				{
+					m_txMessages.push_back(client.m_receiveBuffer.substr(pos + GATEWAY_LENGTH_PREFIX, length));
+					m_txReady.notify_one();
+				}
+				else
+				{
+					dropped = true; //the line is slower than the clients, the device cannot take more
+				}
+			}
+			if (dropped)
+			{
+				std::lock_guard<std::mutex> lock(m_statsGuard);
+				m_stats.m_messagesDropped++;
+			}
+			pos += GATEWAY_LENGTH_PREFIX + length;
+		}
+		client.m_receiveBuffer.erase(0, pos);
+		return true;
+	}
+
+	bool RS232_Gateway::writeToClient(GatewayClient& client)
+	{
+		while (!client.m_sendQueue.empty())
+		{
+			//the queued frames are gathered into a single send
+			m_sendBuffer.clear();
+			size_t offset = client.m_sendOffset;
+			for (auto iter = client.m_sendQueue.begin(); iter != client.m_sendQueue.end() && m_sendBuffer.size() < GATEWAY_SEND_BATCH; ++iter)
+			{
+				m_sendBuffer.append((*iter)->data() + offset, (*iter)->size() - offset);
+				offset = 0;
+			}
+
+			int sent = send(client.m_socket, m_sendBuffer.data(), (int)m_sendBuffer.size(), 0);
+			if (sent == SOCKET_ERROR)
+				return WSAGetLastError() == WSAEWOULDBLOCK;
+
+			size_t remaining = sent;
+			while (remaining > 0)
+			{
+				size_t frameLeft = client.m_sendQueue.front()->size() - client.m_sendOffset;
+				if (remaining < frameLeft)
+				{
+					client.m_sendOffset += remaining;
+					break;
+				}
+				remaining -= frameLeft;
+				client.m_queuedBytes -= client.m_sendQueue.front()->size();
+				client.m_sendQueue.pop_front();
+				client.m_sendOffset = 0;
+			}
+			if ((size_t)sent < m_sendBuffer.size())
+				break; //the socket buffer is full
+		}
+		return true;
+	}
+
+	void RS232_Gateway::fanOut()
+	{
+		std::vector<std::shared_ptr<const std::string>> frames;
+		{
+			std::lock_guard<std::mutex> lock(m_outboxGuard);
+			frames.swap(m_outbox);
+			m_wakePending = false;
+		}
+
+		for (std::unique_ptr<GatewayClient>& client : m_clients)
+		{
+			if (client->m_closed)
+				continue;
+			for (const std::shared_ptr<const std::string>& frame : frames)
+			{
+				if (client->m_queuedBytes + frame->size() > m_maxClientQueue)
+				{	//a slow client must not hold the frames of the others
+					client->m_closed = true;
+					std::lock_guard<std::mutex> lock(m_statsGuard);
+					m_stats.m_slowClientsDropped++;
+					break;
+				}
+				client->m_sendQueue.push_back(frame);
+				client->m_queuedBytes += frame->size();
+			}
+			if (!client->m_closed && !writeToClient(*client))
+				client->m_closed = true;
+		}
+	}
+
+	void RS232_Gateway::transmitLoop()
+	{
+		while (true)
+		{
+			std::string message;
+			{
+				std::unique_lock<std::mutex> lock(m_txGuard);
+				m_txReady.wait(lock, [&]() { return !m_running || !m_txMessages.empty(); });
+				if (!m_running)
+					return;
+				message.swap(m_txMessages.front());
+				m_txMessages.pop_front();
+			}
+
+			try
+			{
+				m_messageHandler(message);
+			}
+			catch (...)
+			{
+				std::cout << "RS232_Gateway::transmitLoop() -> Unknown exception occurred!!" << std::endl;
+			}
+
+			std::lock_guard<std::mutex> lock(m_statsGuard);
+			m_stats.m_messagesReceived++;
+		}
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: exposes a port over a Unix domain socket, received frames fan out to every client & client messages are sent to the device
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "RS232_Util.h"
+
+namespace RS232
+{
+	/*gateway counters*/
+	struct RS232_GatewayStats
+	{
+		unsigned long long m_connectedClients = 0; //currently connected
+		unsigned long long m_acceptedClients = 0;
+		unsigned long long m_slowClientsDropped = 0; //disconnected because their send queue overflowed
+		unsigned long long m_protocolErrors = 0; //disconnected because of an invalid length prefix
+		unsigned long long m_framesPublished = 0;
+		unsigned long long m_messagesReceived = 0; //client messages forwarded to the device
+		unsigned long long m_messagesDropped = 0; //client messages dropped because too many were waiting for the device
+	};
+
+	struct GatewayClient;
+
+	/*
+	* every message on the socket, in both directions, is a 4 byte little endian length followed by the payload
+	* the socket loop never blocks on a client: a client whose send queue exceeds the limit is disconnected
+	*/
+	class RS232_Gateway
+	{
+	public:
+		//called on the gateway's transmit thread, one message at a time
+		using MessageHandler = std::function<void(const std::string& message)>;
+
+		RS232_Gateway(const std::string& socketPath, size_t maxClientQueue, MessageHandler messageHandler);
+		virtual ~RS232_Gateway();
+
+		//binds the socket & starts the socket loop and the transmit thread
+		bool start();
+
+		//disconnects the clients & joins the threads
+		void stop();
+
+		//queues the frame for every connected client, never blocks the caller on a slow client
+		void publish(const RS232_SegmentedBuffer& frame);
+
+		RS232_GatewayStats getStats() const;
+
+	private:
+		void socketLoop();
+		void transmitLoop();
+
+		void acceptClients();
+		bool readFromClient(GatewayClient& client);
+		bool writeToClient(GatewayClient& client);
+		void fanOut();
+		void wakeSocketLoop();
+
+		std::string m_socketPath;
+		size_t m_maxClientQueue;
+		MessageHandler m_messageHandler;
+
+		/*sockets, only touched by the socket loop after start()*/
+		UINT_PTR m_listenSocket;
+		UINT_PTR m_wakeReader; //the socket loop polls it, a byte written to m_wakeWriter wakes the loop up
+		UINT_PTR m_wakeWriter;
+		std::vector<std::unique_ptr<GatewayClient>> m_clients;
+		std::string m_sendBuffer; //frames of a client gathered for a single send
+
+		/*frames published by the reader thread, waiting for the socket loop*/
+		mutable std::mutex m_outboxGuard;
+		std::vector<std::shared_ptr<const std::string>> m_outbox;
+		bool m_wakePending;
+		bool m_outboxOpen; //false once the socket loop is gone, nothing would take the frames out
+
+		/*client messages waiting for the transmit thread*/
+		std::mutex m_txGuard;
+		std::condition_variable m_txReady;
+		std::deque<std::string> m_txMessages;
+
+		std::atomic<bool> m_running;
+		std::thread m_socketThread;
+		std::thread m_transmitThread;
+
+		mutable std::mutex m_statsGuard;
+		RS232_GatewayStats m_stats;
+
+		RS232_Gateway(const RS232_Gateway&) = delete;
+		RS232_Gateway& operator=(const RS232_Gateway&) = delete;
+	};
+	using RS232_Gateway_Ptr = std::unique_ptr<RS232_Gateway>;
+}
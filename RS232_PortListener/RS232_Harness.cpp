@@ -0,0 +1,276 @@
+#include "RS232_Harness.h"
+#include "RS232_Device.h"
+#include "INI_Manager.h"
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <sstream>
+
+namespace RS232
+{
+	constexpr DWORD HARNESS_FRAME_TIMEOUT = 2000; //a frame not received within it is counted as lost
+	constexpr DWORD HARNESS_CONNECT_TIMEOUT = 1000;
+	constexpr unsigned int HARNESS_CONNECT_ATTEMPTS = 10; //the ports may still be opening
+	constexpr auto HARNESS_PROBE_PREFIX = "HARNESS#";
+
+	/*a frame handed to the harness together with the time it left the device*/
+	struct HarnessArrival
+	{
+		RS232_AsyncFrame m_result;
+		FrameTime m_time;
+	};
+
+	struct LatencyResult
+	{
+		std::vector<double> m_samples; //microseconds, sorted
+		unsigned int m_lost = 0;
+		size_t m_wireBytes = 0;
+	};
+
+	struct ThroughputResult
+	{
+		unsigned int m_frames = 0;
+		unsigned int m_lost = 0;
+		double m_payloadBytesPerSecond = 0.0;
+		double m_wireBytesPerSecond = 0.0;
+		double m_lineUtilization = 0.0;
+	};
+
+	static double micros(FrameTime from, FrameTime to)
+	{
+		return std::chrono::duration<double, std::micro>(to - from).count();
+	}
+
+	static double percentile(const std::vector<double>& sorted, double p)
+	{
+		if (sorted.empty())
+			return 0.0;
+		return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+	}
+
+	static size_t wireSize(RS232_PortParams_Ptr portParams, const std::string& payload)
+	{
+		RS232_Framer_Ptr framer = RS232_Framer::create(portParams, [](RS232_SegmentedBuffer&, const RS232_FrameInfo&) {});
+		return framer->encapsulate(payload).size();
+	}
+
+	static std::future<HarnessArrival> expectFrame(RS232_Device_Ptr device)
+	{
+		std::shared_ptr<std::promise<HarnessArrival>> arrival = std::make_shared<std::promise<HarnessArrival>>();
+		device->asyncNextFrame(HARNESS_FRAME_TIMEOUT, [arrival](RS232_AsyncFrame result)
+		{
+			HarnessArrival harnessArrival;
+			harnessArrival.m_time = FrameClock::now();
+			harnessArrival.m_result = std::move(result);
+			arrival->set_value(std::move(harnessArrival));
+		});
+		return arrival->get_future();
+	}
+
+	//one probe after the other until the listen port receives one, i.e. both ports are open
+	static bool waitForConnection(RS232_Device_Ptr listenDevice, RS232_Device_Ptr peerDevice)
+	{
+		for (unsigned int attempt = 0; attempt < HARNESS_CONNECT_ATTEMPTS; attempt++)
+		{
+			std::shared_ptr<std::promise<bool>> received = std::make_shared<std::promise<bool>>();
+			std::future<bool> connected = received->get_future();
+			listenDevice->asyncNextFrame(HARNESS_CONNECT_TIMEOUT, [received](RS232_AsyncFrame result)
+			{
+				received->set_value(result.m_status == AS_OK);
+			});
+			peerDevice->sendMessageToDevice(std::string(HARNESS_PROBE_PREFIX) + "CONNECT");
+			if (connected.get())
+				return true;
+		}
+		return false;
+	}
+
+	//peer -> listen, one frame at a time so that no frame waits behind another
+	static LatencyResult measureOneWay(RS232_Device_Ptr listenDevice, RS232_Device_Ptr peerDevice, RS232_PortParams_Ptr peerParams,
+		const std::string& payload, unsigned int frames)
+	{
+		LatencyResult latency;
+		latency.m_wireBytes = wireSize(peerParams, payload);
+		for (unsigned int i = 0; i < frames; i++)
+		{
+			std::future<HarnessArrival> arrival = expectFrame(listenDevice);
+			FrameTime sent = FrameClock::now();
+			peerDevice->sendMessageToDevice(payload);
+
+			HarnessArrival harnessArrival = arrival.get();
+			if (harnessArrival.m_result.m_status == AS_OK && harnessArrival.m_result.m_frame.m_data.toString() == payload)
+				latency.m_samples.push_back(micros(sent, harnessArrival.m_time));
+			else
+				latency.m_lost++; //timed out, or a late frame of a previous sample
+		}
+		std::sort(latency.m_samples.begin(), latency.m_samples.end());
+		return latency;
+	}
+
+	//peer request -> listen echoes it back with asyncSend -> peer response
+	static LatencyResult measureRoundTrip(RS232_Device_Ptr listenDevice, RS232_Device_Ptr peerDevice, RS232_PortParams_Ptr peerParams, unsigned int frames)
+	{
+		LatencyResult latency;
+		RS232_Device* echoDevice = listenDevice.get();
+		for (unsigned int i = 0; i < frames; i++)
+		{
+			std::string probe = HARNESS_PROBE_PREFIX + std::to_string(i);
+			latency.m_wireBytes = wireSize(peerParams, probe);
+
+			listenDevice->asyncNextFrame(HARNESS_FRAME_TIMEOUT, [echoDevice](RS232_AsyncFrame result)
+			{
+				if (result.m_status == AS_OK)
+					echoDevice->asyncSend(result.m_frame.m_data.toString(), [](AsyncStatus) {});
+			});
+
+			std::shared_ptr<std::promise<HarnessArrival>> response = std::make_shared<std::promise<HarnessArrival>>();
+			std::future<HarnessArrival> arrival = response->get_future();
+			FrameTime sent = FrameClock::now();
+			peerDevice->asyncRequest(probe, HARNESS_FRAME_TIMEOUT, [response](RS232_AsyncFrame result)
+			{
+				HarnessArrival harnessArrival;
+				harnessArrival.m_time = FrameClock::now();
+				harnessArrival.m_result = std::move(result);
+				response->set_value(std::move(harnessArrival));
+			});
+
+			HarnessArrival harnessArrival = arrival.get();
+			if (harnessArrival.m_result.m_status == AS_OK && harnessArrival.m_result.m_frame.m_data.toString() == probe)
+				latency.m_samples.push_back(micros(sent, harnessArrival.m_time));
+			else
+				latency.m_lost++;
+		}
+		std::sort(latency.m_samples.begin(), latency.m_samples.end());
+		return latency;
+	}
+
+	//the peer writes the frames back to back, the rate is measured until the listen port emits the last one
+	static ThroughputResult measureThroughput(RS232_Device_Ptr listenDevice, RS232_Device_Ptr peerDevice, RS232_PortParams_Ptr peerParams,
+		const std::string& payload, unsigned int frames)
+	{
+		ThroughputResult throughput;
+		std::promise<FrameTime> lastFrame;
+		std::future<FrameTime> done = lastFrame.get_future();
+		unsigned int received = 0;
+
+		RS232_Device* listen = listenDevice.get();
+		std::function<void(RS232_AsyncFrame)> onFrame;
+		onFrame = [&](RS232_AsyncFrame result)
+		{
+			if (result.m_status == AS_OK && result.m_frame.m_data.toString() == payload)
+				received++;
+			else
+				throughput.m_lost++;
+
+			if (result.m_status != AS_OK || received + throughput.m_lost == frames)
+				lastFrame.set_value(FrameClock::now());
+			else
+				listen->asyncNextFrame(HARNESS_FRAME_TIMEOUT, onFrame);
+		};
+		listen->asyncNextFrame(HARNESS_FRAME_TIMEOUT, onFrame);
+
+		FrameTime start = FrameClock::now();
+		for (unsigned int i = 0; i < frames; i++)
+			peerDevice->sendMessageToDevice(payload);
+		double seconds = std::chrono::duration<double>(done.get() - start).count();
+
+		throughput.m_frames = received;
+		throughput.m_lost = frames - received; //including the frames never reached after a timeout
+		throughput.m_payloadBytesPerSecond = received * payload.size() / seconds;
+		throughput.m_wireBytesPerSecond = received * wireSize(peerParams, payload) / seconds;
+		throughput.m_lineUtilization = throughput.m_wireBytesPerSecond * peerParams->getCharTimeMicros() / 1000000.0;
+		return throughput;
+	}
+
+	static void writeLatency(std::ostream& json, const LatencyResult& latency)
+	{
+		json << "{ \"wireBytes\": " << latency.m_wireBytes << ", \"samples\": " << latency.m_samples.size() << ", \"lost\": " << latency.m_lost
+			<< ", \"p50\": " << percentile(latency.m_samples, 0.5) << ", \"p99\": " << percentile(latency.m_samples, 0.99)
+			<< ", \"p999\": " << percentile(latency.m_samples, 0.999) << ", \"max\": " << (latency.m_samples.empty() ? 0.0 : latency.m_samples.back()) << " }";
+	}
+
+	bool RS232_Harness::run(RS232_PortParams_Ptr listenParams, RS232_PortParams_Ptr peerParams, RS232_HarnessParams_Ptr harnessParams,
+		const std::string& transmitFilePath, const std::string& resultPath)
+	{
+		std::string payload = TransmitDataHandler::prepareTransmitData(transmitFilePath);
+		if (payload.empty())
+		{
+			std::cout << "RS232_Harness::run() -> no data to be sent in " << transmitFilePath << std::endl;
+			return false;
+		}
+
+		std::shared_ptr<RS232_EventLoop> eventLoop = std::make_shared<RS232_EventLoop>(2);
+		RS232_Device_Ptr listenDevice = RS232_Device_Ptr(new RS232_Device(listenParams));
+		RS232_Device_Ptr peerDevice = RS232_Device_Ptr(new RS232_Device(peerParams));
+		listenDevice->setExecutor(eventLoop);
+		peerDevice->setExecutor(eventLoop);
+		listenDevice->openDevice();
+		peerDevice->openDevice();
+
+		bool connected = waitForConnection(listenDevice, peerDevice);
+		LatencyResult probeLatency;
+		LatencyResult payloadLatency;
+		LatencyResult roundTrip;
+		ThroughputResult throughput;
+		if (connected)
+		{
+			probeLatency = measureOneWay(listenDevice, peerDevice, peerParams, std::string(HARNESS_PROBE_PREFIX) + "PROBE", harnessParams->m_frames);
+			payloadLatency = measureOneWay(listenDevice, peerDevice, peerParams, payload, harnessParams->m_frames);
+			roundTrip = measureRoundTrip(listenDevice, peerDevice, peerParams, harnessParams->m_frames);
+			throughput = measureThroughput(listenDevice, peerDevice, peerParams, payload, harnessParams->m_frames);
+		}
+		else
+		{
+			std::cout << "RS232_Harness::run() -> " << listenParams->m_comPort << " receives nothing from " << peerParams->m_comPort << std::endl;
+		}
+
+		listenDevice->closeDevice();
+		peerDevice->closeDevice();
+		eventLoop->stop(); //no handler may run on the devices any more
+
+		//the payload frame may take longer on the wire than the threshold itself, its own wire time is allowed on top
+		double maxPayloadOneWayP99 = harnessParams->m_maxOneWayP99 + payloadLatency.m_wireBytes * peerParams->getCharTimeMicros();
+		bool passed = connected
+			&& probeLatency.m_lost == 0 && payloadLatency.m_lost == 0 && roundTrip.m_lost == 0 && throughput.m_lost == 0
+			&& percentile(probeLatency.m_samples, 0.99) <= harnessParams->m_maxOneWayP99
+			&& percentile(payloadLatency.m_samples, 0.99) <= maxPayloadOneWayP99
+			&& percentile(roundTrip.m_samples, 0.99) <= harnessParams->m_maxRoundTripP99
+			&& throughput.m_lineUtilization >= harnessParams->m_minLineUtilization;
+
+		std::ostringstream json;
+		json << std::fixed << std::setprecision(1);
+		json << "{" << std::endl
+			<< "  \"listenPort\": \"" << listenParams->m_comPort << "\", \"peerPort\": \"" << peerParams->m_comPort << "\"," << std::endl
+			<< "  \"baudRate\": " << ConvertBaudRate(peerParams->m_baudRate) << ", \"connected\": " << (connected ? TRUE_STR : FALSE_STR) << "," << std::endl
+			<< "  \"latencyUnit\": \"us\"," << std::endl
+			<< "  \"oneWayProbe\": ";
+		writeLatency(json, probeLatency);
+		json << "," << std::endl << "  \"oneWayPayload\": ";
+		writeLatency(json, payloadLatency);
+		json << "," << std::endl << "  \"roundTrip\": ";
+		writeLatency(json, roundTrip);
+		json << "," << std::endl
+			<< "  \"throughput\": { \"frames\": " << throughput.m_frames << ", \"lost\": " << throughput.m_lost
+			<< ", \"payloadBytesPerSecond\": " << throughput.m_payloadBytesPerSecond << ", \"wireBytesPerSecond\": " << throughput.m_wireBytesPerSecond
+			<< ", \"lineUtilization\": " << std::setprecision(3) << throughput.m_lineUtilization << " }," << std::endl
+			<< "  \"thresholds\": { \"maxOneWayP99\": " << std::setprecision(1) << harnessParams->m_maxOneWayP99
+			<< ", \"maxPayloadOneWayP99\": " << maxPayloadOneWayP99
+			<< ", \"maxRoundTripP99\": " << harnessParams->m_maxRoundTripP99
+			<< ", \"minLineUtilization\": " << std::setprecision(3) << harnessParams->m_minLineUtilization << " }," << std::endl
+			<< "  \"pass\": " << (passed ? TRUE_STR : FALSE_STR) << std::endl
+			<< "}" << std::endl;
+
+		std::cout << json.str();
+		if (!resultPath.empty())
+		{
+			std::ofstream resultFile(resultPath, std::ios::trunc);
+			if (resultFile)
+				resultFile << json.str();
+			else
+				std::cout << "RS232_Harness::run() -> cannot write " << resultPath << std::endl;
+		}
+		return passed;
+	}
+}
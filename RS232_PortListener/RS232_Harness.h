@@ -0,0 +1,34 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: end-to-end latency & throughput harness over a connected pair of ports (e.g. a com0com virtual null-modem pair)
+*/
+
+#include <string>
+
+#include "RS232_Util.h"
+
+namespace RS232
+{
+	class RS232_Harness final
+	{
+	public:
+		/*
+		* the peer port sends frames through the whole RS232_PortHandler/RS232_Device stack of the listen port & back,
+		* the results are printed (and written to resultPath when given) as JSON, false if a threshold is not met
+		*/
+		static bool run(RS232_PortParams_Ptr listenParams, RS232_PortParams_Ptr peerParams, RS232_HarnessParams_Ptr harnessParams,
+			const std::string& transmitFilePath, const std::string& resultPath);
+
+	private:
+		/*to protect the static class from being copied*/
+		RS232_Harness() = delete;
+		RS232_Harness(const RS232_Harness&) = delete;
+		RS232_Harness& operator=(const RS232_Harness&) = delete;
+		RS232_Harness(RS232_Harness&&) = delete;
+		RS232_Harness& operator=(RS232_Harness&) = delete;
+		/*to protect the static class from being copied*/
+	};
+}
@@ -0,0 +1,376 @@
+#include "RS232_Journal.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace RS232
+{
+	constexpr unsigned int JOURNAL_HEADER_SIZE = 25; //length(4) crc32(4) sequence(8) timestamp(8) portNameLength(1)
+	constexpr unsigned int JOURNAL_CRC_OFFSET = 8; //the CRC covers the record from the sequence field on
+	constexpr size_t JOURNAL_MAX_PENDING = 16 * 1024 * 1024; //appenders wait for the commit thread beyond it, minutes of traffic even at 921600 baud
+	constexpr auto JOURNAL_FILE_PREFIX = "rs232_";
+	constexpr auto JOURNAL_FILE_EXTENSION = ".journal";
+
+	static void putLittleEndian(unsigned char* out, unsigned long long value, unsigned int size)
+	{
+		for (unsigned int i = 0; i < size; i++)
+			out[i] = (unsigned char)(value >> (8 * i));
+	}
+
+	static unsigned long long getLittleEndian(const unsigned char* in, unsigned int size)
+	{
+		unsigned long long value = 0;
+		for (unsigned int i = 0; i < size; i++)
+			value |= (unsigned long long)in[i] << (8 * i);
+		return value;
+	}
+
+	RS232_Journal_Ptr RS232_Journal::m_instance = nullptr;
+
+	RS232_Journal_Ptr& RS232_Journal::getInstance()
+	{
+		if (m_instance == nullptr)
+			m_instance = std::unique_ptr<RS232_Journal>(new RS232_Journal());
+		return m_instance;
+	}
+
+	RS232_Journal::RS232_Journal() :
+		m_lastSequence(0),
+		m_durableSequence(0),
+		m_open(false),
+		m_closing(false),
+		m_failed(false),
+		m_segmentHandle(INVALID_HANDLE_VALUE),
+		m_segmentIndex(0),
+		m_segmentSize(0)
+	{
+	}
+
+	RS232_Journal::~RS232_Journal()
+	{
+		close();
+	}
+
+	bool RS232_Journal::open(RS232_JournalParams_Ptr journalParams)
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		if (m_open)
+			return true;
+
+		m_journalParams = journalParams;
+		m_stats = RS232_JournalStats();
+		m_pending.clear();
+		m_failed = false;
+		m_closing = false;
+		if (!recover())
+			return false;
+
+		m_open = true;
+		m_commitThread = std::thread(&RS232_Journal::commitLoop, this);
+		std::cout << "RS232_Journal::open() -> journal opened in " << m_journalParams->m_directory << ", last sequence: " << m_lastSequence << std::endl;
+		return true;
+	}
+
+	void RS232_Journal::close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			if (!m_open)
+				return;
+			m_closing = true;
+			m_commitRequested.notify_one();
+		}
+
+		if (m_commitThread.joinable())
+			m_commitThread.join();
+		closeSegment();
+
+		std::lock_guard<std::mutex> lock(m_guard);
+		m_open = false;
+		m_closing = false;
+		m_durable.notify_all();
+	}
+
+	bool RS232_Journal::isOpen() const
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		return m_open;
+	}
+
+	unsigned long long RS232_Journal::append(const std::string& portName, const RS232_SegmentedBuffer& frame)
+	{
+		unsigned int length = (unsigned int)frame.size();
+		unsigned long long timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		unsigned int portNameLength = (unsigned int)std::min<size_t>(portName.size(), 0xFF);
+
+		std::unique_lock<std::mutex> lock(m_guard);
+		if (m_pending.size() >= JOURNAL_MAX_PENDING)
+		{
+			//back pressure instead of a drop, the frame is journaled before the overflow policy is applied
+			m_stats.m_throttledAppends++;
+			m_durable.wait(lock, [&]() { return !m_open || m_closing || m_failed || m_pending.size() < JOURNAL_MAX_PENDING; });
+		}
+		if (!m_open || m_closing || m_failed)
+			return 0;
+
+		unsigned long long sequence = ++m_lastSequence;
+		if (m_pending.empty())
+			m_firstPendingTime = std::chrono::steady_clock::now();
+
+		size_t recordPos = m_pending.size();
+		m_pending.resize(recordPos + JOURNAL_HEADER_SIZE + portNameLength + length);
+		unsigned char* record = &m_pending[recordPos];
+		putLittleEndian(record, length, 4);
+		putLittleEndian(record + 8, sequence, 8);
+		putLittleEndian(record + 16, timestamp, 8);
+		record[24] = (unsigned char)portNameLength;
+		memcpy(record + JOURNAL_HEADER_SIZE, portName.data(), portNameLength);
+		frame.copyTo(record + JOURNAL_HEADER_SIZE + portNameLength, 0, length);
+
+		Checksum crc(CK_CRC32);
+		crc.update(record + JOURNAL_CRC_OFFSET, JOURNAL_HEADER_SIZE - JOURNAL_CRC_OFFSET + portNameLength + length);
+		putLittleEndian(record + 4, crc.value(), 4);
+
+		m_stats.m_appendedRecords++;
+		if (recordPos == 0 || m_journalParams->m_commitIntervalMillis == 0)
+			m_commitRequested.notify_one(); //the first record starts the commit window of the group
+		return sequence;
+	}
+
+	bool RS232_Journal::waitDurable(unsigned long long sequence)
+	{
+		std::unique_lock<std::mutex> lock(m_guard);
+		m_durable.wait(lock, [&]() { return m_durableSequence >= sequence || m_failed || !m_open; });
+		return m_durableSequence >= sequence;
+	}
+
+	RS232_JournalStats RS232_Journal::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		return m_stats;
+	}
+
+	std::string RS232_Journal::getSegmentPath(unsigned int segmentIndex) const
+	{
+		std::ostringstream o_str;
+		o_str << m_journalParams->m_directory << "/" << JOURNAL_FILE_PREFIX << std::setw(8) << std::setfill('0') << segmentIndex << JOURNAL_FILE_EXTENSION;
+		return o_str.str();
+	}
+
+	unsigned long long RS232_Journal::readSegment(const std::string& segmentPath, std::vector<RS232_JournalRecord>* records, unsigned long long* corruptedRecords)
+	{
+		std::ifstream segment(segmentPath, std::ios::binary);
+		if (!segment.is_open())
+			return 0;
+
+		segment.seekg(0, std::ios::end);
+		unsigned long long fileSize = (unsigned long long)segment.tellg();
+		segment.seekg(0, std::ios::beg);
+
+		unsigned long long validLength = 0;
+		unsigned long long position = 0;
+		unsigned long long skippedRecords = 0; //failing the CRC check since the last valid record
+		std::vector<unsigned char> record;
+		while (position + JOURNAL_HEADER_SIZE <= fileSize)
+		{
+			record.resize(JOURNAL_HEADER_SIZE);
+			if (!segment.read((char*)record.data(), JOURNAL_HEADER_SIZE))
+				break;
+
+			unsigned long long length = getLittleEndian(record.data(), 4);
+			unsigned int portNameLength = record[24];
+			if (position + JOURNAL_HEADER_SIZE + portNameLength + length > fileSize)
+				break; //torn record, its tail never reached the disk
+
+			record.resize(JOURNAL_HEADER_SIZE + portNameLength + (size_t)length);
+			if (!segment.read((char*)record.data() + JOURNAL_HEADER_SIZE, portNameLength + length))
+				break;
+
+			position += record.size();
+
+			Checksum crc(CK_CRC32);
+			crc.update(record.data() + JOURNAL_CRC_OFFSET, record.size() - JOURNAL_CRC_OFFSET);
+			if (crc.value() != (uint32_t)getLittleEndian(record.data() + 4, 4))
+			{
+				skippedRecords++;
+				continue; //the length field still frames the record, the following ones are checked on their own
+			}
+
+			//only the records followed by a valid one are corrupted, the ones at the end belong to the torn tail
+			if (corruptedRecords != nullptr)
+				*corruptedRecords += skippedRecords;
+			skippedRecords = 0;
+
+			if (records != nullptr)
+			{
+				RS232_JournalRecord journalRecord;
+				journalRecord.m_sequence = getLittleEndian(record.data() + 8, 8);
+				journalRecord.m_timestampMicros = getLittleEndian(record.data() + 16, 8);
+				journalRecord.m_portName.assign((const char*)record.data() + JOURNAL_HEADER_SIZE, portNameLength);
+				journalRecord.m_data.assign((const char*)record.data() + JOURNAL_HEADER_SIZE + portNameLength, (size_t)length);
+				records->push_back(std::move(journalRecord));
+			}
+			validLength = position;
+		}
+		return validLength;
+	}
+
+	bool RS232_Journal::recover()
+	{
+		if (!CreateDirectoryA(m_journalParams->m_directory.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+		{
+			std::cout << "RS232_Journal::recover() -> cannot create journal directory " << m_journalParams->m_directory << std::endl;
+			return false;
+		}
+
+		//segments are numbered consecutively starting from 1
+		unsigned int lastSegment = 0;
+		while (std::ifstream(getSegmentPath(lastSegment + 1), std::ios::binary).is_open())
+			lastSegment++;
+
+		m_lastSequence = 0;
+		unsigned long long lastValidLength = 0;
+		for (unsigned int segmentIndex = 1; segmentIndex <= lastSegment; segmentIndex++)
+		{
+			std::string segmentPath = getSegmentPath(segmentIndex);
+			std::vector<RS232_JournalRecord> records;
+			unsigned long long corruptedRecords = 0;
+			unsigned long long validLength = readSegment(segmentPath, &records, &corruptedRecords);
+			if (corruptedRecords > 0)
+			{
+				std::cout << "RS232_Journal::recover() -> skipped " << corruptedRecords << " records failing the CRC check in " << segmentPath << std::endl;
+				m_stats.m_corruptedRecords += corruptedRecords;
+			}
+
+			std::ifstream segment(segmentPath, std::ios::binary | std::ios::ate);
+			unsigned long long fileSize = (unsigned long long)segment.tellg();
+			if (validLength < fileSize)
+			{
+				if (segmentIndex == lastSegment)
+				{
+					std::cout << "RS232_Journal::recover() -> truncating " << (fileSize - validLength) << " bytes of torn tail in " << segmentPath << std::endl;
+					m_stats.m_truncatedBytes += fileSize - validLength;
+				}
+				else
+				{
+					std::cout << "RS232_Journal::recover() -> " << (fileSize - validLength) << " unreadable bytes after offset " << validLength << " in " << segmentPath << std::endl;
+				}
+			}
+
+			m_stats.m_recoveredRecords += records.size();
+			if (!records.empty())
+				m_lastSequence = std::max(m_lastSequence, records.back().m_sequence);
+			lastValidLength = validLength;
+		}
+		m_durableSequence = m_lastSequence;
+
+		return openSegment(lastSegment == 0 ? 1 : lastSegment, lastValidLength);
+	}
+
+	bool RS232_Journal::openSegment(unsigned int segmentIndex, unsigned long long validLength)
+	{
+		std::string segmentPath = getSegmentPath(segmentIndex);
+		m_segmentHandle = CreateFileA(segmentPath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (m_segmentHandle == INVALID_HANDLE_VALUE)
+		{
+			std::cout << "RS232_Journal::openSegment() -> cannot open segment " << segmentPath << " error: " << GetLastError() << std::endl;
+			return false;
+		}
+
+		//drops the torn tail (if any) & continues right after the last valid record
+		LARGE_INTEGER position;
+		position.QuadPart = (LONGLONG)validLength;
+		if (!SetFilePointerEx(m_segmentHandle, position, NULL, FILE_BEGIN) || !SetEndOfFile(m_segmentHandle) || !FlushFileBuffers(m_segmentHandle))
+		{
+			std::cout << "RS232_Journal::openSegment() -> cannot truncate segment " << segmentPath << " error: " << GetLastError() << std::endl;
+			closeSegment();
+			return false;
+		}
+
+		m_segmentIndex = segmentIndex;
+		m_segmentSize = validLength;
+		return true;
+	}
+
+	void RS232_Journal::closeSegment()
+	{
+		if (m_segmentHandle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_segmentHandle);
+			m_segmentHandle = INVALID_HANDLE_VALUE;
+		}
+	}
+
+	void RS232_Journal::commitLoop()
+	{
+		std::vector<unsigned char> batch;
+		std::chrono::milliseconds commitInterval(m_journalParams->m_commitIntervalMillis);
+
+		std::unique_lock<std::mutex> lock(m_guard);
+		while (true)
+		{
+			m_commitRequested.wait(lock, [&]() { return m_closing || !m_pending.empty(); });
+			if (m_pending.empty())
+				break; //closing & everything is on disk
+
+			//group commit: the records appended within the commit interval share a single flush
+			m_commitRequested.wait_until(lock, m_firstPendingTime + commitInterval, [&]() { return m_closing || m_pending.size() >= JOURNAL_MAX_PENDING; });
+
+			batch.swap(m_pending);
+			unsigned long long batchSequence = m_lastSequence;
+			unsigned long long batchRecords = m_stats.m_appendedRecords - m_stats.m_durableRecords;
+			m_durable.notify_all(); //the throttled appenders can go on with the empty buffer
+
+			lock.unlock();
+			bool written = writeBatch(batch);
+			lock.lock();
+
+			if (!written)
+			{
+				m_failed = true;
+				m_pending.clear();
+				m_durable.notify_all();
+				break;
+			}
+
+			m_durableSequence = batchSequence;
+			m_stats.m_durableRecords += batchRecords;
+			m_stats.m_commits++;
+			m_stats.m_writtenBytes += batch.size();
+			batch.clear();
+			m_durable.notify_all();
+		}
+	}
+
+	bool RS232_Journal::writeBatch(const std::vector<unsigned char>& batch)
+	{
+		if (m_segmentSize > 0 && m_segmentSize >= m_journalParams->m_segmentSize)
+		{
+			closeSegment();
+			if (!openSegment(m_segmentIndex + 1, 0))
+				return false;
+		}
+
+		size_t written = 0;
+		while (written < batch.size())
+		{
+			DWORD bytesWritten = 0;
+			if (!WriteFile(m_segmentHandle, batch.data() + written, (DWORD)(batch.size() - written), &bytesWritten, NULL))
+			{
+				std::cout << "RS232_Journal::writeBatch() -> write failed, error: " << GetLastError() << std::endl;
+				return false;
+			}
+			written += bytesWritten;
+		}
+
+		if (!FlushFileBuffers(m_segmentHandle))
+		{
+			std::cout << "RS232_Journal::writeBatch() -> flush failed, error: " << GetLastError() << std::endl;
+			return false;
+		}
+		m_segmentSize += batch.size();
+		return true;
+	}
+}
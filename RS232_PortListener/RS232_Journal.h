@@ -0,0 +1,123 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: append-only on-disk journal of the received frames with group commit & crash recovery
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RS232_Util.h"
+
+namespace RS232
+{
+	/*journal counters*/
+	struct RS232_JournalStats
+	{
+		unsigned long long m_appendedRecords = 0;
+		unsigned long long m_durableRecords = 0; //flushed to disk
+		unsigned long long m_commits = 0; //FlushFileBuffers calls, each covering a group of records
+		unsigned long long m_writtenBytes = 0;
+		unsigned long long m_recoveredRecords = 0; //valid records found in the existing segments at open()
+		unsigned long long m_truncatedBytes = 0; //torn tail removed from the last segment at open()
+		unsigned long long m_corruptedRecords = 0; //records of any segment failing the CRC check at open(), skipped
+		unsigned long long m_throttledAppends = 0; //append() calls that waited for the commit thread to drain the pending records
+	};
+
+	/*a record read back from a journal segment*/
+	struct RS232_JournalRecord
+	{
+		unsigned long long m_sequence;
+		unsigned long long m_timestampMicros; //since the epoch of the system clock
+		std::string m_portName;
+		std::string m_data;
+	};
+
+	class RS232_Journal;
+	using RS232_Journal_Ptr = std::unique_ptr<RS232_Journal>;
+
+	/*
+	* segment file layout: records back to back, each one is
+	* length(4) crc32(4) sequence(8) timestamp(8) portNameLength(1) portName payload
+	* the CRC-32 covers everything after the crc field, the integers are little endian
+	*/
+	class RS232_Journal final
+	{
+	public:
+		static RS232_Journal_Ptr& getInstance();
+
+		virtual ~RS232_Journal();
+
+		//recovers the existing segments (truncating a torn tail) & starts the commit thread
+		bool open(RS232_JournalParams_Ptr journalParams);
+
+		//flushes the pending records & stops the commit thread
+		void close();
+
+		bool isOpen() const;
+
+		//queues the frame for the next group commit, returns its sequence number (0 if the journal is not open)
+		//the frames are not dropped by the overflow policy of the port: once 16 MiB wait for the disk the calling reader thread
+		//is held until the commit thread catches up, so a stalled disk shows up as RX overruns instead of silently lost frames
+		unsigned long long append(const std::string& portName, const RS232_SegmentedBuffer& frame);
+
+		//blocks until the record with the given sequence number is on disk, false if the journal failed or was closed before
+		bool waitDurable(unsigned long long sequence);
+
+		RS232_JournalStats getStats() const;
+
+		//reads the records of a segment file checking the CRC of each one, a corrupted record followed by valid ones is skipped
+		//(counted in corruptedRecords) & the reading goes on, it stops where a record runs past the end of the file
+		//returns the length of the file up to the end of the last valid record, the rest is the torn tail
+		static unsigned long long readSegment(const std::string& segmentPath, std::vector<RS232_JournalRecord>* records, unsigned long long* corruptedRecords = nullptr);
+
+	private:
+		RS232_Journal();
+
+		std::string getSegmentPath(unsigned int segmentIndex) const;
+
+		bool recover();
+		bool openSegment(unsigned int segmentIndex, unsigned long long validLength);
+		void closeSegment();
+
+		void commitLoop();
+		bool writeBatch(const std::vector<unsigned char>& batch);
+
+		/*to protect the Singleton class from being copied*/
+		RS232_Journal(const RS232_Journal&) = delete;
+		RS232_Journal& operator=(const RS232_Journal&) = delete;
+		RS232_Journal(RS232_Journal&&) = delete;
+		RS232_Journal& operator=(RS232_Journal&) = delete;
+		/*to protect the Singleton class from being copied*/
+
+		static RS232_Journal_Ptr m_instance;
+
+		RS232_JournalParams_Ptr m_journalParams;
+
+		mutable std::mutex m_guard;
+		std::condition_variable m_commitRequested; //wakes up the commit thread
+		std::condition_variable m_durable; //wakes up waitDurable() & the throttled appenders
+
+		std::vector<unsigned char> m_pending; //serialized records waiting for the next commit
+		std::chrono::steady_clock::time_point m_firstPendingTime;
+		unsigned long long m_lastSequence;
+		unsigned long long m_durableSequence;
+		bool m_open;
+		bool m_closing;
+		bool m_failed;
+
+		/*only touched by the commit thread once the journal is open*/
+		HANDLE m_segmentHandle;
+		unsigned int m_segmentIndex;
+		unsigned long long m_segmentSize;
+
+		std::thread m_commitThread;
+		RS232_JournalStats m_stats;
+	};
+}
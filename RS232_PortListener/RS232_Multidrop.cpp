@@ -0,0 +1,135 @@
+#include "RS232_Multidrop.h"
+
+#include <algorithm>
+
+namespace RS232
+{
+	RS232_LogicalDevice::RS232_LogicalDevice(RS232_PortParams_Ptr portParams, unsigned int address, Sender sender) :
+		m_portParams(portParams),
+		m_address(address),
+		m_sender(sender)
+	{
+		m_stats.m_address = address;
+	}
+
+	void RS232_LogicalDevice::setFrameSink(FrameSink frameSink)
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		m_frameSink = frameSink;
+	}
+
+	void RS232_LogicalDevice::sendMessage(const std::string& message, TxPriority priority)
+	{
+		std::string addressField(m_portParams->m_addressSize, '\0');
+		for (unsigned int i = 0; i < m_portParams->m_addressSize; i++)
+			addressField[i] = (char)(m_address >> (8 * (m_portParams->m_addressSize - 1 - i))); //big endian
+
+		std::string stampedMessage(message);
+		stampedMessage.insert(std::min<size_t>(m_portParams->m_addressOffset, stampedMessage.size()), addressField);
+		m_sender(stampedMessage, priority);
+
+		std::lock_guard<std::mutex> lock(m_guard);
+		m_stats.m_sentFrames++;
+		m_stats.m_sentBytes += stampedMessage.size();
+	}
+
+	RS232_LogicalDeviceStats RS232_LogicalDevice::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		return m_stats;
+	}
+
+	bool RS232_LogicalDevice::deliver(const RS232_Frame& frame)
+	{
+		FrameSink frameSink;
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			frameSink = m_frameSink;
+		}
+		if (!frameSink)
+			return false;
+
+		FrameTime start = FrameClock::now();
+		try
+		{
+			frameSink(frame);
+		}
+		catch (...)
+		{
+			std::cout << "RS232_LogicalDevice::deliver() -> Unknown exception occurred!!" << std::endl;
+		}
+		unsigned long long handlerMicros = std::chrono::duration_cast<std::chrono::microseconds>(FrameClock::now() - start).count();
+
+		std::lock_guard<std::mutex> lock(m_guard);
+		m_stats.m_receivedFrames++;
+		m_stats.m_receivedBytes += frame.m_data.size();
+		if (handlerMicros > m_stats.m_maxHandlerMicros)
+			m_stats.m_maxHandlerMicros = handlerMicros;
+		return true;
+	}
+
+	RS232_Multidrop::RS232_Multidrop(RS232_PortParams_Ptr portParams) :
+		m_portParams(portParams),
+		m_drops((size_t)1 << (8 * portParams->m_addressSize)),
+		m_dispatching(false),
+		m_unaddressedFrames(0)
+	{
+	}
+
+	RS232_LogicalDevice_Ptr RS232_Multidrop::attach(unsigned int address, RS232_LogicalDevice::Sender sender)
+	{
+		if (address >= m_drops.size())
+		{
+			std::cout << "RS232_Multidrop::attach() -> address " << address << " does not fit in the " << m_portParams->m_addressSize
+				<< " byte address field of " << m_portParams->m_comPort << std::endl;
+			return RS232_LogicalDevice_Ptr();
+		}
+
+		std::lock_guard<std::mutex> lock(m_guard);
+		if (m_dispatching)
+		{
+			std::cout << "RS232_Multidrop::attach() -> " << m_portParams->m_comPort << " is open, address " << address << " has to be attached before the port is opened!" << std::endl;
+			return RS232_LogicalDevice_Ptr();
+		}
+		if (!m_drops[address].get())
+			m_drops[address] = std::make_shared<RS232_LogicalDevice>(m_portParams, address, sender);
+		return m_drops[address];
+	}
+
+	void RS232_Multidrop::setDispatching(bool dispatching)
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		m_dispatching = dispatching;
+	}
+
+	bool RS232_Multidrop::dispatch(RS232_Frame& frame)
+	{
+		unsigned char addressField[MAX_ADDRESS_SIZE];
+		unsigned int addressSize = m_portParams->m_addressSize;
+		if (frame.m_data.copyTo(addressField, m_portParams->m_addressOffset, addressSize) < addressSize)
+		{
+			m_unaddressedFrames++;
+			return false;
+		}
+
+		unsigned int address = addressField[0];
+		if (addressSize == 2)
+			address = (address << 8) | addressField[1];
+		frame.m_info.m_address = (int)address;
+
+		RS232_LogicalDevice* drop = m_drops[address].get();
+		return drop != nullptr && drop->deliver(frame);
+	}
+
+	std::vector<RS232_LogicalDeviceStats> RS232_Multidrop::getStats() const
+	{
+		std::vector<RS232_LogicalDeviceStats> stats;
+		std::lock_guard<std::mutex> lock(m_guard);
+		for (const RS232_LogicalDevice_Ptr& drop : m_drops)
+		{
+			if (drop.get())
+				stats.push_back(drop->getStats());
+		}
+		return stats;
+	}
+}
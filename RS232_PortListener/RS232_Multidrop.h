@@ -0,0 +1,101 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: demultiplexes the frames of a multidrop (RS-485) line by the address field to a logical device per drop
+*/
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "RS232_FrameQueue.h"
+
+namespace RS232
+{
+	/*counters of a logical device*/
+	struct RS232_LogicalDeviceStats
+	{
+		unsigned int m_address = 0;
+		unsigned long long m_receivedFrames = 0;
+		unsigned long long m_receivedBytes = 0;
+		unsigned long long m_sentFrames = 0;
+		unsigned long long m_sentBytes = 0;
+		unsigned long long m_maxHandlerMicros = 0;
+	};
+
+	/*one drop of the line, its frames are received & sent with its address*/
+	class RS232_LogicalDevice final
+	{
+	public:
+		using FrameSink = std::function<void(const RS232_Frame& frame)>;
+		using Sender = std::function<void(const std::string& message, TxPriority priority)>;
+
+		RS232_LogicalDevice(RS232_PortParams_Ptr portParams, unsigned int address, Sender sender);
+
+		unsigned int getAddress() const { return m_address; }
+
+		//runs on the consumer thread of the port, the frames of the drop go to the frame router of the port while no sink is set
+		void setFrameSink(FrameSink frameSink);
+
+		//stamps the address of the drop at addressOffset of the message, then sends it through the transmit lanes of the port
+		void sendMessage(const std::string& message, TxPriority priority = TP_NORMAL);
+
+		RS232_LogicalDeviceStats getStats() const;
+
+		//false when no sink is set
+		bool deliver(const RS232_Frame& frame);
+
+	private:
+		RS232_LogicalDevice(const RS232_LogicalDevice&) = delete;
+		RS232_LogicalDevice& operator=(const RS232_LogicalDevice&) = delete;
+
+		RS232_PortParams_Ptr m_portParams;
+		unsigned int m_address;
+		Sender m_sender;
+
+		mutable std::mutex m_guard;
+		FrameSink m_frameSink;
+		RS232_LogicalDeviceStats m_stats;
+	};
+	using RS232_LogicalDevice_Ptr = std::shared_ptr<RS232_LogicalDevice>;
+
+	/*
+	* the drops are kept in a table indexed by the address itself (256 entries for 1 byte, 65536 for 2 bytes),
+	* so a frame costs the same single lookup whatever the number of drops on the line
+	*/
+	class RS232_Multidrop final
+	{
+	public:
+		RS232_Multidrop(RS232_PortParams_Ptr portParams);
+
+		//refused while the port is open, an attached address returns its logical device again
+		RS232_LogicalDevice_Ptr attach(unsigned int address, RS232_LogicalDevice::Sender sender);
+
+		//set by the device around its consumer thread: dispatch() reads the table without a lock, so it is frozen meanwhile
+		void setDispatching(bool dispatching);
+
+		//sets the address of the frame, false when it has to take the route of the port (no address field, no drop or no sink)
+		bool dispatch(RS232_Frame& frame);
+
+		//the attached drops, in address order
+		std::vector<RS232_LogicalDeviceStats> getStats() const;
+
+		//frames too short to carry the address field
+		unsigned long long getUnaddressedFrames() const { return m_unaddressedFrames; }
+
+	private:
+		RS232_Multidrop(const RS232_Multidrop&) = delete;
+		RS232_Multidrop& operator=(const RS232_Multidrop&) = delete;
+
+		RS232_PortParams_Ptr m_portParams;
+		mutable std::mutex m_guard; //guards the table against attach() from several threads while it is not dispatching
+		std::vector<RS232_LogicalDevice_Ptr> m_drops; //indexed by the address
+		bool m_dispatching;
+		std::atomic<unsigned long long> m_unaddressedFrames;
+	};
+	using RS232_Multidrop_Ptr = std::unique_ptr<RS232_Multidrop>;
+}
@@ -0,0 +1,239 @@
+#include "RS232_Poller.h"
+
+#include <algorithm>
+
+namespace RS232
+{
+	constexpr unsigned int POLL_MAX_BACKOFF_SHIFT = 16;
+
+	static unsigned long long microsBetween(FrameTime from, FrameTime to)
+	{
+		return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+	}
+
+	RS232_Poller::RS232_Poller(RS232_Device_Ptr device, RS232_PollerParams_Ptr pollerParams, ReplyHandler replyHandler) :
+		m_device(device),
+		m_pollerParams(pollerParams),
+		m_replyHandler(replyHandler),
+		m_running(false),
+		m_waitingSlave(-1),
+		m_replied(false),
+		m_busyMicros(0),
+		m_lateReplies(0)
+	{
+		for (const RS232_PollParams& pollParams : m_pollerParams->m_polls)
+		{
+			PolledRequest request;
+			request.m_params = pollParams;
+			request.m_drop = m_device->attachLogicalDevice(pollParams.m_slave);
+			request.m_stats.m_slave = pollParams.m_slave;
+			if (request.m_drop.get())
+				m_requests.push_back(request);
+			else
+				std::cout << "RS232_Poller::RS232_Poller() -> slave " << pollParams.m_slave << " cannot be polled, ignored!" << std::endl;
+		}
+	}
+
+	RS232_Poller::~RS232_Poller()
+	{
+		stop();
+	}
+
+	void RS232_Poller::start()
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		if (m_running || m_requests.empty())
+			return;
+
+		for (PolledRequest& request : m_requests)
+		{
+			unsigned int slave = request.m_params.m_slave;
+			request.m_drop->setFrameSink([this, slave](const RS232_Frame& reply)
+			{
+				onReply(slave, reply);
+			});
+		}
+
+		m_running = true;
+		m_pollThread = std::thread(&RS232_Poller::pollLoop, this);
+	}
+
+	void RS232_Poller::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			if (!m_running)
+				return;
+			m_running = false;
+			m_wakeUp.notify_all();
+		}
+
+		if (m_pollThread.joinable())
+			m_pollThread.join();
+
+		//the replies take the route of the port again
+		for (PolledRequest& request : m_requests)
+			request.m_drop->setFrameSink(nullptr);
+	}
+
+	RS232_PollerStats RS232_Poller::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		RS232_PollerStats stats;
+		for (const PolledRequest& request : m_requests)
+		{
+			RS232_SlavePollStats slaveStats = request.m_stats;
+			if (slaveStats.m_replies > 0)
+				slaveStats.m_averageReplyMicros = (double)request.m_totalReplyMicros / slaveStats.m_replies;
+			stats.m_polls += slaveStats.m_polls;
+			stats.m_replies += slaveStats.m_replies;
+			stats.m_timeouts += slaveStats.m_timeouts;
+			stats.m_missedDeadlines += slaveStats.m_missedDeadlines;
+			stats.m_slaves.push_back(slaveStats);
+		}
+		stats.m_lateReplies = m_lateReplies;
+
+		unsigned long long elapsedMicros = microsBetween(m_startTime, m_running ? FrameClock::now() : m_stopTime);
+		if (stats.m_polls > 0 && elapsedMicros > 0)
+		{
+			stats.m_pollRate = stats.m_polls * 1000000.0 / elapsedMicros;
+			stats.m_busUtilization = (double)m_busyMicros / elapsedMicros;
+		}
+		return stats;
+	}
+
+	void RS232_Poller::pollLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_guard);
+		m_startTime = FrameClock::now();
+		m_busyMicros = 0;
+		for (PolledRequest& request : m_requests)
+		{
+			request.m_release = m_startTime;
+			request.m_deadline = m_startTime + std::chrono::milliseconds(request.m_params.m_periodMillis);
+		}
+
+		while (m_running)
+		{
+			int index = nextRequest(FrameClock::now());
+			if (index >= 0)
+			{
+				poll(m_requests[index], lock);
+				continue;
+			}
+
+			FrameTime nextRelease = m_requests.front().m_release;
+			for (const PolledRequest& request : m_requests)
+				nextRelease = std::min(nextRelease, request.m_release);
+			m_wakeUp.wait_until(lock, nextRelease, [&]() { return !m_running; });
+		}
+		m_stopTime = FrameClock::now();
+	}
+
+	int RS232_Poller::nextRequest(FrameTime now)
+	{
+		int next = -1;
+		for (size_t i = 0; i < m_requests.size(); i++)
+		{
+			PolledRequest& request = m_requests[i];
+			if (request.m_deadline <= now)
+			{
+				std::chrono::milliseconds period(request.m_params.m_periodMillis);
+				long long skipped = (now - request.m_release) / period;
+				request.m_release += period * skipped;
+				request.m_deadline = request.m_release + period;
+				if (!request.m_stats.m_backedOff)
+					request.m_stats.m_missedDeadlines += skipped;
+			}
+
+			if (request.m_release <= now && (next < 0 || request.m_deadline < m_requests[next].m_deadline))
+				next = (int)i;
+		}
+		return next;
+	}
+
+	void RS232_Poller::poll(PolledRequest& request, std::unique_lock<std::mutex>& lock)
+	{
+		m_waitingSlave = (int)request.m_params.m_slave;
+		m_replied = false;
+		lock.unlock();
+
+		FrameTime sendTime = FrameClock::now();
+		request.m_drop->sendMessage(request.m_params.m_request); //blocks until it is written
+
+		lock.lock();
+		FrameTime timeout = FrameClock::now() + std::chrono::milliseconds(request.m_params.m_timeoutMillis);
+		m_wakeUp.wait_until(lock, timeout, [&]() { return m_replied || !m_running; });
+		FrameTime replyTime = FrameClock::now();
+		m_waitingSlave = -1;
+		if (!m_replied && !m_running)
+			return; //stopped while waiting, not a timeout of the slave
+
+		unsigned long long busyMicros = microsBetween(sendTime, replyTime);
+		m_busyMicros += busyMicros;
+		std::chrono::milliseconds period(request.m_params.m_periodMillis);
+		RS232_SlavePollStats& stats = request.m_stats;
+		stats.m_polls++;
+
+		if (m_replied)
+		{
+			stats.m_replies++;
+			request.m_totalReplyMicros += busyMicros;
+			stats.m_maxReplyMicros = std::max(stats.m_maxReplyMicros, busyMicros);
+			if (replyTime > request.m_deadline && !stats.m_backedOff)
+				stats.m_missedDeadlines++;
+			request.m_consecutiveTimeouts = 0;
+			stats.m_backedOff = false;
+			request.m_release += period;
+			request.m_deadline = request.m_release + period;
+		}
+		else
+		{
+			stats.m_timeouts++;
+			request.m_consecutiveTimeouts++;
+			if (request.m_consecutiveTimeouts < m_pollerParams->m_deadTimeouts)
+			{
+				if (!stats.m_backedOff)
+					stats.m_missedDeadlines++;
+				request.m_release += period;
+				request.m_deadline = request.m_release + period;
+			}
+			else
+			{	//dead slave: the line is left to the others, retried at a doubling interval
+				if (!stats.m_backedOff)
+					std::cout << "RS232_Poller::poll() -> slave " << request.m_params.m_slave << " does not reply, backing off!" << std::endl;
+				stats.m_backedOff = true;
+				unsigned int shift = std::min(request.m_consecutiveTimeouts - m_pollerParams->m_deadTimeouts + 1, POLL_MAX_BACKOFF_SHIFT);
+				unsigned long long backoffMillis = std::min((unsigned long long)request.m_params.m_periodMillis << shift, (unsigned long long)m_pollerParams->m_maxBackoffMillis);
+				backoffMillis = std::max(backoffMillis, (unsigned long long)request.m_params.m_periodMillis);
+				request.m_release = replyTime + std::chrono::milliseconds(backoffMillis);
+				request.m_deadline = request.m_release + period;
+			}
+		}
+
+		if (m_pollerParams->m_turnaroundMicros > 0)
+		{	//the slave releases the line after its reply; after a timeout it may still be driving it with a late reply
+			FrameTime lineFree = replyTime + std::chrono::microseconds(m_pollerParams->m_turnaroundMicros);
+			m_wakeUp.wait_until(lock, lineFree, [&]() { return !m_running; });
+		}
+	}
+
+	void RS232_Poller::onReply(unsigned int slave, const RS232_Frame& reply)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			if (m_waitingSlave == (int)slave && !m_replied)
+			{
+				m_replied = true;
+				m_wakeUp.notify_all();
+			}
+			else
+			{
+				m_lateReplies++;
+			}
+		}
+
+		if (m_replyHandler)
+			m_replyHandler(slave, reply);
+	}
+}
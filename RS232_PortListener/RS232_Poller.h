@@ -0,0 +1,108 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: polling master of a multidrop line, the configured requests are sent to the slaves earliest deadline first
+*/
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RS232_Device.h"
+
+namespace RS232
+{
+	/*counters of a polled request*/
+	struct RS232_SlavePollStats
+	{
+		unsigned int m_slave = 0;
+		unsigned long long m_polls = 0;
+		unsigned long long m_replies = 0;
+		unsigned long long m_timeouts = 0;
+		unsigned long long m_missedDeadlines = 0; //periods without a reply in time (skipped, timed out or replied late)
+		double m_averageReplyMicros = 0.0; //from the start of the request until the reply
+		unsigned long long m_maxReplyMicros = 0;
+		bool m_backedOff = false; //dead slave, polled at the backoff interval instead of its period
+	};
+
+	struct RS232_PollerStats
+	{
+		unsigned long long m_polls = 0;
+		unsigned long long m_replies = 0;
+		unsigned long long m_timeouts = 0;
+		unsigned long long m_lateReplies = 0; //arrived after the timeout, passed to the reply handler only
+		unsigned long long m_missedDeadlines = 0;
+		double m_pollRate = 0.0; //polls per second since start()
+		double m_busUtilization = 0.0; //share of the time with a request on the line or a reply awaited
+		std::vector<RS232_SlavePollStats> m_slaves; //in the order of the configuration
+	};
+
+	/*
+	* one request is outstanding at a time (half duplex line), the next one is sent as soon as the reply arrives or times out
+	* & the turnaround time passes; among the requests whose period has started the one with the earliest deadline (end of its period) goes first,
+	* a period which could not be started before its deadline is counted as missed & skipped so the backlog does not pile up;
+	* a slave timing out deadAfter times in a row is polled at a doubling interval up to maxBackoff until it replies again
+	*/
+	class RS232_Poller final
+	{
+	public:
+		//reply of a slave, runs on the consumer thread of the port
+		using ReplyHandler = std::function<void(unsigned int slave, const RS232_Frame& reply)>;
+
+		//attaches the logical devices of the slaves, to be created before the device is opened
+		RS232_Poller(RS232_Device_Ptr device, RS232_PollerParams_Ptr pollerParams, ReplyHandler replyHandler);
+
+		virtual ~RS232_Poller();
+
+		void start();
+		void stop();
+
+		RS232_PollerStats getStats() const;
+
+	private:
+		struct PolledRequest
+		{
+			RS232_PollParams m_params;
+			RS232_LogicalDevice_Ptr m_drop;
+			FrameTime m_release; //start of the current period
+			FrameTime m_deadline; //end of the current period
+			unsigned int m_consecutiveTimeouts = 0;
+			unsigned long long m_totalReplyMicros = 0;
+			RS232_SlavePollStats m_stats;
+		};
+
+		void pollLoop();
+
+		//skips the periods past their deadline, then picks the started request with the earliest deadline, -1 if none has started
+		int nextRequest(FrameTime now);
+
+		void poll(PolledRequest& request, std::unique_lock<std::mutex>& lock);
+
+		void onReply(unsigned int slave, const RS232_Frame& reply);
+
+		RS232_Poller(const RS232_Poller&) = delete;
+		RS232_Poller& operator=(const RS232_Poller&) = delete;
+
+		RS232_Device_Ptr m_device;
+		RS232_PollerParams_Ptr m_pollerParams;
+		ReplyHandler m_replyHandler;
+
+		mutable std::mutex m_guard;
+		std::condition_variable m_wakeUp; //reply, stop or the next period
+		std::vector<PolledRequest> m_requests;
+		bool m_running;
+		int m_waitingSlave; //address of the outstanding request, -1 when the line is idle
+		bool m_replied;
+		FrameTime m_startTime;
+		FrameTime m_stopTime;
+		unsigned long long m_busyMicros;
+		unsigned long long m_lateReplies;
+		std::thread m_pollThread;
+	};
+	using RS232_Poller_Ptr = std::unique_ptr<RS232_Poller>;
+}
@@ -1,373 +1,989 @@
-#include "RS232_PortHandler.h"
-
-#include <chrono>
-#include <SetupAPI.h>
-#pragma comment(lib, "Setupapi.lib")
-
-namespace RS232
-{
-	RS232_PortHandler::RS232_PortHandler(RS232_PortSubscriber_Ptr subscriber, RS232_PortParams_Ptr portParams) :
-		m_subscriber(subscriber),
-		m_portParams(portParams),
-		m_bOpenSuccess(false),
-		m_ReadTerminated(false),
-		m_PortHandlerClosed(false)
-	{
-		openPortHandler();
-	}
-
-	RS232_PortHandler::~RS232_PortHandler()
-	{
-		free(m_ReadData);
-	}
-
-	void RS232_PortHandler::openPortHandler()
-	{
-		std::string comPort;
-		if (m_portParams->m_comPort.length() == 4) /*COM1-9*/
-		{
-			comPort = m_portParams->m_comPort;
-		}
-		else /*COM10-99*/
-		{
-			comPort = COM_PORT_PREPEND + m_portParams->m_comPort;
-		}
-
-		m_HSerialPort = CreateFile(
-			comPort.c_str(),
-			GENERIC_READ | GENERIC_WRITE,
-			0,
-			NULL,
-			OPEN_EXISTING,
-			FILE_ATTRIBUTE_NORMAL |
-			FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING,
-			NULL);
-
-		DWORD errorNumber = GetLastError();
-
-		m_bOpenSuccess = true;
-
-		if (m_HSerialPort == INVALID_HANDLE_VALUE || errorNumber == ERROR_ACCESS_DENIED || errorNumber == ERROR_FILE_NOT_FOUND)
-		{	//ERROR_ACCESS_DENIED => COM port is used by another application!
-			//ERROR_FILE_NOT_FOUND => COM port does not exist in the system!
-			std::cout << "RS232_PortHandler::openPortHandler() -> Unable to open Serial Port" << m_portParams->m_comPort << std::endl;
-			m_bOpenSuccess = false;
-		}
-	}
-
-	void RS232_PortHandler::init()
-	{
-		m_BufferSize = m_portParams->m_rxBufferSize;
-		m_ReadData = (char*)malloc(m_BufferSize * sizeof(char));
-		memset(m_ReadData, 0, sizeof(m_ReadData));
-		m_LPReadData = m_ReadData;
-
-		DWORD threadID;
-
-		DCB dcb; //Device Control Block
-		memset(&dcb, 0, sizeof(DCB));
-		dcb.DCBlength = sizeof(DCB);
-		dcb.BaudRate = (int)m_portParams->m_baudRate;
-		dcb.fBinary = TRUE;
-		dcb.fDtrControl = DTR_CONTROL_ENABLE;
-		dcb.fRtsControl = RTS_CONTROL_ENABLE;
-		dcb.ByteSize = ConvertCharSize(m_portParams->m_charSize);
-		dcb.Parity = ConvertParity(m_portParams->m_parity);
-		dcb.StopBits = ConvertStopBits(m_portParams->m_stopBits);
-		dcb.fOutX = ConvertFlowControl(m_portParams->m_flowControl);
-		dcb.fInX = ConvertFlowControl(m_portParams->m_flowControl);
-		dcb.XonChar = ASCII_DC1;
-		dcb.XoffChar = ASCII_DC3;
-
-		//Hardcoded Configuration Below
-		SetCommState(m_HSerialPort, &dcb);
-
-		//SetCommMask will trigger WaitCommEvent
-		SetCommMask(m_HSerialPort, EV_RXCHAR | EV_CTS | EV_DSR | EV_RLSD | EV_ERR | EV_RING);
-
-		//Start Thread for Serial Port Handling
-		m_HReadDone = CreateEvent(NULL, FALSE, FALSE, NULL);
-
-		//Start Thread for Serial Port Handling
-		m_HReadDone = CreateEvent(NULL, FALSE, FALSE, NULL);
-		m_HReadThread = CreateThread(NULL, 0, RS232_PortHandler::startReadThread, this, 0, &threadID);
-	}
-
-	void RS232_PortHandler::close()
-	{
-		//Close the Serial Port
-		if (m_bOpenSuccess) //close the serial port handles iff serial port is opened successfully!
-		{
-			CloseHandle(m_HSerialPort);
-			CloseHandle(m_HReadDone);
-			CloseHandle(m_HReadThread);
-		}
-		m_ReadTerminated = true;
-		m_bOpenSuccess = false;
-		m_PortHandlerClosed = true;
-	}
-
-	void RS232_PortHandler::write(const unsigned char* data, unsigned int length)
-	{
-		std::lock_guard<std::mutex> lock(m_writeGuard);
-
-		if (!m_bOpenSuccess)
-		{
-			std::cout << "RS232_PortHandler::write() -> serial port NOT active!" << std::endl;
-			return;
-		}
-
-		DWORD numOFWrittenBytes;
-		OVERLAPPED ovlWrite;
-		ovlWrite.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-		// Reset event before writing to COM port
-		ResetEvent(ovlWrite.hEvent);
-		ovlWrite.OffsetHigh = ovlWrite.Offset = 0;
-		if (!WriteFile(m_HSerialPort, data, length, &numOFWrittenBytes, &ovlWrite))
-		{
-			DWORD errorNumber = GetLastError();
-			if (errorNumber == ERROR_IO_PENDING)
-			{	// Wait for data to be written
-				GetOverlappedResult(m_HSerialPort, &ovlWrite, &numOFWrittenBytes, TRUE);
-				if (length != numOFWrittenBytes)
-				{
-					std::cout << "RS232_PortHandler::write() -> Data could NOT be written to the port!" << std::endl;
-				}
-			}
-			else
-			{
-				std::cout << "RS232_PortHandler::write() -> Data could NOT be written to the port!" << std::endl;
-			}
-		}
-		CloseHandle(ovlWrite.hEvent);
-	}
-
-	DWORD WINAPI RS232_PortHandler::startReadThread(LPVOID lpV)
-	{
-		return static_cast<RS232_PortHandler*>(lpV)->read();
-	}
-
-	DWORD RS232_PortHandler::read()
-	{
-		std::lock_guard<std::mutex> lock(m_readGuard);
-
-		DWORD dwBytesRead = 0;
-		DWORD dwEvent;
-		OVERLAPPED ovlRead;
-		COMSTAT comStat;
-		DWORD dwErrors;
-
-		// Get an initial comm status
-		if (updatePinStatus())
-		{	// We can NOT get comm status, so exit this thread
-			std::cout << "RS232_PortHandler::read() -> Cannot get comm status! Exiting reader thread!" << std::endl;
-			m_subscriber->on_socket_error(PE_CannotOpenPort);
-			SetEvent(m_HReadDone);
-			return 0;
-		}
-
-		// Create the event for overlapped reads
-		ovlRead.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-
-		m_ReadTerminated = false; //set false when starting to read!
-		while (!m_ReadTerminated)
-		{
-			// Reset event before waiting for comm event
-			ResetEvent(ovlRead.hEvent);
-			ovlRead.OffsetHigh = ovlRead.Offset = 0;
-
-			// Wait for comm event
-			DWORD errorNumber;
-			if (!WaitCommEvent(m_HSerialPort, &dwEvent, &ovlRead))
-			{
-				// Is data pending?
-				if ((errorNumber = GetLastError()) == ERROR_IO_PENDING)
-				{
-					// Wait for data to be received
-					GetOverlappedResult(m_HSerialPort, &ovlRead, &dwBytesRead, TRUE);
-				}
-				else if ((errorNumber = GetLastError()) == ERROR_ACCESS_DENIED)
-				{
-					std::cout << "RS232_PortHandler::read() -> Serial Cable is unplugged" << std::endl;
-					m_subscriber->on_socket_error(PE_PortIsNotOpen);
-					break;
-				}
-			}
-
-			// Is data available?
-			if (!m_ReadTerminated && ((dwEvent & EV_RXCHAR) || (dwEvent == 0)))
-			{
-				std::cout << "RS232_PortHandler::read() ->  Data is available" << std::endl;
-				// Reset event before reading COM data
-				ResetEvent(ovlRead.hEvent);
-				ovlRead.OffsetHigh = ovlRead.Offset = 0;
-
-				if (m_LPReadData)
-				{
-					ClearCommError(m_HSerialPort, &dwErrors, &comStat);
-					// Read data from COM port
-					if (!ReadFile(m_HSerialPort, m_LPReadData, comStat.cbInQue, &dwBytesRead, &ovlRead))
-					{
-						// Is more data pending?
-						if ((errorNumber = GetLastError()) == ERROR_IO_PENDING)
-						{
-							// Wait for read to complete
-							if (!GetOverlappedResult(m_HSerialPort, &ovlRead, &dwBytesRead, TRUE))
-							{
-								std::cout << "RS232_PortHandler::read() ->  overlapped read FAILED!" << std::endl;
-							}
-						}
-					}
-
-					// Did we receive data?
-					if (dwBytesRead)
-					{
-						m_subscriber->on_read((unsigned char *)m_LPReadData, dwBytesRead);
-						// Zero buffer for next data read
-						memset(m_ReadData, 0, sizeof(m_ReadData));
-					}
-				}
-			}
-
-			// Did we also receive a CTS or DSR or RLSD or RING line event?
-			if (!m_ReadTerminated && ((dwEvent & EV_CTS) || (dwEvent & EV_DSR) || (dwEvent & EV_RLSD) || (dwEvent & EV_RING)))
-			{
-				//std::cout << "RS232_PortHandler::read() ->  Serial Signal change information is available" << std::endl;
-				updatePinStatus();
-			}
-
-			if (!m_ReadTerminated && (dwEvent & EV_ERR))
-			{
-				std::cout << "RS232_PortHandler::read() ->  Error happened in the serial port! Exiting..." << std::endl;
-				m_subscriber->on_socket_error(PE_ReadError);
-				break;
-			}
-		}
-
-		CloseHandle(ovlRead.hEvent);
-		SetEvent(m_HReadDone);
-		return 0;
-	}
-
-	DWORD RS232_PortHandler::updatePinStatus()
-	{
-		DWORD  error = 0;
-		DWORD  ModemStat; //MS_CTS_ON=0x0010 MS_DSR_ON=0x0020 MS_RING_ON=0x0040 MS_RLSD_ON=0x0080
-
-		RS232_PinStatus newStatus;
-
-		// Get the current modem status
-		if (!GetCommModemStatus(m_HSerialPort, &ModemStat))
-		{
-			// Get extended error code
-			error = GetLastError();
-			std::cout << "RS232_PortHandler::updatepinStatus() -> ERRROR - GetCommModemStatus failure" << std::endl;
-		}
-		else
-		{
-			// Extract the bits we want to examine
-			ModemStat &= (DWORD)(MS_RLSD_ON | MS_RING_ON | MS_DSR_ON | MS_CTS_ON);
-
-			newStatus.m_CTS_on = (ModemStat & MS_CTS_ON) != 0;
-			newStatus.m_DSR_on = (ModemStat & MS_DSR_ON) != 0;
-			newStatus.m_RI_on = (ModemStat & MS_RING_ON) != 0;
-			newStatus.m_RLSD_on = (ModemStat & MS_RLSD_ON) != 0;
-		}
-
-		if (m_pinStatus != newStatus)
-		{
-			m_pinStatus = newStatus;
-			m_subscriber->on_serialstate_changed(m_pinStatus);
-		}
-		return (error);
-	}
-
-	void RS232_PortHandler::waitForPortToBecomeAvailable()
-	{
-		std::cout << "RS232_PortHandler::waitForPortToBecomeAvailable()" << std::endl;
-		m_PortHandlerClosed = false;
-		while (!m_PortHandlerClosed)
-		{
-			std::vector<std::string> comPortNames = getComPortNames();
-			if (std::find(comPortNames.begin(), comPortNames.end(), m_portParams->m_comPort) != comPortNames.end())
-			{	//given comport exists in the list!
-				openPortHandler();
-				if (is_active())
-				{
-					init();
-					break;
-				}
-			}
-			else
-			{	//given comport does NOT exist in the list!
-				std::this_thread::sleep_for(std::chrono::seconds(3));
-				continue; //continue to retry!
-			}
-		}
-		return;
-	}
-
-	std::vector<std::string> RS232_PortHandler::getComPortNames()
-	{
-		std::vector<std::string> openPortNames;
-
-		BOOL returnVal;
-		DWORD size;
-		GUID guid[1];
-		HDEVINFO hDevInfo;
-		DWORD idx = 0;
-		SP_DEVINFO_DATA devInfoData;
-		devInfoData.cbSize = sizeof(SP_DEVINFO_DATA);
-		int count = 0;
-
-		returnVal = SetupDiClassGuidsFromName("Ports", (LPGUID)&guid, 1, &size);
-		if (!returnVal)
-		{
-			std::cout << "RS232_PortHandler::getComPortNames() -> error : SetupDiClassGuidsFromName() failed..." << std::endl;
-			return openPortNames;
-		}
-
-		hDevInfo = SetupDiGetClassDevs(&guid[0], NULL, NULL, DIGCF_PRESENT | DIGCF_PROFILE);
-		if (hDevInfo == INVALID_HANDLE_VALUE)
-		{
-			std::cout << "RS232_PortHandler::getComPortNames() -> error : SetupDiGetClassDevs() failed..." << std::endl;
-			return openPortNames;
-		}
-
-		while (SetupDiEnumDeviceInfo(hDevInfo, idx++, &devInfoData))
-		{
-			char friendlyName[MAX_PATH];
-			char portName[MAX_PATH];
-			DWORD propType;
-			DWORD type = REG_SZ;
-			HKEY hKey = NULL;
-
-			returnVal = ::SetupDiGetDeviceRegistryProperty(
-				hDevInfo, &devInfoData, SPDRP_FRIENDLYNAME, &propType,
-				(LPBYTE)friendlyName, sizeof(friendlyName), &size);
-
-			if (!returnVal)
-			{
-				std::cout << "RS232_PortHandler::getComPortNames() -> error : SetupDiGetDeviceRegistryProperty() failed..." << std::endl;
-				continue;
-			}
-
-			hKey = ::SetupDiOpenDevRegKey(hDevInfo, &devInfoData, DICS_FLAG_GLOBAL, 0, DIREG_DEV, KEY_READ);
-			if (!hKey)
-			{
-				std::cout << "RS232_PortHandler::getComPortNames() -> error : SetupDiOpenDevRegKey() failed..." << std::endl;
-				continue;
-			}
-
-			size = sizeof(portName);
-			returnVal = ::RegQueryValueEx(hKey, "PortName", 0, &type, (LPBYTE)&portName, &size);
-			::RegCloseKey(hKey);
-
-			openPortNames.push_back(portName);
-		}
-
-		SetupDiDestroyDeviceInfoList(hDevInfo);
-		return openPortNames;
-	}
-
-}
+#include "RS232_PortHandler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <SetupAPI.h>
+#pragma comment(lib, "Setupapi.lib")
+
+namespace RS232
+{
+	constexpr DWORD READER_JOIN_TIMEOUT = 1000; //milliseconds, a reader still running after it is blocked in a subscriber callback
+	constexpr DWORD PORT_RETRY_INTERVAL = 3000; //milliseconds between two attempts of the reconnect thread
+
+	std::atomic<unsigned int> RS232_PortHandler::m_liveThreads(0);
+
+	RS232_PortHandler::RS232_PortHandler(RS232_PortSubscriber_Ptr subscriber, RS232_PortParams_Ptr portParams) :
+		m_subscribers(std::make_shared<const RS232_SubscriberList>(1, subscriber)),
+		m_portParams(portParams),
+		m_bOpenSuccess(false),
+		m_ReadTerminated(false),
+		m_PortHandlerClosed(false),
+		m_reconnecting(false),
+		m_discardedTxBytes(0),
+		m_inputThrottles(0),
+		m_inputThrottledMicros(0),
+		m_throttleStart(0),
+		m_inputThrottled(false),
+		m_overruns(0),
+		m_rxOverflows(0),
+		m_parityErrors(0),
+		m_framingErrors(0),
+		m_breaks(0),
+		m_driverRtsToggle(portParams->m_halfDuplexMode == HD_AUTO),
+		m_rtsToggles(0),
+		m_totalRtsReleaseMicros(0),
+		m_maxRtsReleaseMicros(0),
+		m_BufferSize(0),
+		m_driverQueueSize(0),
+		m_peakInQueue(0),
+		m_driverQueueResizable(true),
+		m_handshakeLimitsPending(false),
+		m_ReadData(NULL),
+		m_readDataLocked(false),
+		m_readTarget(1),
+		m_totalReads(0),
+		m_totalReadBytes(0),
+		m_readsPerSecond(0.0),
+		m_averageBatchSize(0.0),
+		m_statsWindowEnd(0),
+		m_windowReads(0),
+		m_windowBytes(0)
+	{
+		m_HStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		openPortHandler();
+	}
+
+	RS232_PortHandler::~RS232_PortHandler()
+	{
+		close();
+		joinReader(); //close() leaves it to the destructor when it is called back by the reader
+		releaseHandles();
+		if (m_reconnectThread.joinable())
+		{
+			if (m_reconnectThread.get_id() == std::this_thread::get_id())
+				m_reconnectThread.detach();
+			else
+				m_reconnectThread.join();
+		}
+		CloseHandle(m_HStopEvent);
+
+		if (m_readDataLocked)
+			VirtualUnlock(m_ReadData, m_BufferSize);
+		free(m_ReadData);
+	}
+
+	void RS232_PortHandler::openPortHandler()
+	{
+		std::string comPort;
+		if (m_portParams->m_comPort.length() == 4) /*COM1-9*/
+		{
+			comPort = m_portParams->m_comPort;
+		}
+		else /*COM10-99*/
+		{
+			comPort = COM_PORT_PREPEND + m_portParams->m_comPort;
+		}
+
+		m_HSerialPort = CreateFile(
+			comPort.c_str(),
+			GENERIC_READ | GENERIC_WRITE,
+			0,
+			NULL,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL |
+			FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING,
+			NULL);
+
+		DWORD errorNumber = GetLastError();
+
+		m_bOpenSuccess = true;
+
+		if (m_HSerialPort == INVALID_HANDLE_VALUE || errorNumber == ERROR_ACCESS_DENIED || errorNumber == ERROR_FILE_NOT_FOUND)
+		{	//ERROR_ACCESS_DENIED => COM port is used by another application!
+			//ERROR_FILE_NOT_FOUND => COM port does not exist in the system!
+			std::cout << "RS232_PortHandler::openPortHandler() -> Unable to open Serial Port" << m_portParams->m_comPort << std::endl;
+			m_bOpenSuccess = false;
+		}
+	}
+
+	void RS232_PortHandler::init()
+	{
+		if (m_ReadData == NULL) //kept when the port is re-opened
+		{
+			m_BufferSize = m_portParams->m_rxBufferSize;
+			m_ReadData = (char*)malloc(m_BufferSize * sizeof(char));
+			memset(m_ReadData, 0, m_BufferSize);
+			m_LPReadData = m_ReadData;
+			if (m_portParams->m_lockMemory)
+				lockReadBuffer();
+		}
+
+		DWORD threadID;
+
+		//driver input queue, grown by adaptRxBuffers() when the line outruns the reader
+		if (m_driverQueueSize == 0)
+			m_driverQueueSize = m_portParams->m_rxBufferSize;
+		if (!SetupComm(m_HSerialPort, m_driverQueueSize, m_portParams->m_txBufferSize))
+		{
+			std::cout << "RS232_PortHandler::init() -> queue sizes of " << m_portParams->m_comPort << " cannot be set, error: " << GetLastError() << std::endl;
+			m_driverQueueResizable = false;
+		}
+
+		DCB dcb; //Device Control Block
+		memset(&dcb, 0, sizeof(DCB));
+		dcb.DCBlength = sizeof(DCB);
+		dcb.BaudRate = (int)m_portParams->m_baudRate;
+		dcb.fBinary = TRUE;
+		dcb.fDtrControl = DTR_CONTROL_ENABLE;
+		dcb.ByteSize = ConvertCharSize(m_portParams->m_charSize);
+		dcb.Parity = ConvertParity(m_portParams->m_parity);
+		dcb.StopBits = ConvertStopBits(m_portParams->m_stopBits);
+		configureFlowControl(dcb);
+
+		//Hardcoded Configuration Below
+		if (!SetCommState(m_HSerialPort, &dcb) && m_driverRtsToggle)
+		{	//the driver cannot toggle RTS by itself, it is done around each write
+			std::cout << "RS232_PortHandler::init() -> driver of " << m_portParams->m_comPort << " does not toggle RTS, error: " << GetLastError()
+				<< ", RTS is toggled by the writer!" << std::endl;
+			m_driverRtsToggle = false;
+			configureFlowControl(dcb);
+			SetCommState(m_HSerialPort, &dcb);
+		}
+
+		//read timeouts implement the batching: a read returns when it is full or the max wait is over
+		COMMTIMEOUTS timeouts;
+		memset(&timeouts, 0, sizeof(COMMTIMEOUTS));
+		if (m_portParams->m_readMaxWaitMicros > 0)
+			timeouts.ReadTotalTimeoutConstant = (m_portParams->m_readMaxWaitMicros + 999) / 1000; //millisecond granularity of the driver
+		else
+			timeouts.ReadIntervalTimeout = MAXDWORD; //return immediately with the bytes already received
+		SetCommTimeouts(m_HSerialPort, &timeouts);
+		m_readTarget = m_portParams->m_readMinBytes;
+		m_statsWindowStart = std::chrono::steady_clock::now();
+
+		//SetCommMask will trigger WaitCommEvent
+		SetCommMask(m_HSerialPort, EV_RXCHAR | EV_CTS | EV_DSR | EV_RLSD | EV_ERR | EV_RING);
+
+		//Start Thread for Serial Port Handling
+		m_HReadThread = CreateThread(NULL, 0, RS232_PortHandler::startReadThread, this, CREATE_SUSPENDED, &threadID);
+		if (m_HReadThread != NULL)
+		{
+			m_readThreadId = threadID;
+			m_liveThreads++;
+			applySchedulingParams(m_HReadThread, m_portParams);
+			ResumeThread(m_HReadThread);
+		}
+		else
+		{
+			std::cout << "RS232_PortHandler::init() -> reader thread of " << m_portParams->m_comPort << " cannot be created, error: " << GetLastError() << std::endl;
+		}
+	}
+
+	void RS232_PortHandler::applySchedulingParams(HANDLE thread, RS232_PortParams_Ptr portParams)
+	{
+		if (portParams->m_cpuAffinity != 0 && SetThreadAffinityMask(thread, (DWORD_PTR)portParams->m_cpuAffinity) == 0)
+		{
+			std::cout << "RS232_PortHandler::applySchedulingParams() -> " << portParams->m_comPort << " cannot be pinned to CPU mask 0x"
+				<< std::hex << portParams->m_cpuAffinity << std::dec << ", error: " << GetLastError() << std::endl;
+		}
+
+		int threadPriority = THREAD_PRIORITY_NORMAL;
+		if (portParams->m_readerPriority == RP_HIGH)
+			threadPriority = THREAD_PRIORITY_HIGHEST;
+		else if (portParams->m_readerPriority == RP_TIME_CRITICAL)
+			threadPriority = THREAD_PRIORITY_TIME_CRITICAL;
+
+		if (threadPriority != THREAD_PRIORITY_NORMAL && !SetThreadPriority(thread, threadPriority))
+		{
+			std::cout << "RS232_PortHandler::applySchedulingParams() -> priority of the " << portParams->m_comPort
+				<< " reader cannot be raised, error: " << GetLastError() << std::endl;
+		}
+	}
+
+	void RS232_PortHandler::applyPriorityClass(DWORD priorityClass)
+	{
+		if (priorityClass == NORMAL_PRIORITY_CLASS)
+			return;
+
+		//without the privilege Windows silently gives HIGH_PRIORITY_CLASS instead of the realtime class
+		SetPriorityClass(GetCurrentProcess(), priorityClass);
+		if (GetPriorityClass(GetCurrentProcess()) != priorityClass)
+		{
+			std::cout << "RS232_PortHandler::applyPriorityClass() -> priority class 0x" << std::hex << priorityClass << std::dec
+				<< " is not permitted (SeIncreaseBasePriorityPrivilege), the process runs in class 0x" << std::hex << GetPriorityClass(GetCurrentProcess()) << std::dec << "!" << std::endl;
+		}
+	}
+
+	void RS232_PortHandler::configureFlowControl(DCB& dcb)
+	{
+		bool watermarks = m_portParams->m_flowHighWatermark > 0;
+		dcb.fRtsControl = ConvertRtsControl(m_portParams->m_flowControl, watermarks);
+		dcb.fOutxCtsFlow = (m_portParams->m_flowControl == FC_HARD); //the sender stops us by CTS
+		if (m_portParams->m_halfDuplexMode != HD_NONE) //RTS enables the line driver, the receiver is on while it is off
+			dcb.fRtsControl = m_driverRtsToggle ? RTS_CONTROL_TOGGLE : RTS_CONTROL_DISABLE;
+		dcb.fOutX = (m_portParams->m_flowControl == FC_SOFT); //the sender stops us by XOFF
+		dcb.fInX = (m_portParams->m_flowControl == FC_SOFT && !watermarks); //the driver stops the sender by XOFF
+		dcb.fTXContinueOnXoff = TRUE; //our XOFF does not hold our own transmission
+		dcb.XonChar = ASCII_DC1;
+		dcb.XoffChar = ASCII_DC3;
+
+		dcb.XonLim = getHandshakeLimit();
+		dcb.XoffLim = getHandshakeLimit();
+	}
+
+	WORD RS232_PortHandler::getHandshakeLimit()
+	{
+		//driver handshake: stop the sender when a quarter of the input buffer is left, release it when a quarter is used
+		COMMPROP commProp;
+		memset(&commProp, 0, sizeof(COMMPROP));
+		DWORD rxQueue = m_driverQueueSize;
+		if (GetCommProperties(m_HSerialPort, &commProp) && commProp.dwCurrentRxQueue > 0)
+			rxQueue = commProp.dwCurrentRxQueue;
+		return (WORD)std::min<DWORD>(rxQueue / 4, 0xFFFF);
+	}
+
+	void RS232_PortHandler::updateHandshakeLimits()
+	{
+		//SetCommState re-applies the RTS mode of the DCB: not in the middle of a write (HD_RTS keys the line driver by RTS)
+		std::unique_lock<std::mutex> writeLock(m_writeGuard, std::try_to_lock);
+		if (!writeLock.owns_lock())
+			return; //retried after the next read
+		m_handshakeLimitsPending = false;
+
+		std::lock_guard<std::mutex> rtsLock(m_rtsGuard);
+		DCB dcb;
+		memset(&dcb, 0, sizeof(DCB));
+		dcb.DCBlength = sizeof(DCB);
+		if (!GetCommState(m_HSerialPort, &dcb))
+		{
+			std::cout << "RS232_PortHandler::updateHandshakeLimits() -> state of " << m_portParams->m_comPort << " cannot be read, error: " << GetLastError() << std::endl;
+			return;
+		}
+		dcb.XonLim = getHandshakeLimit();
+		dcb.XoffLim = getHandshakeLimit();
+		if (!SetCommState(m_HSerialPort, &dcb))
+		{
+			std::cout << "RS232_PortHandler::updateHandshakeLimits() -> handshake limits of " << m_portParams->m_comPort << " cannot be set, error: " << GetLastError() << std::endl;
+			return;
+		}
+		if (m_inputThrottled && m_portParams->m_flowControl == FC_HARD)
+			EscapeCommFunction(m_HSerialPort, CLRRTS); //RTS_CONTROL_ENABLE raised it again, the sender stays stopped
+	}
+
+	void RS232_PortHandler::throttleInput(bool throttle)
+	{
+		if (!m_bOpenSuccess)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_rtsGuard);
+		m_inputThrottled = throttle;
+		BOOL signalled = FALSE;
+		if (m_portParams->m_flowControl == FC_HARD)
+			signalled = EscapeCommFunction(m_HSerialPort, throttle ? CLRRTS : SETRTS);
+		else if (m_portParams->m_flowControl == FC_SOFT)
+			signalled = TransmitCommChar(m_HSerialPort, throttle ? ASCII_DC3 : ASCII_DC1); //ahead of the bytes waiting in the output buffer
+		if (!signalled)
+		{
+			std::cout << "RS232_PortHandler::throttleInput() -> sender of " << m_portParams->m_comPort << " cannot be "
+				<< (throttle ? "stopped" : "released") << ", error: " << GetLastError() << std::endl;
+		}
+
+		long long now = std::chrono::steady_clock::now().time_since_epoch().count();
+		if (throttle)
+		{
+			m_inputThrottles++;
+			m_throttleStart = now;
+		}
+		else
+		{
+			long long throttleStart = m_throttleStart.exchange(0);
+			if (throttleStart != 0)
+				m_inputThrottledMicros += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::duration(now - throttleStart)).count();
+		}
+	}
+
+	void RS232_PortHandler::countCommErrors(DWORD errors)
+	{
+		if (errors & CE_OVERRUN)
+			m_overruns++;
+		if (errors & CE_RXOVER)
+			m_rxOverflows++;
+		if (errors & CE_RXPARITY)
+			m_parityErrors++;
+		if (errors & CE_FRAME)
+			m_framingErrors++;
+		if (errors & CE_BREAK)
+			m_breaks++;
+	}
+
+	void RS232_PortHandler::adaptRxBuffers(DWORD errors, DWORD bytesInQueue)
+	{
+		if (bytesInQueue > m_peakInQueue)
+			m_peakInQueue = bytesInQueue;
+
+		DWORD maxSize = m_portParams->m_rxBufferMaxSize;
+		if (m_handshakeLimitsPending)
+			updateHandshakeLimits();
+
+		//the driver queue overflowed or is half full: a burst of the line outruns the reader thread
+		if (((errors & CE_RXOVER) || bytesInQueue > m_driverQueueSize / 2) && m_driverQueueSize < maxSize && m_driverQueueResizable)
+			resizeDriverQueue(std::min<DWORD>(m_driverQueueSize * 2, maxSize));
+
+		//a single read cannot take the whole queue: the batch grows with the read buffer
+		if (bytesInQueue > (DWORD)m_BufferSize && (DWORD)m_BufferSize < maxSize)
+			growReadBuffer(std::min<DWORD>(std::max<DWORD>(bytesInQueue, m_BufferSize * 2), maxSize));
+	}
+
+	bool RS232_PortHandler::resizeDriverQueue(DWORD size)
+	{
+		if (!SetupComm(m_HSerialPort, size, m_portParams->m_txBufferSize))
+		{
+			std::cout << "RS232_PortHandler::resizeDriverQueue() -> input queue of " << m_portParams->m_comPort << " cannot grow to " << size
+				<< " bytes, error: " << GetLastError() << ", kept at " << m_driverQueueSize << " bytes!" << std::endl;
+			m_driverQueueResizable = false;
+			return false;
+		}
+		m_driverQueueSize = size;
+
+		//the handshake thresholds follow the queue size
+		m_handshakeLimitsPending = true;
+		updateHandshakeLimits();
+		std::cout << "RS232_PortHandler::resizeDriverQueue() -> input queue of " << m_portParams->m_comPort << " grown to " << size << " bytes" << std::endl;
+		return true;
+	}
+
+	void RS232_PortHandler::growReadBuffer(DWORD size)
+	{
+		char* readData = (char*)malloc(size * sizeof(char));
+		if (readData == NULL)
+		{
+			std::cout << "RS232_PortHandler::growReadBuffer() -> " << size << " bytes cannot be allocated for " << m_portParams->m_comPort << std::endl;
+			return;
+		}
+		memset(readData, 0, size);
+
+		if (m_readDataLocked)
+			VirtualUnlock(m_ReadData, m_BufferSize);
+		m_readDataLocked = false;
+		free(m_ReadData);
+
+		m_ReadData = readData;
+		m_LPReadData = m_ReadData;
+		m_BufferSize = size;
+		if (m_portParams->m_lockMemory)
+			lockReadBuffer();
+		std::cout << "RS232_PortHandler::growReadBuffer() -> read buffer of " << m_portParams->m_comPort << " grown to " << size << " bytes" << std::endl;
+	}
+
+	void RS232_PortHandler::lockReadBuffer()
+	{
+		memset(m_ReadData, 0, m_BufferSize); //touches every page of the buffer
+
+		//the minimum working set has to grow by the locked size, VirtualLock fails otherwise
+		SIZE_T minimumWorkingSet = 0;
+		SIZE_T maximumWorkingSet = 0;
+		HANDLE process = GetCurrentProcess();
+		if (GetProcessWorkingSetSize(process, &minimumWorkingSet, &maximumWorkingSet))
+			SetProcessWorkingSetSize(process, minimumWorkingSet + m_BufferSize, maximumWorkingSet + m_BufferSize);
+
+		m_readDataLocked = VirtualLock(m_ReadData, m_BufferSize) != FALSE;
+		if (!m_readDataLocked)
+		{
+			std::cout << "RS232_PortHandler::lockReadBuffer() -> read buffer of " << m_portParams->m_comPort
+				<< " cannot be locked in memory, error: " << GetLastError() << std::endl;
+		}
+	}
+
+	void RS232_PortHandler::close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_stateGuard);
+			if (m_PortHandlerClosed)
+				return;
+			m_PortHandlerClosed = true; //the reconnect thread does not open the port any more
+		}
+
+		if (m_bOpenSuccess.exchange(false)) //no new write is started from now on
+			drainTx();
+		m_ReadTerminated = true;
+		SetEvent(m_HStopEvent); //wakes up the reader, a write waiting for the line & the reconnect thread
+
+		if (m_reconnectThread.joinable() && m_reconnectThread.get_id() != std::this_thread::get_id())
+			m_reconnectThread.join();
+		{
+			std::lock_guard<std::mutex> lock(m_writeGuard); //the write in progress has completed or given up
+		}
+		if (m_readThreadId == GetCurrentThreadId())
+			return; //called back by the reader, the handles are still in use
+
+		joinReader();
+		releaseHandles();
+	}
+
+	void RS232_PortHandler::joinReader()
+	{
+		if (m_HReadThread == NULL || m_readThreadId == GetCurrentThreadId())
+			return;
+
+		if (WaitForSingleObject(m_HReadThread, READER_JOIN_TIMEOUT) == WAIT_TIMEOUT)
+		{
+			std::cout << "RS232_PortHandler::joinReader() -> reader of " << m_portParams->m_comPort << " did not stop within "
+				<< READER_JOIN_TIMEOUT << " ms, a subscriber callback is blocked!" << std::endl;
+			WaitForSingleObject(m_HReadThread, INFINITE); //its handles cannot be released under it
+		}
+		CloseHandle(m_HReadThread);
+		m_HReadThread = NULL;
+		m_readThreadId = 0;
+	}
+
+	void RS232_PortHandler::releaseHandles()
+	{
+		if (m_HSerialPort != NULL && m_HSerialPort != INVALID_HANDLE_VALUE)
+			CloseHandle(m_HSerialPort);
+		m_HSerialPort = NULL;
+	}
+
+	void RS232_PortHandler::drainTx()
+	{
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_portParams->m_txDrainTimeoutMillis);
+		COMSTAT comStat;
+		DWORD errors;
+		memset(&comStat, 0, sizeof(COMSTAT));
+		while (ClearCommError(m_HSerialPort, &errors, &comStat) && comStat.cbOutQue > 0 && std::chrono::steady_clock::now() < deadline)
+		{
+			countCommErrors(errors);
+			Sleep(1);
+		}
+
+		if (comStat.cbOutQue > 0)
+		{
+			m_discardedTxBytes += comStat.cbOutQue;
+			std::cout << "RS232_PortHandler::close() -> " << comStat.cbOutQue << " bytes could NOT be sent to " << m_portParams->m_comPort
+				<< " within " << m_portParams->m_txDrainTimeoutMillis << " ms, discarded!" << std::endl;
+			PurgeComm(m_HSerialPort, PURGE_TXABORT | PURGE_TXCLEAR); //completes the write waiting for the line
+		}
+	}
+
+	DWORD RS232_PortHandler::waitForIo(OVERLAPPED& overlapped, DWORD timeout)
+	{
+		HANDLE waitHandles[] = { overlapped.hEvent, m_HStopEvent };
+		DWORD waitResult = WaitForMultipleObjects(2, waitHandles, FALSE, timeout);
+		if (waitResult == WAIT_OBJECT_0 + 1)
+		{	//the driver may still write to the OVERLAPPED until the cancelled operation completes
+			DWORD transferred;
+			CancelIoEx(m_HSerialPort, &overlapped);
+			GetOverlappedResult(m_HSerialPort, &overlapped, &transferred, TRUE);
+		}
+		return waitResult;
+	}
+
+	bool RS232_PortHandler::write(const unsigned char* data, unsigned int length, RS232_PortSubscriber* writer)
+	{
+		std::lock_guard<std::mutex> lock(m_writeGuard);
+
+		if (!m_bOpenSuccess)
+		{
+			std::cout << "RS232_PortHandler::write() -> serial port NOT active!" << std::endl;
+			return false;
+		}
+
+		bool toggleRts = (m_portParams->m_halfDuplexMode != HD_NONE && !m_driverRtsToggle);
+		std::chrono::steady_clock::time_point txStart = std::chrono::steady_clock::now();
+		if (toggleRts && !EscapeCommFunction(m_HSerialPort, SETRTS))
+			std::cout << "RS232_PortHandler::write() -> line driver of " << m_portParams->m_comPort << " cannot be enabled, error: " << GetLastError() << std::endl;
+
+		if (writer != NULL) //no other write can go out in front of these bytes any more
+			writer->on_tx_start(data, length, FrameClock::now());
+
+		bool written = true;
+		DWORD numOFWrittenBytes;
+		OVERLAPPED ovlWrite;
+		ovlWrite.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		// Reset event before writing to COM port
+		ResetEvent(ovlWrite.hEvent);
+		ovlWrite.OffsetHigh = ovlWrite.Offset = 0;
+		if (!WriteFile(m_HSerialPort, data, length, &numOFWrittenBytes, &ovlWrite))
+		{
+			DWORD errorNumber = GetLastError();
+			if (errorNumber == ERROR_IO_PENDING)
+			{	// Wait for data to be written, close() cancels the write when the line does not take it within the drain timeout
+				if (waitForIo(ovlWrite, INFINITE) != WAIT_OBJECT_0)
+				{
+					std::cout << "RS232_PortHandler::write() -> port is closed, write is cancelled!" << std::endl;
+					written = false;
+				}
+				else if (!GetOverlappedResult(m_HSerialPort, &ovlWrite, &numOFWrittenBytes, TRUE) || length != numOFWrittenBytes)
+				{
+					std::cout << "RS232_PortHandler::write() -> Data could NOT be written to the port!" << std::endl;
+					written = false;
+				}
+			}
+			else
+			{
+				std::cout << "RS232_PortHandler::write() -> Data could NOT be written to the port!" << std::endl;
+				written = false;
+			}
+		}
+		CloseHandle(ovlWrite.hEvent);
+
+		if (toggleRts)
+			releaseLineDriver(length, txStart);
+		return written;
+	}
+
+	void RS232_PortHandler::releaseLineDriver(unsigned int length, std::chrono::steady_clock::time_point txStart)
+	{
+		/*
+		* the write completes once the driver has taken the bytes, the last ones are still in the output queue & the UART FIFO;
+		* RTS is held until the byte count has been on the line at the baud rate, or a char time after the queue is empty if the driver started late
+		*/
+		std::chrono::steady_clock::duration charTime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::micro>(m_portParams->getCharTimeMicros()));
+		std::chrono::steady_clock::time_point wireEnd = txStart + charTime * length;
+		std::chrono::steady_clock::time_point release = wireEnd;
+		COMSTAT comStat;
+		DWORD errors;
+		memset(&comStat, 0, sizeof(COMSTAT));
+		while (ClearCommError(m_HSerialPort, &errors, &comStat) && comStat.cbOutQue > 0 && !m_PortHandlerClosed)
+		{
+			countCommErrors(errors);
+			std::chrono::steady_clock::duration queued = charTime * comStat.cbOutQue;
+			if (queued > std::chrono::milliseconds(2))
+				Sleep(1);
+			else
+				std::this_thread::yield();
+		}
+		release = std::max(release, std::chrono::steady_clock::now() + charTime) + std::chrono::microseconds(m_portParams->m_rtsGuardMicros);
+
+		//Sleep() is too coarse for the last millisecond, the rest is spun
+		while (std::chrono::steady_clock::now() + std::chrono::milliseconds(2) < release)
+			Sleep(1);
+		while (std::chrono::steady_clock::now() < release)
+			std::this_thread::yield();
+
+		if (!EscapeCommFunction(m_HSerialPort, CLRRTS))
+			std::cout << "RS232_PortHandler::write() -> line driver of " << m_portParams->m_comPort << " cannot be disabled, error: " << GetLastError() << std::endl;
+
+		unsigned long long releaseMicros = (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - wireEnd).count();
+		m_rtsToggles++;
+		m_totalRtsReleaseMicros += releaseMicros;
+		if (releaseMicros > m_maxRtsReleaseMicros)
+			m_maxRtsReleaseMicros = releaseMicros;
+	}
+
+	DWORD WINAPI RS232_PortHandler::startReadThread(LPVOID lpV)
+	{
+		DWORD result = static_cast<RS232_PortHandler*>(lpV)->read();
+		m_liveThreads--;
+		return result;
+	}
+
+	DWORD RS232_PortHandler::read()
+	{
+		std::lock_guard<std::mutex> lock(m_readGuard);
+
+		DWORD dwBytesRead = 0;
+		DWORD dwEvent;
+		OVERLAPPED ovlRead;
+		COMSTAT comStat;
+		DWORD dwErrors;
+
+		// Get an initial comm status
+		if (updatePinStatus())
+		{	// We can NOT get comm status, so exit this thread
+			std::cout << "RS232_PortHandler::read() -> Cannot get comm status! Exiting reader thread!" << std::endl;
+			notifyError(PE_CannotOpenPort);
+			reconnect();
+			return 0;
+		}
+
+		// Create the event for overlapped reads
+		ovlRead.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+		while (!m_ReadTerminated)
+		{
+			// Reset event before waiting for comm event
+			ResetEvent(ovlRead.hEvent);
+			ovlRead.OffsetHigh = ovlRead.Offset = 0;
+
+			// Wait for comm event
+			DWORD errorNumber;
+			if (!WaitCommEvent(m_HSerialPort, &dwEvent, &ovlRead))
+			{
+				// Is data pending?
+				if ((errorNumber = GetLastError()) == ERROR_IO_PENDING)
+				{
+					// Wait for data to be received, notify the subscriber about line silence meanwhile
+					DWORD idleTimeout = getIdleTimeout();
+					DWORD waitResult;
+					while ((waitResult = waitForIo(ovlRead, idleTimeout)) == WAIT_TIMEOUT)
+					{
+						for (const RS232_PortSubscriber_Ptr& subscriber : *getSubscribers())
+							subscriber->on_idle();
+					}
+					if (waitResult != WAIT_OBJECT_0)
+						break; //woken up by close()
+					GetOverlappedResult(m_HSerialPort, &ovlRead, &dwBytesRead, TRUE);
+				}
+				else if ((errorNumber = GetLastError()) == ERROR_ACCESS_DENIED)
+				{
+					std::cout << "RS232_PortHandler::read() -> Serial Cable is unplugged" << std::endl;
+					notifyError(PE_PortIsNotOpen);
+					break;
+				}
+			}
+
+			// Is data available?
+			if (!m_ReadTerminated && ((dwEvent & EV_RXCHAR) || (dwEvent == 0)))
+			{
+				// Reset event before reading COM data
+				ResetEvent(ovlRead.hEvent);
+				ovlRead.OffsetHigh = ovlRead.Offset = 0;
+
+				if (m_LPReadData)
+				{
+					ClearCommError(m_HSerialPort, &dwErrors, &comStat);
+					countCommErrors(dwErrors);
+					adaptRxBuffers(dwErrors, comStat.cbInQue);
+					DWORD bytesToRead = nextReadSize(comStat.cbInQue);
+					// Read data from COM port
+					if (!ReadFile(m_HSerialPort, m_LPReadData, bytesToRead, &dwBytesRead, &ovlRead))
+					{
+						// Is more data pending?
+						if ((errorNumber = GetLastError()) == ERROR_IO_PENDING)
+						{
+							// Wait for read to complete
+							if (waitForIo(ovlRead, INFINITE) != WAIT_OBJECT_0)
+								break; //woken up by close()
+							if (!GetOverlappedResult(m_HSerialPort, &ovlRead, &dwBytesRead, TRUE))
+							{
+								std::cout << "RS232_PortHandler::read() ->  overlapped read FAILED!" << std::endl;
+							}
+						}
+					}
+
+					// Did we receive data?
+					if (dwBytesRead)
+					{
+						FrameTime readTime = FrameClock::now(); //stop bit of the last byte, the framers interpolate the rest back from it
+						onReadCompleted(bytesToRead, dwBytesRead);
+						for (const RS232_PortSubscriber_Ptr& subscriber : *getSubscribers())
+							subscriber->on_read((unsigned char *)m_LPReadData, dwBytesRead, readTime);
+					}
+				}
+			}
+
+			// Did we also receive a CTS or DSR or RLSD or RING line event?
+			if (!m_ReadTerminated && ((dwEvent & EV_CTS) || (dwEvent & EV_DSR) || (dwEvent & EV_RLSD) || (dwEvent & EV_RING)))
+			{
+				//std::cout << "RS232_PortHandler::read() ->  Serial Signal change information is available" << std::endl;
+				updatePinStatus();
+			}
+
+			//line errors (overrun, parity, framing, break) are counted & the port is read on, only a failing port ends the reader
+			if (!m_ReadTerminated && (dwEvent & EV_ERR))
+			{
+				if (ClearCommError(m_HSerialPort, &dwErrors, &comStat))
+				{
+					countCommErrors(dwErrors);
+					adaptRxBuffers(dwErrors, comStat.cbInQue);
+				}
+				else
+				{
+					std::cout << "RS232_PortHandler::read() ->  Error happened in the serial port! Exiting..." << std::endl;
+					notifyError(PE_ReadError);
+					break;
+				}
+			}
+		}
+
+		CloseHandle(ovlRead.hEvent);
+		if (!m_ReadTerminated) //the port went away (e.g. the cable is unplugged), it is opened again once available
+			reconnect();
+		return 0;
+	}
+
+	DWORD RS232_PortHandler::getMaxBatch() const
+	{
+		DWORD maxBatch = m_portParams->m_readMaxBatch;
+		if (maxBatch == 0 || maxBatch > (DWORD)m_BufferSize)
+			maxBatch = m_BufferSize;
+		return maxBatch;
+	}
+
+	DWORD RS232_PortHandler::nextReadSize(DWORD bytesInQueue) const
+	{
+		if (m_portParams->m_readMaxWaitMicros == 0) //no batching, take whatever the driver has
+			return std::min(bytesInQueue, getMaxBatch());
+		return std::min(std::max(bytesInQueue, (DWORD)m_readTarget), getMaxBatch());
+	}
+
+	void RS232_PortHandler::onReadCompleted(DWORD bytesRequested, DWORD bytesRead)
+	{
+		if (m_portParams->m_readMaxWaitMicros > 0)
+		{	//bulk streams fill the reads so the batch grows, interactive devices time out so it shrinks back
+			if (bytesRead >= bytesRequested)
+				m_readTarget = std::min(std::max((DWORD)m_readTarget * 2, bytesRead), getMaxBatch());
+			else
+				m_readTarget = std::max((DWORD)m_readTarget / 2, (DWORD)m_portParams->m_readMinBytes);
+		}
+
+		m_totalReads++;
+		m_totalReadBytes += bytesRead;
+		m_windowReads++;
+		m_windowBytes += bytesRead;
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		std::chrono::duration<double> elapsed = now - m_statsWindowStart;
+		if (elapsed >= std::chrono::seconds(1))
+		{
+			m_readsPerSecond = m_windowReads / elapsed.count();
+			m_averageBatchSize = (double)m_windowBytes / m_windowReads;
+			m_statsWindowEnd = now.time_since_epoch().count();
+			m_statsWindowStart = now;
+			m_windowReads = 0;
+			m_windowBytes = 0;
+		}
+	}
+
+	RS232_FlowStats RS232_PortHandler::getFlowStats() const
+	{
+		RS232_FlowStats stats;
+		stats.m_inputThrottles = m_inputThrottles;
+		stats.m_inputThrottledMicros = m_inputThrottledMicros;
+		long long throttleStart = m_throttleStart;
+		stats.m_inputThrottled = (throttleStart != 0);
+		if (stats.m_inputThrottled)
+			stats.m_inputThrottledMicros += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch() - std::chrono::steady_clock::duration(throttleStart)).count();
+		return stats;
+	}
+
+	RS232_ErrorStats RS232_PortHandler::getErrorStats() const
+	{
+		RS232_ErrorStats stats;
+		stats.m_overruns = m_overruns;
+		stats.m_rxOverflows = m_rxOverflows;
+		stats.m_parityErrors = m_parityErrors;
+		stats.m_framingErrors = m_framingErrors;
+		stats.m_breaks = m_breaks;
+		return stats;
+	}
+
+	RS232_RtsToggleStats RS232_PortHandler::getRtsToggleStats() const
+	{
+		RS232_RtsToggleStats stats;
+		stats.m_driverToggle = (m_portParams->m_halfDuplexMode != HD_NONE && m_driverRtsToggle);
+		stats.m_toggles = m_rtsToggles;
+		stats.m_maxReleaseMicros = m_maxRtsReleaseMicros;
+		if (stats.m_toggles > 0)
+			stats.m_averageReleaseMicros = (double)m_totalRtsReleaseMicros / stats.m_toggles;
+		return stats;
+	}
+
+	RS232_ReadStats RS232_PortHandler::getReadStats() const
+	{
+		RS232_ReadStats stats;
+		stats.m_totalReads = m_totalReads;
+		stats.m_totalBytes = m_totalReadBytes;
+		stats.m_currentBatchTarget = m_readTarget;
+		stats.m_readBufferSize = m_BufferSize;
+		stats.m_driverQueueSize = m_driverQueueSize;
+		stats.m_peakInQueue = m_peakInQueue;
+
+		//a window that is not closed for long means the line went quiet
+		std::chrono::steady_clock::duration sinceWindowEnd = std::chrono::steady_clock::now().time_since_epoch() - std::chrono::steady_clock::duration(m_statsWindowEnd.load());
+		if (sinceWindowEnd < std::chrono::seconds(2))
+		{
+			stats.m_readsPerSecond = m_readsPerSecond;
+			stats.m_averageBatchSize = m_averageBatchSize;
+		}
+		return stats;
+	}
+
+	DWORD RS232_PortHandler::updatePinStatus()
+	{
+		DWORD  error = 0;
+		DWORD  ModemStat; //MS_CTS_ON=0x0010 MS_DSR_ON=0x0020 MS_RING_ON=0x0040 MS_RLSD_ON=0x0080
+
+		RS232_PinStatus newStatus;
+
+		// Get the current modem status
+		if (!GetCommModemStatus(m_HSerialPort, &ModemStat))
+		{
+			// Get extended error code
+			error = GetLastError();
+			std::cout << "RS232_PortHandler::updatepinStatus() -> ERRROR - GetCommModemStatus failure" << std::endl;
+		}
+		else
+		{
+			// Extract the bits we want to examine
+			ModemStat &= (DWORD)(MS_RLSD_ON | MS_RING_ON | MS_DSR_ON | MS_CTS_ON);
+
+			newStatus.m_CTS_on = (ModemStat & MS_CTS_ON) != 0;
+			newStatus.m_DSR_on = (ModemStat & MS_DSR_ON) != 0;
+			newStatus.m_RI_on = (ModemStat & MS_RING_ON) != 0;
+			newStatus.m_RLSD_on = (ModemStat & MS_RLSD_ON) != 0;
+		}
+
+		if (m_pinStatus != newStatus)
+		{
+			m_pinStatus = newStatus;
+			for (const RS232_PortSubscriber_Ptr& subscriber : *getSubscribers())
+				subscriber->on_serialstate_changed(m_pinStatus);
+		}
+		return (error);
+	}
+
+	void RS232_PortHandler::addSubscriber(RS232_PortSubscriber_Ptr subscriber)
+	{
+		std::lock_guard<std::mutex> lock(m_subscribersGuard);
+		RS232_SubscriberList_Ptr current = std::atomic_load(&m_subscribers);
+		if (std::find(current->begin(), current->end(), subscriber) != current->end())
+			return;
+
+		std::shared_ptr<RS232_SubscriberList> updated = std::make_shared<RS232_SubscriberList>(*current);
+		updated->push_back(subscriber);
+		std::atomic_store(&m_subscribers, RS232_SubscriberList_Ptr(updated));
+	}
+
+	void RS232_PortHandler::removeSubscriber(const RS232_PortSubscriber_Ptr& subscriber)
+	{
+		std::lock_guard<std::mutex> lock(m_subscribersGuard);
+		RS232_SubscriberList_Ptr current = std::atomic_load(&m_subscribers);
+		std::shared_ptr<RS232_SubscriberList> updated = std::make_shared<RS232_SubscriberList>(*current);
+		updated->erase(std::remove(updated->begin(), updated->end(), subscriber), updated->end());
+		if (updated->size() != current->size())
+			std::atomic_store(&m_subscribers, RS232_SubscriberList_Ptr(updated));
+	}
+
+	void RS232_PortHandler::notifyError(PortError portError)
+	{
+		for (const RS232_PortSubscriber_Ptr& subscriber : *getSubscribers())
+			subscriber->on_socket_error(portError);
+	}
+
+	DWORD RS232_PortHandler::getIdleTimeout() const
+	{
+		//a subscriber may get on_idle() sooner than it asked for, when another one wants a shorter timeout
+		DWORD idleTimeout = INFINITE;
+		for (const RS232_PortSubscriber_Ptr& subscriber : *getSubscribers())
+			idleTimeout = std::min(idleTimeout, subscriber->getIdleTimeout());
+		return idleTimeout;
+	}
+
+	void RS232_PortHandler::reconnect()
+	{
+		std::lock_guard<std::mutex> lock(m_stateGuard);
+		if (m_PortHandlerClosed || m_reconnecting)
+			return;
+		if (m_reconnectThread.joinable())
+			m_reconnectThread.join(); //done with the previous reconnection, it clears m_reconnecting last
+		m_reconnecting = true;
+		m_liveThreads++;
+		m_reconnectThread = std::thread(&RS232_PortHandler::waitForPortToBecomeAvailable, this);
+	}
+
+	void RS232_PortHandler::waitForPortToBecomeAvailable()
+	{
+		std::cout << "RS232_PortHandler::waitForPortToBecomeAvailable()" << std::endl;
+		joinReader(); //the reader which reported the error exits right after starting the reconnection
+
+		bool retry = true;
+		while (retry)
+		{
+			std::vector<std::string> comPortNames = getComPortNames();
+			bool portExists = std::find(comPortNames.begin(), comPortNames.end(), m_portParams->m_comPort) != comPortNames.end();
+			{
+				//no write may use the handle while it is swapped, nor the new one before its settings are applied;
+				//taken before m_stateGuard so close() can still cancel a write stalled by the line
+				std::unique_lock<std::mutex> writeLock(m_writeGuard, std::defer_lock);
+				if (portExists)
+					writeLock.lock();
+				std::lock_guard<std::mutex> lock(m_stateGuard);
+				if (m_PortHandlerClosed)
+				{
+					retry = false;
+				}
+				else if (portExists)
+				{	//given comport exists in the list!
+					releaseHandles();
+					openPortHandler();
+					if (is_active())
+					{
+						init();
+						retry = false;
+					}
+				}
+				if (!retry)
+					m_reconnecting = false;
+			}
+			//given comport does NOT exist in the list or cannot be opened yet, close() cuts the wait short
+			if (retry)
+				WaitForSingleObject(m_HStopEvent, PORT_RETRY_INTERVAL);
+		}
+		m_liveThreads--;
+	}
+
+	std::vector<std::string> RS232_PortHandler::getComPortNames()
+	{
+		std::vector<std::string> openPortNames;
+
+		BOOL returnVal;
+		DWORD size;
+		GUID guid[1];
+		HDEVINFO hDevInfo;
+		DWORD idx = 0;
+		SP_DEVINFO_DATA devInfoData;
+		devInfoData.cbSize = sizeof(SP_DEVINFO_DATA);
+		int count = 0;
+
+		returnVal = SetupDiClassGuidsFromName("Ports", (LPGUID)&guid, 1, &size);
+		if (!returnVal)
+		{
+			std::cout << "RS232_PortHandler::getComPortNames() -> error : SetupDiClassGuidsFromName() failed..." << std::endl;
+			return openPortNames;
+		}
+
+		hDevInfo = SetupDiGetClassDevs(&guid[0], NULL, NULL, DIGCF_PRESENT | DIGCF_PROFILE);
+		if (hDevInfo == INVALID_HANDLE_VALUE)
+		{
+			std::cout << "RS232_PortHandler::getComPortNames() -> error : SetupDiGetClassDevs() failed..." << std::endl;
+			return openPortNames;
+		}
+
+		while (SetupDiEnumDeviceInfo(hDevInfo, idx++, &devInfoData))
+		{
+			char friendlyName[MAX_PATH];
+			char portName[MAX_PATH];
+			DWORD propType;
+			DWORD type = REG_SZ;
+			HKEY hKey = NULL;
+
+			returnVal = ::SetupDiGetDeviceRegistryProperty(
+				hDevInfo, &devInfoData, SPDRP_FRIENDLYNAME, &propType,
+				(LPBYTE)friendlyName, sizeof(friendlyName), &size);
+
+			if (!returnVal)
+			{
+				std::cout << "RS232_PortHandler::getComPortNames() -> error : SetupDiGetDeviceRegistryProperty() failed..." << std::endl;
+				continue;
+			}
+
+			hKey = ::SetupDiOpenDevRegKey(hDevInfo, &devInfoData, DICS_FLAG_GLOBAL, 0, DIREG_DEV, KEY_READ);
+			if (!hKey)
+			{
+				std::cout << "RS232_PortHandler::getComPortNames() -> error : SetupDiOpenDevRegKey() failed..." << std::endl;
+				continue;
+			}
+
+			size = sizeof(portName);
+			returnVal = ::RegQueryValueEx(hKey, "PortName", 0, &type, (LPBYTE)&portName, &size);
+			::RegCloseKey(hKey);
+
+			openPortNames.push_back(portName);
+		}
+
+		SetupDiDestroyDeviceInfoList(hDevInfo);
+		return openPortNames;
+	}
+
+}
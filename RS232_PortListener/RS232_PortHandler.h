@@ -1,124 +1,316 @@
-/*
-@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
-* @version 1.0
-* @since   09-07-2018
-* @Purpose: manages the RS232 port (status polling, reading, and writing)
-*/
-
-#include <mutex>
-
-#include "RS232_Util.h"
-
-namespace RS232
-{
-	class RS232_PortSubscriber;
-	using RS232_PortSubscriber_Ptr = std::shared_ptr<RS232_PortSubscriber>;
-
-	class RS232_PortHandler
-	{
-	public:
-		RS232_PortHandler(RS232_PortSubscriber_Ptr, RS232_PortParams_Ptr);
-		virtual ~RS232_PortHandler();
-
-		void write(const unsigned char*, unsigned int);
-		void close();
-
-		bool is_active() const { return m_bOpenSuccess; }
-
-		void init();
-
-		//starts running when the port becomes unavailable until it is available again!
-		void waitForPortToBecomeAvailable();
-
-	private:
-		void openPortHandler();
-
-		/* Serial Port Read Thread */
-		static DWORD WINAPI startReadThread(LPVOID lpV);
-		DWORD read();
-
-		/* Get and Display the COM port status (RLSD & RING & DSR & CTS) */
-		DWORD updatePinStatus();
-
-		/*returns the available COM ports from the Windows*/
-		std::vector<std::string> getComPortNames();
-
-		RS232_PortSubscriber_Ptr m_subscriber;
-		RS232_PortParams_Ptr m_portParams;
-		RS232_PinStatus m_pinStatus;
-
-		/*serial port handles*/
-		HANDLE	m_HSerialPort = NULL; //handle for serial port
-		HANDLE	m_HReadDone = NULL; //handle for serial port read finish notification
-		HANDLE	m_HReadThread = NULL; //handle for serial port read thread
-
-		/*flags to hold the status of port handling*/
-		bool m_bOpenSuccess;
-		bool m_ReadTerminated;
-		bool m_PortHandlerClosed;
-
-		/*to protect writing/reading processes from multiple access*/
-		std::mutex m_writeGuard;
-		std::mutex m_readGuard;
-
-		/*to buffer the received data from the serial port*/
-		int m_BufferSize;
-		char* m_ReadData;
-		LPSTR m_LPReadData;
-
-		/*to protect the class from being copied*/
-		RS232_PortHandler(const RS232_PortHandler&) = delete;
-		RS232_PortHandler& operator=(const RS232_PortHandler&) = delete;
-		RS232_PortHandler(RS232_PortHandler&&) = delete;
-		RS232_PortHandler& operator=(RS232_PortHandler&) = delete;
-		/*to protect the class from being copied*/
-
-	};
-	using RS232_PortHandler_Ptr = std::shared_ptr<RS232_PortHandler>;
-
-	class RS232_PortSubscriber
-	{
-		friend class RS232_PortHandler;
-	public:
-		RS232_PortSubscriber() {};
-
-		virtual ~RS232_PortSubscriber() {};
-
-	protected:
-		//will be called by the RS232_PortHandler object upon receiving data
-		virtual void on_read(const unsigned char *readData, unsigned int dataLength) = 0;
-
-		//will be called when there happens an error in the serial port
-		virtual void on_socket_error(PortError portError) = 0;
-
-		//will be called when the serial port pin status changes
-		virtual void on_serialstate_changed(RS232_PinStatus pinStatus) = 0;
-
-		virtual void writeToPort(const unsigned char* data, unsigned int length) final
-		{
-			std::lock_guard<std::mutex> lock(m_guard);
-			if (m_portHandler.get())
-			{
-				int numOfSeparateWrites = length / m_bufferSize;
-				int leftOver = length % m_bufferSize;
-				for (int i = 0; i < numOfSeparateWrites; i++)
-				{
-					m_portHandler->write((data + (i*m_bufferSize)), m_bufferSize);
-				}
-				m_portHandler->write((data + (numOfSeparateWrites*m_bufferSize)), leftOver);
-			}
-		}
-
-		virtual void writeToPort(const std::string& str) final
-		{
-			this->writeToPort((const unsigned char *)str.c_str(), str.size());
-		}
-
-		RS232_PortHandler_Ptr m_portHandler;
-		std::mutex m_guard;
-		unsigned int m_bufferSize;
-
-	};
-
-}
-
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   09-07-2018
+* @Purpose: manages the RS232 port (status polling, reading, and writing)
+*/
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "RS232_Util.h"
+
+namespace RS232
+{
+	class RS232_PortSubscriber;
+	using RS232_PortSubscriber_Ptr = std::shared_ptr<RS232_PortSubscriber>;
+
+	/*immutable once published, a change creates a new list which is swapped in atomically*/
+	using RS232_SubscriberList = std::vector<RS232_PortSubscriber_Ptr>;
+	using RS232_SubscriberList_Ptr = std::shared_ptr<const RS232_SubscriberList>;
+
+	/*read batching counters of a port*/
+	struct RS232_ReadStats
+	{
+		unsigned long long m_totalReads = 0;
+		unsigned long long m_totalBytes = 0;
+		double m_readsPerSecond = 0.0; //over the last completed measurement window
+		double m_averageBatchSize = 0.0; //bytes per read over the last completed measurement window
+		unsigned int m_currentBatchTarget = 0; //bytes the next read waits for
+		unsigned int m_readBufferSize = 0; //largest read, grown when the input queue is deeper
+		unsigned int m_driverQueueSize = 0; //driver input queue requested by SetupComm, grown on overflows
+		unsigned int m_peakInQueue = 0; //deepest input queue seen before a read
+	};
+
+	/*line & driver errors of a port reported by ClearCommError, per class*/
+	struct RS232_ErrorStats
+	{
+		unsigned long long m_overruns = 0; //CE_OVERRUN: a char arrived before the UART was read, it is lost
+		unsigned long long m_rxOverflows = 0; //CE_RXOVER: the driver input queue was full, a char is lost
+		unsigned long long m_parityErrors = 0; //CE_RXPARITY
+		unsigned long long m_framingErrors = 0; //CE_FRAME: no stop bit, i.e. a baud rate mismatch or noise
+		unsigned long long m_breaks = 0; //CE_BREAK: the line was held low longer than a char
+	};
+
+	/*flow control counters of a port*/
+	struct RS232_FlowStats
+	{
+		unsigned long long m_inputThrottles = 0; //the sender was stopped at the high watermark of the receive queue
+		unsigned long long m_inputThrottledMicros = 0; //time the sender was kept stopped, the current stop included
+		bool m_inputThrottled = false;
+	};
+
+	/*line driver control of a half duplex (RS-485) port*/
+	struct RS232_RtsToggleStats
+	{
+		bool m_driverToggle = false; //RTS is toggled by the driver (RTS_CONTROL_TOGGLE), the counters below stay 0
+		unsigned long long m_toggles = 0; //writes framed by RTS
+		double m_averageReleaseMicros = 0.0; //from the last stop bit until RTS dropped, rtsGuard included
+		unsigned long long m_maxReleaseMicros = 0;
+	};
+
+	class RS232_PortHandler
+	{
+	public:
+		RS232_PortHandler(RS232_PortSubscriber_Ptr, RS232_PortParams_Ptr);
+		virtual ~RS232_PortHandler();
+
+		//false when the bytes could not be written (port closed, write failed or cancelled), the writer is told when they go out
+		bool write(const unsigned char*, unsigned int, RS232_PortSubscriber* writer = NULL);
+
+		/*
+		* gives the queued bytes txDrainTimeout to be sent (the rest is discarded & reported), then wakes up the reader & the reconnect thread
+		* & joins them; a closed handler is not opened again, a new one is created to restart the port
+		*/
+		void close();
+
+		bool is_active() const { return m_bOpenSuccess; }
+
+		RS232_ReadStats getReadStats() const;
+
+		RS232_FlowStats getFlowStats() const;
+
+		RS232_ErrorStats getErrorStats() const;
+
+		RS232_RtsToggleStats getRtsToggleStats() const;
+
+		//watermark flow control: stops (RTS off/XOFF) or releases (RTS on/XON) the sender
+		void throttleInput(bool throttle);
+
+		//bytes thrown away by close() because they could not be sent within txDrainTimeout
+		unsigned long long getDiscardedTxBytes() const { return m_discardedTxBytes; }
+
+		//reader & reconnect threads running in all handlers, a closed handler leaves none behind
+		static unsigned int getLiveThreadCount() { return m_liveThreads; }
+
+		/*
+		* any number of subscribers get the data, errors & pin changes of the port, they can be added/removed while the port is read;
+		* a removed subscriber may still get the callback the reader thread is dispatching at that moment
+		*/
+		void addSubscriber(RS232_PortSubscriber_Ptr subscriber);
+		void removeSubscriber(const RS232_PortSubscriber_Ptr& subscriber);
+
+		void init();
+
+		//starts a thread which opens the port as soon as it is available again, no-op if one is running or the handler is closed
+		void reconnect();
+
+		//applies the CPU affinity & priority of the port to the thread, warns & goes on without them when they are not permitted
+		static void applySchedulingParams(HANDLE thread, RS232_PortParams_Ptr portParams);
+
+		//priority class of the whole process (a global setting, not one of a port), warns when it is not permitted
+		static void applyPriorityClass(DWORD priorityClass);
+
+	private:
+		void openPortHandler();
+
+		//runs on the reconnect thread until the port is available again or close() is called
+		void waitForPortToBecomeAvailable();
+
+		//waits for the reader thread to exit, no-op when called by the reader itself
+		void joinReader();
+
+		void releaseHandles();
+
+		//waits until the driver has sent the queued bytes or the drain timeout is over
+		void drainTx();
+
+		//waits for the overlapped operation, cancels it when close() sets the stop event: WAIT_OBJECT_0, WAIT_TIMEOUT or WAIT_OBJECT_0 + 1
+		DWORD waitForIo(OVERLAPPED& overlapped, DWORD timeout);
+
+		//pre-faults the read buffer & locks it in physical memory, so the reader thread never waits for a page fault
+		void lockReadBuffer();
+
+		//RTS/CTS or XON/XOFF of the port, by the driver at its buffer thresholds or by the receive queue watermarks
+		void configureFlowControl(DCB& dcb);
+
+		//XonLim/XoffLim of the driver handshake: a quarter of the current input queue
+		WORD getHandshakeLimit();
+
+		//sets the handshake limits of a resized input queue on the current DCB, postponed while a write holds the line
+		void updateHandshakeLimits();
+
+		//HD_RTS: drops RTS once the bytes written at txStart are on the line
+		void releaseLineDriver(unsigned int length, std::chrono::steady_clock::time_point txStart);
+
+		//error counters of the classes reported by ClearCommError
+		void countCommErrors(DWORD errors);
+
+		/*adaptive receive buffers, on the reader thread between two reads*/
+		void adaptRxBuffers(DWORD errors, DWORD bytesInQueue);
+		bool resizeDriverQueue(DWORD size);
+		void growReadBuffer(DWORD size);
+
+		/* Serial Port Read Thread */
+		static DWORD WINAPI startReadThread(LPVOID lpV);
+		DWORD read();
+
+		/*adaptive read batching*/
+		DWORD getMaxBatch() const;
+		DWORD nextReadSize(DWORD bytesInQueue) const;
+		void onReadCompleted(DWORD bytesRequested, DWORD bytesRead);
+
+		/* Get and Display the COM port status (RLSD & RING & DSR & CTS) */
+		DWORD updatePinStatus();
+
+		/*returns the available COM ports from the Windows*/
+		std::vector<std::string> getComPortNames();
+
+		/*dispatch to all subscribers of the current list, without taking a lock*/
+		RS232_SubscriberList_Ptr getSubscribers() const { return std::atomic_load(&m_subscribers); }
+		void notifyError(PortError portError);
+
+		//the shortest idle timeout of the subscribers
+		DWORD getIdleTimeout() const;
+
+		RS232_SubscriberList_Ptr m_subscribers; //only accessed with std::atomic_load/std::atomic_store
+		std::mutex m_subscribersGuard; //serializes the writers of m_subscribers
+		RS232_PortParams_Ptr m_portParams;
+		RS232_PinStatus m_pinStatus;
+
+		/*serial port handles*/
+		HANDLE	m_HSerialPort = NULL; //handle for serial port
+		HANDLE	m_HStopEvent = NULL; //manual reset, set by close() to wake up the threads blocked on the port
+		HANDLE	m_HReadThread = NULL; //handle for serial port read thread
+		DWORD	m_readThreadId = 0;
+
+		/*flags to hold the status of port handling, read by the reader & reconnect threads*/
+		std::atomic<bool> m_bOpenSuccess;
+		std::atomic<bool> m_ReadTerminated;
+		std::atomic<bool> m_PortHandlerClosed;
+
+		/*reconnection after the port went away*/
+		std::mutex m_stateGuard; //serializes close() with the reconnect thread opening the port
+		std::thread m_reconnectThread;
+		bool m_reconnecting;
+
+		std::atomic<unsigned long long> m_discardedTxBytes;
+
+		/*flow control statistics*/
+		std::atomic<unsigned long long> m_inputThrottles;
+		std::atomic<unsigned long long> m_inputThrottledMicros;
+		std::atomic<long long> m_throttleStart; //steady_clock ticks of the current stop, 0 while the sender is released
+		std::mutex m_rtsGuard; //serializes throttleInput() with the DCB updates which re-apply the RTS mode
+		bool m_inputThrottled;
+
+		/*error statistics*/
+		std::atomic<unsigned long long> m_overruns;
+		std::atomic<unsigned long long> m_rxOverflows;
+		std::atomic<unsigned long long> m_parityErrors;
+		std::atomic<unsigned long long> m_framingErrors;
+		std::atomic<unsigned long long> m_breaks;
+		static std::atomic<unsigned int> m_liveThreads;
+
+		/*half duplex line driver control*/
+		std::atomic<bool> m_driverRtsToggle; //HD_AUTO until the driver refuses RTS_CONTROL_TOGGLE
+		std::atomic<unsigned long long> m_rtsToggles;
+		std::atomic<unsigned long long> m_totalRtsReleaseMicros;
+		std::atomic<unsigned long long> m_maxRtsReleaseMicros;
+
+		/*to protect writing/reading processes from multiple access*/
+		std::mutex m_writeGuard;
+		std::mutex m_readGuard;
+
+		/*to buffer the received data from the serial port*/
+		std::atomic<int> m_BufferSize;
+		std::atomic<DWORD> m_driverQueueSize; //0 until SetupComm is called, kept when the port is re-opened
+		std::atomic<DWORD> m_peakInQueue;
+		bool m_driverQueueResizable; //false once the driver refused SetupComm
+		bool m_handshakeLimitsPending; //the input queue was resized during a write, its handshake limits are set after it
+		char* m_ReadData;
+		LPSTR m_LPReadData;
+		bool m_readDataLocked;
+
+		/*read batching state & statistics*/
+		std::atomic<DWORD> m_readTarget;
+		std::atomic<unsigned long long> m_totalReads;
+		std::atomic<unsigned long long> m_totalReadBytes;
+		std::atomic<double> m_readsPerSecond;
+		std::atomic<double> m_averageBatchSize;
+		std::atomic<long long> m_statsWindowEnd; //steady_clock ticks of the last completed window
+		std::chrono::steady_clock::time_point m_statsWindowStart;
+		unsigned long long m_windowReads;
+		unsigned long long m_windowBytes;
+
+		/*to protect the class from being copied*/
+		RS232_PortHandler(const RS232_PortHandler&) = delete;
+		RS232_PortHandler& operator=(const RS232_PortHandler&) = delete;
+		RS232_PortHandler(RS232_PortHandler&&) = delete;
+		RS232_PortHandler& operator=(RS232_PortHandler&) = delete;
+		/*to protect the class from being copied*/
+
+	};
+	using RS232_PortHandler_Ptr = std::shared_ptr<RS232_PortHandler>;
+
+	class RS232_PortSubscriber
+	{
+		friend class RS232_PortHandler;
+	public:
+		RS232_PortSubscriber() {};
+
+		virtual ~RS232_PortSubscriber() {};
+
+	protected:
+		//will be called by the RS232_PortHandler object upon receiving data, readTime is taken as soon as the read returns
+		virtual void on_read(const unsigned char *readData, unsigned int dataLength, FrameTime readTime) = 0;
+
+		//will be called when there happens an error in the serial port
+		virtual void on_socket_error(PortError portError) = 0;
+
+		//will be called when the serial port pin status changes
+		virtual void on_serialstate_changed(RS232_PinStatus pinStatus) = 0;
+
+		//will be called when no data is received for getIdleTimeout() milliseconds
+		virtual void on_idle() {};
+
+		//line silence in milliseconds the subscriber wants to be notified about
+		virtual DWORD getIdleTimeout() const { return INFINITE; }
+
+		//will be called under the write lock of the port right before the bytes written by writeToPort() are handed to the driver
+		virtual void on_tx_start(const unsigned char* data, unsigned int length, FrameTime txStart) {};
+
+		//false when there is no port or a part of the data could not be written
+		virtual bool writeToPort(const unsigned char* data, unsigned int length) final
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			if (!m_portHandler.get())
+				return false;
+
+			bool written = true;
+			int numOfSeparateWrites = length / m_bufferSize;
+			int leftOver = length % m_bufferSize;
+			for (int i = 0; i < numOfSeparateWrites && written; i++)
+			{
+				written = m_portHandler->write((data + (i*m_bufferSize)), m_bufferSize, this);
+			}
+			return written && m_portHandler->write((data + (numOfSeparateWrites*m_bufferSize)), leftOver, this);
+		}
+
+		virtual bool writeToPort(const std::string& str) final
+		{
+			return this->writeToPort((const unsigned char *)str.c_str(), str.size());
+		}
+
+		RS232_PortHandler_Ptr m_portHandler;
+		std::mutex m_guard;
+		unsigned int m_bufferSize;
+
+	};
+
+}
+
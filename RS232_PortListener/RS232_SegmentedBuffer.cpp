@@ -0,0 +1,156 @@
+#include "RS232_SegmentedBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace RS232
+{
+	RS232_SegmentedBuffer::RS232_SegmentedBuffer(RS232_SegmentedBuffer&& other) :
+		m_segments(std::move(other.m_segments)),
+		m_size(other.m_size)
+	{
+		other.m_segments.clear();
+		other.m_size = 0;
+	}
+
+	RS232_SegmentedBuffer& RS232_SegmentedBuffer::operator=(RS232_SegmentedBuffer&& other)
+	{
+		if (this != &other)
+		{
+			m_segments = std::move(other.m_segments);
+			m_size = other.m_size;
+			other.m_segments.clear();
+			other.m_size = 0;
+		}
+		return *this;
+	}
+
+	RS232_SegmentedBuffer::RS232_SegmentedBuffer(const RS232_SegmentedBuffer& other) :
+		m_size(0)
+	{
+		*this = other;
+	}
+
+	RS232_SegmentedBuffer& RS232_SegmentedBuffer::operator=(const RS232_SegmentedBuffer& other)
+	{
+		if (this != &other)
+		{
+			clear();
+			for (const Segment& segment : other.m_segments)
+				append(segment.m_data.get(), segment.m_used);
+		}
+		return *this;
+	}
+
+	void RS232_SegmentedBuffer::append(const unsigned char* data, size_t length)
+	{
+		while (length > 0)
+		{
+			if (m_segments.empty() || m_segments.back().m_used == m_segments.back().m_capacity)
+			{
+				Segment segment;
+				segment.m_capacity = std::min(std::max(std::max(m_size, length), SEGMENT_MIN_SIZE), SEGMENT_MAX_SIZE);
+				segment.m_data.reset(new unsigned char[segment.m_capacity]);
+				segment.m_used = 0;
+				m_segments.push_back(std::move(segment));
+			}
+
+			Segment& segment = m_segments.back();
+			size_t chunk = std::min(length, segment.m_capacity - segment.m_used);
+			memcpy(segment.m_data.get() + segment.m_used, data, chunk);
+			segment.m_used += chunk;
+			m_size += chunk;
+			data += chunk;
+			length -= chunk;
+		}
+	}
+
+	void RS232_SegmentedBuffer::clear()
+	{
+		m_segments.clear();
+		m_size = 0;
+	}
+
+	size_t RS232_SegmentedBuffer::capacity() const
+	{
+		size_t capacity = 0;
+		for (const Segment& segment : m_segments)
+			capacity += segment.m_capacity;
+		return capacity;
+	}
+
+	unsigned char RS232_SegmentedBuffer::back() const
+	{
+		const Segment& segment = m_segments.back();
+		return segment.m_data[segment.m_used - 1];
+	}
+
+	void RS232_SegmentedBuffer::truncate(size_t length)
+	{
+		length = std::min(length, m_size);
+		m_size -= length;
+		while (length > 0)
+		{
+			Segment& segment = m_segments.back();
+			size_t chunk = std::min(length, segment.m_used);
+			segment.m_used -= chunk;
+			length -= chunk;
+			if (segment.m_used == 0)
+				m_segments.pop_back();
+		}
+	}
+
+	size_t RS232_SegmentedBuffer::copyTo(unsigned char* out, size_t offset, size_t length) const
+	{
+		size_t copied = 0;
+		for (const Segment& segment : m_segments)
+		{
+			if (copied == length)
+				break;
+			if (offset >= segment.m_used)
+			{
+				offset -= segment.m_used;
+				continue;
+			}
+			size_t chunk = std::min(length - copied, segment.m_used - offset);
+			memcpy(out + copied, segment.m_data.get() + offset, chunk);
+			copied += chunk;
+			offset = 0;
+		}
+		return copied;
+	}
+
+	RS232_BufferView RS232_SegmentedBuffer::getContiguous(std::string& scratch) const
+	{
+		if (m_segments.size() == 1)
+			return getSegment(0);
+
+		scratch.resize(m_size);
+		if (m_size > 0)
+			copyTo((unsigned char*)&scratch[0], 0, m_size);
+		return { (const unsigned char*)scratch.data(), m_size };
+	}
+
+	std::string RS232_SegmentedBuffer::toString() const
+	{
+		std::string str(m_size, '\0');
+		if (m_size > 0)
+			copyTo((unsigned char*)&str[0], 0, m_size);
+		return str;
+	}
+
+	size_t RS232_SegmentedBuffer::findFirstNotInRange(unsigned char low, unsigned char high) const
+	{
+		size_t position = 0;
+		for (const Segment& segment : m_segments)
+		{
+			for (size_t i = 0; i < segment.m_used; i++)
+			{
+				if (segment.m_data[i] < low || segment.m_data[i] > high)
+					return position + i;
+			}
+			position += segment.m_used;
+		}
+		return npos;
+	}
+}
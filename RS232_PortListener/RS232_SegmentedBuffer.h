@@ -0,0 +1,94 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: byte buffer kept as a chain of segments which are never reallocated, read back segment by segment (scatter-gather)
+*/
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace RS232
+{
+	constexpr size_t SEGMENT_MIN_SIZE = 256; //the first segment, enough for most frames
+	constexpr size_t SEGMENT_MAX_SIZE = 4096; //the segments of a large frame
+
+	/*a contiguous part of a segmented buffer*/
+	struct RS232_BufferView
+	{
+		const unsigned char* m_data;
+		size_t m_length;
+	};
+
+	/*
+	* append() fills the last segment & chains a new one when it is full, the new segment is as large as the buffer so far
+	* (between SEGMENT_MIN_SIZE & SEGMENT_MAX_SIZE), so a byte is never copied again once it is appended
+	* moving the buffer hands the segments over without copying the bytes
+	*/
+	class RS232_SegmentedBuffer
+	{
+	public:
+		RS232_SegmentedBuffer() : m_size(0) {}
+
+		RS232_SegmentedBuffer(RS232_SegmentedBuffer&& other);
+		RS232_SegmentedBuffer& operator=(RS232_SegmentedBuffer&& other);
+
+		//deep copy, only for the consumers which keep a frame beyond its delivery
+		RS232_SegmentedBuffer(const RS232_SegmentedBuffer& other);
+		RS232_SegmentedBuffer& operator=(const RS232_SegmentedBuffer& other);
+
+		void append(const unsigned char* data, size_t length);
+
+		void assign(const char* data, size_t length)
+		{
+			clear();
+			append((const unsigned char*)data, length);
+		}
+
+		size_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+
+		//bytes allocated by the segments, a small frame still holds a whole SEGMENT_MIN_SIZE segment
+		size_t capacity() const;
+
+		//releases the segments
+		void clear();
+
+		unsigned char back() const;
+
+		//drops the last length bytes (i.e. a trailing CR or checksum)
+		void truncate(size_t length);
+
+		size_t getSegmentCount() const { return m_segments.size(); }
+
+		//the used part of the segment, only the last one may be partly filled
+		RS232_BufferView getSegment(size_t index) const { return { m_segments[index].m_data.get(), m_segments[index].m_used }; }
+
+		//copies length bytes starting at offset to out, returns the copied byte count
+		size_t copyTo(unsigned char* out, size_t offset, size_t length) const;
+
+		//single segment: a view of it, otherwise the bytes are gathered into scratch
+		RS232_BufferView getContiguous(std::string& scratch) const;
+
+		std::string toString() const;
+
+		//position of the first byte which is not in [low, high], npos if there is none
+		size_t findFirstNotInRange(unsigned char low, unsigned char high) const;
+
+		static constexpr size_t npos = (size_t)-1;
+
+	private:
+		struct Segment
+		{
+			std::unique_ptr<unsigned char[]> m_data;
+			size_t m_capacity;
+			size_t m_used;
+		};
+
+		std::vector<Segment> m_segments;
+		size_t m_size;
+	};
+}
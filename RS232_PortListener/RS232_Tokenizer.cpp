@@ -0,0 +1,144 @@
+#include "RS232_Tokenizer.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define RS232_TOKENIZER_SIMD
+#include <tmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define RS232_SSSE3_TARGET
+#else
+#include <cpuid.h>
+#define RS232_SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+#endif
+
+namespace RS232
+{
+#ifdef RS232_TOKENIZER_SIMD
+	static bool hasSSSE3()
+	{
+#if defined(_MSC_VER)
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 1);
+		return (cpuInfo[2] & (1 << 9)) != 0;
+#else
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+			return false;
+		return (ecx & (1 << 9)) != 0;
+#endif
+	}
+
+	static const bool s_useSSSE3 = hasSSSE3();
+#endif
+
+	DelimiterSet::DelimiterSet() :
+		m_count(0)
+	{
+		memset(m_mask, 0, sizeof(m_mask));
+		memset(m_lowRows, 0, sizeof(m_lowRows));
+		memset(m_highRows, 0, sizeof(m_highRows));
+	}
+
+	DelimiterSet::DelimiterSet(const std::string& delims) :
+		DelimiterSet()
+	{
+		for (unsigned char ch : delims)
+		{
+			if (contains(ch))
+				continue;
+			m_mask[ch >> 6] |= (uint64_t)1 << (ch & 0x3F);
+			if ((ch >> 4) < 8)
+				m_lowRows[ch & 0x0F] |= (uint8_t)(1 << (ch >> 4));
+			else
+				m_highRows[ch & 0x0F] |= (uint8_t)(1 << ((ch >> 4) - 8));
+			m_count++;
+		}
+	}
+
+	size_t DelimiterSet::findFirst(const char* data, size_t length) const
+	{
+		if (m_count == 0)
+			return length;
+#ifdef RS232_TOKENIZER_SIMD
+		if (s_useSSSE3 && length >= 16)
+			return findFirstSimd(data, length);
+#endif
+		return findFirstScalar(data, length);
+	}
+
+	size_t DelimiterSet::findFirstScalar(const char* data, size_t length) const
+	{
+		for (size_t i = 0; i < length; i++)
+			if (contains((unsigned char)data[i]))
+				return i;
+		return length;
+	}
+
+#ifdef RS232_TOKENIZER_SIMD
+	RS232_SSSE3_TARGET size_t DelimiterSet::findFirstSimd(const char* data, size_t length) const
+	{
+		const __m128i lowRows = _mm_load_si128((const __m128i*)m_lowRows);
+		const __m128i highRows = _mm_load_si128((const __m128i*)m_highRows);
+		const __m128i bitOfNibble = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+		const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+		const __m128i seven = _mm_set1_epi8(7);
+
+		size_t i = 0;
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+			__m128i lowNibble = _mm_and_si128(block, nibbleMask);
+			__m128i highNibble = _mm_and_si128(_mm_srli_epi16(block, 4), nibbleMask);
+
+			//select the row of the high nibble half, then test the bit of the high nibble in it
+			__m128i isUpperHalf = _mm_cmpgt_epi8(highNibble, seven);
+			__m128i row = _mm_or_si128(
+				_mm_and_si128(isUpperHalf, _mm_shuffle_epi8(highRows, lowNibble)),
+				_mm_andnot_si128(isUpperHalf, _mm_shuffle_epi8(lowRows, lowNibble)));
+			__m128i bit = _mm_shuffle_epi8(bitOfNibble, highNibble);
+			int hits = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), bit));
+			if (hits)
+			{
+				unsigned long pos = 0;
+#if defined(_MSC_VER)
+				_BitScanForward(&pos, (unsigned long)hits);
+#else
+				pos = __builtin_ctz((unsigned int)hits);
+#endif
+				return i + pos;
+			}
+		}
+		return i + findFirstScalar(data + i, length - i);
+	}
+#else
+	size_t DelimiterSet::findFirstSimd(const char* data, size_t length) const
+	{
+		return findFirstScalar(data, length);
+	}
+#endif
+
+	TrackTokenizer::TrackTokenizer(const DelimiterSet& delims, const char* data, size_t length) :
+		m_delims(delims),
+		m_pos(data),
+		m_end(data + length)
+	{
+	}
+
+	bool TrackTokenizer::next(boost::string_view& token)
+	{
+		//consecutive delimeters would produce empty tokens, skip over them
+		while (m_pos < m_end && m_delims.contains((unsigned char)*m_pos))
+			m_pos++;
+
+		if (m_pos == m_end)
+			return false;
+
+		size_t tokenLength = m_delims.findFirst(m_pos, m_end - m_pos);
+		token = boost::string_view(m_pos, tokenLength);
+		m_pos += tokenLength;
+		return true;
+	}
+}
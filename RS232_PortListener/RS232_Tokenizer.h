@@ -0,0 +1,60 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: splits received track data into tokens without copying or allocating
+*/
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include <boost/utility/string_view.hpp>
+
+namespace RS232
+{
+	/*256-bit membership mask of the delimeter bytes of a dataControl type*/
+	class DelimiterSet
+	{
+	public:
+		DelimiterSet();
+		explicit DelimiterSet(const std::string& delims);
+
+		bool contains(unsigned char ch) const
+		{
+			return ((m_mask[ch >> 6] >> (ch & 0x3F)) & 1) != 0;
+		}
+
+		bool empty() const { return m_count == 0; }
+
+		//returns the position of the first delimeter byte in data, length if there is none
+		size_t findFirst(const char* data, size_t length) const;
+
+	private:
+		size_t findFirstScalar(const char* data, size_t length) const;
+		size_t findFirstSimd(const char* data, size_t length) const;
+
+		uint64_t m_mask[4];
+		unsigned int m_count;
+
+		/*pshufb lookup rows indexed by the low nibble, one bit per high nibble (0-7 & 8-15)*/
+		alignas(16) uint8_t m_lowRows[16];
+		alignas(16) uint8_t m_highRows[16];
+	};
+
+	/*yields the non-empty tokens of a frame as views over the frame itself*/
+	class TrackTokenizer
+	{
+	public:
+		TrackTokenizer(const DelimiterSet& delims, const char* data, size_t length);
+
+		//returns false when there is no token left
+		bool next(boost::string_view& token);
+
+	private:
+		const DelimiterSet& m_delims;
+		const char* m_pos;
+		const char* m_end;
+	};
+}
@@ -0,0 +1,467 @@
+#include "RS232_TrafficLogger.h"
+
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+#include <compressapi.h>
+#pragma comment(lib, "Cabinet.lib")
+
+namespace RS232
+{
+	constexpr unsigned int TRAFFIC_LOG_BUFFER_COUNT = 8;
+	constexpr size_t TRAFFIC_LOG_BUFFER_SIZE = 256 * 1024;
+	constexpr unsigned int TRAFFIC_LOG_RECORD_PAYLOAD = 2048; //longer chunks are split into several records
+	constexpr unsigned int TRAFFIC_LOG_BYTES_PER_LINE = 16;
+	constexpr unsigned int TRAFFIC_LOG_LINE_SIZE = 80; //"  " offset(8) "  " 16 * "XX " " |" 16 * ascii "|\n"
+	constexpr unsigned int TRAFFIC_LOG_HEADER_SIZE = 64; //without the port name
+	constexpr unsigned int TRAFFIC_LOG_FLUSH_INTERVAL = 1000; //milliseconds
+	constexpr unsigned int TRAFFIC_LOG_REOPEN_INTERVAL = 5000; //milliseconds between the attempts to open a log file after a failure
+	constexpr auto TRAFFIC_LOG_FILE_PREFIX = "rs232_traffic_";
+	constexpr auto TRAFFIC_LOG_FILE_EXTENSION = ".log";
+	constexpr auto TRAFFIC_LOG_COMPRESSED_EXTENSION = ".xph";
+
+	/*"XX " of every byte value & the character shown in the ASCII column*/
+	struct HexTable
+	{
+		char m_hex[256][3];
+		char m_ascii[256];
+
+		HexTable()
+		{
+			const char* digits = "0123456789ABCDEF";
+			for (unsigned int i = 0; i < 256; i++)
+			{
+				m_hex[i][0] = digits[i >> 4];
+				m_hex[i][1] = digits[i & 0x0F];
+				m_hex[i][2] = ' ';
+				m_ascii[i] = (i >= 0x20 && i < 0x7F) ? (char)i : '.';
+			}
+		}
+	};
+	static const HexTable hexTable;
+
+	static size_t maxRecordSize(size_t portNameLength, unsigned int length)
+	{
+		return TRAFFIC_LOG_HEADER_SIZE + portNameLength + ((length + TRAFFIC_LOG_BYTES_PER_LINE - 1) / TRAFFIC_LOG_BYTES_PER_LINE) * TRAFFIC_LOG_LINE_SIZE;
+	}
+
+	/*records of the current log() call, formatted outside the lock*/
+	thread_local std::vector<char> formattedRecords;
+	thread_local std::vector<size_t> formattedSizes;
+
+	/*wall clock text of the current second, formatted once per second by each logging thread*/
+	thread_local long long cachedSecond = -1;
+	thread_local char cachedTime[20];
+
+	static char* putDecimal(char* out, unsigned long long value, unsigned int minDigits)
+	{
+		char digits[20];
+		unsigned int count = 0;
+		do
+		{
+			digits[count++] = (char)('0' + value % 10);
+			value /= 10;
+		} while (value > 0 || count < minDigits);
+		while (count > 0)
+			*out++ = digits[--count];
+		return out;
+	}
+
+	RS232_TrafficLogger_Ptr RS232_TrafficLogger::m_instance = nullptr;
+
+	RS232_TrafficLogger_Ptr& RS232_TrafficLogger::getInstance()
+	{
+		if (m_instance == nullptr)
+			m_instance = std::unique_ptr<RS232_TrafficLogger>(new RS232_TrafficLogger());
+		return m_instance;
+	}
+
+	RS232_TrafficLogger::RS232_TrafficLogger() :
+		m_open(false),
+		m_closing(false),
+		m_fileSize(0),
+		m_fileIndex(0)
+	{
+	}
+
+	RS232_TrafficLogger::~RS232_TrafficLogger()
+	{
+		close();
+	}
+
+	bool RS232_TrafficLogger::open(RS232_TrafficLogParams_Ptr trafficLogParams)
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		if (m_open)
+			return true;
+
+		m_trafficLogParams = trafficLogParams;
+		if (!CreateDirectoryA(m_trafficLogParams->m_directory.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+		{
+			std::cout << "RS232_TrafficLogger::open() -> cannot create traffic log directory " << m_trafficLogParams->m_directory << std::endl;
+			return false;
+		}
+
+		m_stats = RS232_TrafficLogStats();
+		m_freeBuffers.clear();
+		m_fullBuffers.clear();
+		for (unsigned int i = 0; i < TRAFFIC_LOG_BUFFER_COUNT; i++)
+		{
+			LogBuffer_Ptr buffer(new LogBuffer());
+			buffer->m_data.reset(new char[TRAFFIC_LOG_BUFFER_SIZE]);
+			m_freeBuffers.push_back(std::move(buffer));
+		}
+		m_current = std::move(m_freeBuffers.back());
+		m_freeBuffers.pop_back();
+
+		if (!openFile())
+			return false;
+
+		m_closing = false;
+		m_open = true;
+		m_writerThread = std::thread(&RS232_TrafficLogger::writeLoop, this);
+		std::cout << "RS232_TrafficLogger::open() -> logging the traffic to " << m_filePath << std::endl;
+		return true;
+	}
+
+	void RS232_TrafficLogger::close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_guard);
+			if (!m_open)
+				return;
+			m_open = false;
+			m_closing = true;
+			m_bufferFull.notify_one();
+		}
+
+		if (m_writerThread.joinable())
+			m_writerThread.join();
+		bool compressed = closeFile();
+
+		std::lock_guard<std::mutex> lock(m_guard);
+		if (compressed)
+			m_stats.m_compressedFiles++;
+		m_closing = false;
+	}
+
+	void RS232_TrafficLogger::log(TrafficDirection direction, const std::string& portName, const unsigned char* data, unsigned int length)
+	{
+		if (!m_open || length == 0)
+			return;
+
+		/*the hex dump is about 5 times the traffic, it is formatted before the lock so the port threads only serialize on the copy*/
+		unsigned int recordCount = (length + TRAFFIC_LOG_RECORD_PAYLOAD - 1) / TRAFFIC_LOG_RECORD_PAYLOAD;
+		size_t capacity = (size_t)recordCount * maxRecordSize(portName.size(), TRAFFIC_LOG_RECORD_PAYLOAD);
+		if (formattedRecords.size() < capacity)
+			formattedRecords.resize(capacity);
+		formattedSizes.clear();
+		size_t formattedBytes = 0;
+		for (unsigned int offset = 0; offset < length; offset += TRAFFIC_LOG_RECORD_PAYLOAD)
+		{
+			unsigned int recordLength = std::min(length - offset, TRAFFIC_LOG_RECORD_PAYLOAD);
+			formattedSizes.push_back(formatRecord(formattedRecords.data() + formattedBytes, direction, portName, length, offset, data + offset, recordLength));
+			formattedBytes += formattedSizes.back();
+		}
+
+		std::lock_guard<std::mutex> lock(m_guard);
+		if (!m_open)
+			return;
+
+		size_t recordOffset = 0;
+		for (unsigned int i = 0; i < recordCount; i++)
+		{
+			const char* record = formattedRecords.data() + recordOffset;
+			size_t recordSize = formattedSizes[i];
+			unsigned int recordLength = std::min(length - i * TRAFFIC_LOG_RECORD_PAYLOAD, TRAFFIC_LOG_RECORD_PAYLOAD);
+			recordOffset += recordSize;
+			if (m_current.get() && m_current->m_used + recordSize > TRAFFIC_LOG_BUFFER_SIZE)
+			{
+				m_fullBuffers.push_back(std::move(m_current));
+				m_bufferFull.notify_one();
+			}
+			if (!m_current.get() && !m_freeBuffers.empty())
+			{
+				m_current = std::move(m_freeBuffers.back());
+				m_freeBuffers.pop_back();
+			}
+			if (!m_current.get())
+			{
+				m_stats.m_droppedRecords++; //the writer is behind, the port threads are not held up
+				continue;
+			}
+
+			memcpy(m_current->m_data.get() + m_current->m_used, record, recordSize);
+			m_current->m_used += recordSize;
+			m_stats.m_loggedRecords++;
+			m_stats.m_loggedBytes += recordLength;
+		}
+	}
+
+	RS232_TrafficLogStats RS232_TrafficLogger::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		return m_stats;
+	}
+
+	size_t RS232_TrafficLogger::formatRecord(char* out, TrafficDirection direction, const std::string& portName, unsigned int totalLength,
+		unsigned int offset, const unsigned char* data, unsigned int length)
+	{
+		char* begin = out;
+
+		/*header: "YYYY-MM-DD HH:MM:SS.uuuuuu COM7 RX 1234 bytes"*/
+		long long micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		long long second = micros / 1000000;
+		if (second != cachedSecond)
+		{
+			time_t now = (time_t)second;
+			struct tm localTime;
+			localtime_s(&localTime, &now);
+			strftime(cachedTime, sizeof(cachedTime), "%Y-%m-%d %H:%M:%S", &localTime);
+			cachedSecond = second;
+		}
+		memcpy(out, cachedTime, 19);
+		out += 19;
+		*out++ = '.';
+		out = putDecimal(out, micros % 1000000, 6);
+		*out++ = ' ';
+		memcpy(out, portName.data(), portName.size());
+		out += portName.size();
+		memcpy(out, direction == TD_RX ? " RX " : " TX ", 4);
+		out += 4;
+		out = putDecimal(out, totalLength, 1);
+		memcpy(out, " bytes\n", 7);
+		out += 7;
+
+		/*lines: "  00000010  30 31 ... 3F  |0123456789:;<=>?|"*/
+		for (unsigned int lineStart = 0; lineStart < length; lineStart += TRAFFIC_LOG_BYTES_PER_LINE)
+		{
+			unsigned int lineOffset = offset + lineStart;
+			unsigned int lineLength = std::min(length - lineStart, TRAFFIC_LOG_BYTES_PER_LINE);
+
+			*out++ = ' ';
+			*out++ = ' ';
+			for (int shift = 24; shift >= 0; shift -= 8)
+			{
+				memcpy(out, hexTable.m_hex[(lineOffset >> shift) & 0xFF], 2);
+				out += 2;
+			}
+			*out++ = ' ';
+			*out++ = ' ';
+			for (unsigned int i = 0; i < lineLength; i++)
+			{
+				memcpy(out, hexTable.m_hex[data[lineStart + i]], 3);
+				out += 3;
+			}
+			memset(out, ' ', (TRAFFIC_LOG_BYTES_PER_LINE - lineLength) * 3);
+			out += (TRAFFIC_LOG_BYTES_PER_LINE - lineLength) * 3;
+			*out++ = ' ';
+			*out++ = '|';
+			for (unsigned int i = 0; i < lineLength; i++)
+				*out++ = hexTable.m_ascii[data[lineStart + i]];
+			*out++ = '|';
+			*out++ = '\n';
+		}
+		return out - begin;
+	}
+
+	void RS232_TrafficLogger::writeLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_guard);
+		while (true)
+		{
+			m_bufferFull.wait_for(lock, std::chrono::milliseconds(TRAFFIC_LOG_FLUSH_INTERVAL), [&]() { return m_closing || !m_fullBuffers.empty(); });
+
+			//a partly filled buffer is written once per interval so the file never lags far behind the line
+			if (m_fullBuffers.empty() && m_current.get() && m_current->m_used > 0)
+				m_fullBuffers.push_back(std::move(m_current));
+			bool closing = m_closing;
+			if (closing && m_current.get() && m_current->m_used > 0)
+				m_fullBuffers.push_back(std::move(m_current));
+
+			std::deque<LogBuffer_Ptr> buffers;
+			buffers.swap(m_fullBuffers);
+			lock.unlock();
+
+			unsigned long long writtenBytes = 0;
+			unsigned long long rotatedFiles = 0;
+			unsigned long long compressedFiles = 0;
+			unsigned long long openFailures = 0;
+			unsigned long long discardedBytes = 0;
+
+			//a failed open or write does not end the log, a new file is tried every few seconds
+			if (!m_file.is_open() && !buffers.empty() && std::chrono::steady_clock::now() >= m_nextOpenAttempt)
+			{
+				if (openFile())
+					std::cout << "RS232_TrafficLogger::writeLoop() -> logging the traffic to " << m_filePath << " again" << std::endl;
+				else
+					openFailures++;
+			}
+
+			for (LogBuffer_Ptr& buffer : buffers)
+			{
+				if (m_file.is_open())
+				{
+					m_file.write(buffer->m_data.get(), buffer->m_used);
+					m_fileSize += buffer->m_used;
+					if (m_file)
+						writtenBytes += buffer->m_used;
+					else
+					{
+						std::cout << "RS232_TrafficLogger::writeLoop() -> cannot write " << m_filePath << ", the traffic is discarded until a new file can be opened" << std::endl;
+						compressedFiles += closeFile() ? 1 : 0;
+						m_nextOpenAttempt = std::chrono::steady_clock::now() + std::chrono::milliseconds(TRAFFIC_LOG_REOPEN_INTERVAL);
+						openFailures++;
+					}
+				}
+				else
+					discardedBytes += buffer->m_used;
+				buffer->m_used = 0;
+
+				if (m_file.is_open() && m_fileSize >= m_trafficLogParams->m_maxFileSize)
+				{
+					compressedFiles += closeFile() ? 1 : 0;
+					if (openFile())
+						rotatedFiles++;
+					else
+						openFailures++;
+				}
+			}
+			if (m_file.is_open())
+				m_file.flush();
+			if (!closing && m_file.is_open() && m_fileSize > 0 && m_trafficLogParams->m_rotateIntervalSeconds > 0 &&
+				std::chrono::steady_clock::now() - m_fileOpened >= std::chrono::seconds(m_trafficLogParams->m_rotateIntervalSeconds))
+			{
+				compressedFiles += closeFile() ? 1 : 0;
+				if (openFile())
+					rotatedFiles++;
+				else
+					openFailures++;
+			}
+
+			lock.lock();
+			m_stats.m_writtenBytes += writtenBytes;
+			m_stats.m_rotatedFiles += rotatedFiles;
+			m_stats.m_compressedFiles += compressedFiles;
+			m_stats.m_openFailures += openFailures;
+			m_stats.m_discardedBytes += discardedBytes;
+			for (LogBuffer_Ptr& buffer : buffers)
+				m_freeBuffers.push_back(std::move(buffer));
+			if (closing)
+				return;
+		}
+	}
+
+	bool RS232_TrafficLogger::openFile()
+	{
+		time_t now = time(NULL);
+		struct tm localTime;
+		localtime_s(&localTime, &now);
+		char timeText[16];
+		strftime(timeText, sizeof(timeText), "%Y%m%d_%H%M%S", &localTime);
+
+		//the index keeps the files apart when several are opened within a second
+		std::ostringstream o_str;
+		o_str << m_trafficLogParams->m_directory << "/" << TRAFFIC_LOG_FILE_PREFIX << timeText << "_" << std::setw(4) << std::setfill('0') << m_fileIndex++ << TRAFFIC_LOG_FILE_EXTENSION;
+		m_filePath = o_str.str();
+		m_fileSize = 0;
+		m_fileOpened = std::chrono::steady_clock::now();
+
+		m_file.clear();
+		m_file.open(m_filePath, std::ios::binary | std::ios::out | std::ios::trunc);
+		if (!m_file.is_open())
+		{
+			std::cout << "RS232_TrafficLogger::openFile() -> cannot open " << m_filePath << ", retrying in " << TRAFFIC_LOG_REOPEN_INTERVAL / 1000 << " seconds" << std::endl;
+			m_nextOpenAttempt = m_fileOpened + std::chrono::milliseconds(TRAFFIC_LOG_REOPEN_INTERVAL);
+			return false;
+		}
+		return true;
+	}
+
+	bool RS232_TrafficLogger::closeFile()
+	{
+		if (!m_file.is_open())
+			return false;
+		m_file.close();
+		if (m_fileSize == 0)
+		{
+			DeleteFileA(m_filePath.c_str());
+			return false;
+		}
+		return m_trafficLogParams->m_compress && compressFile(m_filePath);
+	}
+
+	bool RS232_TrafficLogger::compressFile(const std::string& path)
+	{
+		std::ifstream input(path, std::ios::binary);
+		std::vector<char> plain((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+		input.close();
+
+		COMPRESSOR_HANDLE compressor = NULL;
+		if (!CreateCompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, NULL, &compressor))
+		{
+			std::cout << "RS232_TrafficLogger::compressFile() -> CreateCompressor failed, " << path << " is kept uncompressed" << std::endl;
+			return false;
+		}
+
+		SIZE_T compressedSize = 0;
+		Compress(compressor, plain.data(), plain.size(), NULL, 0, &compressedSize); //queries the size of the output
+		std::vector<char> compressed(compressedSize);
+		bool result = compressedSize > 0 && Compress(compressor, plain.data(), plain.size(), compressed.data(), compressed.size(), &compressedSize);
+		CloseCompressor(compressor);
+		if (!result)
+		{
+			std::cout << "RS232_TrafficLogger::compressFile() -> Compress failed, " << path << " is kept uncompressed" << std::endl;
+			return false;
+		}
+
+		std::ofstream output(path + TRAFFIC_LOG_COMPRESSED_EXTENSION, std::ios::binary | std::ios::trunc);
+		if (!output.write(compressed.data(), compressedSize))
+		{
+			std::cout << "RS232_TrafficLogger::compressFile() -> cannot write " << path << TRAFFIC_LOG_COMPRESSED_EXTENSION << std::endl;
+			return false;
+		}
+		output.close();
+		DeleteFileA(path.c_str());
+		return true;
+	}
+
+	bool RS232_TrafficLogger::unpackFile(const std::string& compressedPath, const std::string& outputPath)
+	{
+		std::ifstream input(compressedPath, std::ios::binary);
+		if (!input.is_open())
+		{
+			std::cout << "RS232_TrafficLogger::unpackFile() -> cannot open " << compressedPath << std::endl;
+			return false;
+		}
+		std::vector<char> compressed((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+		DECOMPRESSOR_HANDLE decompressor = NULL;
+		if (!CreateDecompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, NULL, &decompressor))
+		{
+			std::cout << "RS232_TrafficLogger::unpackFile() -> CreateDecompressor failed" << std::endl;
+			return false;
+		}
+
+		SIZE_T plainSize = 0;
+		Decompress(decompressor, compressed.data(), compressed.size(), NULL, 0, &plainSize); //the size is stored in the compressed buffer
+		std::vector<char> plain(plainSize);
+		bool result = plainSize > 0 && Decompress(decompressor, compressed.data(), compressed.size(), plain.data(), plain.size(), &plainSize);
+		CloseDecompressor(decompressor);
+		if (!result)
+		{
+			std::cout << "RS232_TrafficLogger::unpackFile() -> " << compressedPath << " is not a compressed traffic log" << std::endl;
+			return false;
+		}
+
+		std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+		if (!output.write(plain.data(), plainSize))
+		{
+			std::cout << "RS232_TrafficLogger::unpackFile() -> cannot write " << outputPath << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: hex dump log of the RX/TX traffic of all ports, written by a background thread into rotated (optionally compressed) files
+*/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RS232_Util.h"
+
+namespace RS232
+{
+	enum TrafficDirection
+	{
+		TD_RX,	//raw bytes read from the port
+		TD_TX	//encapsulated message written to the port
+	};
+
+	/*traffic log counters*/
+	struct RS232_TrafficLogStats
+	{
+		unsigned long long m_loggedRecords = 0;
+		unsigned long long m_loggedBytes = 0; //traffic bytes, not the hex dump
+		unsigned long long m_droppedRecords = 0; //all buffers were waiting for the writer
+		unsigned long long m_writtenBytes = 0; //hex dump written to the files
+		unsigned long long m_rotatedFiles = 0;
+		unsigned long long m_compressedFiles = 0;
+		unsigned long long m_openFailures = 0; //a log file could not be opened or written, retried every few seconds
+		unsigned long long m_discardedBytes = 0; //hex dump thrown away while no log file was open
+	};
+
+	class RS232_TrafficLogger;
+	using RS232_TrafficLogger_Ptr = std::unique_ptr<RS232_TrafficLogger>;
+
+	/*
+	* log() formats the hex dump on the calling thread & only copies it into one of a few preallocated buffers under the lock,
+	* it never waits for the disk, the writer thread takes a buffer once it is full or at the latest every second
+	*/
+	class RS232_TrafficLogger final
+	{
+	public:
+		static RS232_TrafficLogger_Ptr& getInstance();
+
+		virtual ~RS232_TrafficLogger();
+
+		//allocates the buffers & starts the writer thread
+		bool open(RS232_TrafficLogParams_Ptr trafficLogParams);
+
+		//writes the buffered records & closes (and compresses) the current file
+		void close();
+
+		bool isOpen() const { return m_open; }
+
+		//no-op while the log is closed, the record is dropped when no buffer is free
+		void log(TrafficDirection direction, const std::string& portName, const unsigned char* data, unsigned int length);
+
+		RS232_TrafficLogStats getStats() const;
+
+		//restores a file compressed at rotation (*.log.xph) to outputPath
+		static bool unpackFile(const std::string& compressedPath, const std::string& outputPath);
+
+	private:
+		RS232_TrafficLogger();
+
+		/*a preallocated buffer of formatted records*/
+		struct LogBuffer
+		{
+			std::unique_ptr<char[]> m_data;
+			size_t m_used = 0;
+		};
+		using LogBuffer_Ptr = std::unique_ptr<LogBuffer>;
+
+		//formats a record of at most TRAFFIC_LOG_RECORD_PAYLOAD bytes, returns its size
+		static size_t formatRecord(char* out, TrafficDirection direction, const std::string& portName, unsigned int totalLength,
+			unsigned int offset, const unsigned char* data, unsigned int length);
+
+		void writeLoop();
+		bool openFile();
+		bool closeFile(); //true if the closed file was compressed
+
+		static bool compressFile(const std::string& path);
+
+		/*to protect the Singleton class from being copied*/
+		RS232_TrafficLogger(const RS232_TrafficLogger&) = delete;
+		RS232_TrafficLogger& operator=(const RS232_TrafficLogger&) = delete;
+		RS232_TrafficLogger(RS232_TrafficLogger&&) = delete;
+		RS232_TrafficLogger& operator=(RS232_TrafficLogger&) = delete;
+		/*to protect the Singleton class from being copied*/
+
+		static RS232_TrafficLogger_Ptr m_instance;
+
+		RS232_TrafficLogParams_Ptr m_trafficLogParams;
+		std::atomic<bool> m_open;
+
+		mutable std::mutex m_guard;
+		std::condition_variable m_bufferFull;
+		LogBuffer_Ptr m_current; //records are formatted into it, NULL when every buffer waits for the writer
+		std::deque<LogBuffer_Ptr> m_fullBuffers;
+		std::vector<LogBuffer_Ptr> m_freeBuffers;
+		bool m_closing;
+
+		/*only touched by the writer thread once the log is open*/
+		std::ofstream m_file;
+		std::string m_filePath;
+		unsigned long long m_fileSize;
+		std::chrono::steady_clock::time_point m_fileOpened;
+		unsigned int m_fileIndex;
+		std::chrono::steady_clock::time_point m_nextOpenAttempt; //while no file is open after a failed open or write
+
+		std::thread m_writerThread;
+		RS232_TrafficLogStats m_stats;
+	};
+}
@@ -0,0 +1,69 @@
+#include "RS232_TxScheduler.h"
+
+#include <algorithm>
+
+namespace RS232
+{
+	RS232_TxScheduler::RS232_TxScheduler() :
+		m_nextTicket(0),
+		m_transmitting(false)
+	{
+		std::fill(m_totalQueueMicros, m_totalQueueMicros + TX_PRIORITY_COUNT, 0ULL);
+	}
+
+	void RS232_TxScheduler::send(TxPriority priority, unsigned int length, const std::function<void()>& transmit)
+	{
+		FrameTime queued = FrameClock::now();
+		std::unique_lock<std::mutex> lock(m_guard);
+		unsigned long long ticket = m_nextTicket++;
+		m_lanes[priority].push_back(ticket);
+		m_turn.wait(lock, [&]() { return !m_transmitting && isTurnOf(priority, ticket); });
+		m_lanes[priority].pop_front();
+		m_transmitting = true;
+
+		unsigned long long queueMicros = (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(FrameClock::now() - queued).count();
+		RS232_TxLaneStats& laneStats = m_stats.m_lanes[priority];
+		laneStats.m_sentFrames++;
+		laneStats.m_sentBytes += length;
+		m_totalQueueMicros[priority] += queueMicros;
+		laneStats.m_maxQueueMicros = std::max(laneStats.m_maxQueueMicros, queueMicros);
+		lock.unlock();
+
+		try
+		{
+			transmit();
+		}
+		catch (...)
+		{
+			std::cout << "RS232_TxScheduler::send() -> Unknown exception occurred!!" << std::endl;
+		}
+
+		lock.lock();
+		m_transmitting = false;
+		m_turn.notify_all();
+	}
+
+	RS232_TxStats RS232_TxScheduler::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_guard);
+		RS232_TxStats stats = m_stats;
+		for (unsigned int lane = 0; lane < TX_PRIORITY_COUNT; lane++)
+		{
+			RS232_TxLaneStats& laneStats = stats.m_lanes[lane];
+			laneStats.m_queuedFrames = m_lanes[lane].size();
+			if (laneStats.m_sentFrames > 0)
+				laneStats.m_averageQueueMicros = (double)m_totalQueueMicros[lane] / laneStats.m_sentFrames;
+		}
+		return stats;
+	}
+
+	bool RS232_TxScheduler::isTurnOf(TxPriority priority, unsigned long long ticket) const
+	{
+		for (unsigned int lane = 0; lane < (unsigned int)priority; lane++)
+		{
+			if (!m_lanes[lane].empty())
+				return false;
+		}
+		return m_lanes[priority].front() == ticket;
+	}
+}
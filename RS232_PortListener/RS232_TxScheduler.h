@@ -0,0 +1,63 @@
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   18-10-2026
+* @Purpose: transmit lanes of a port, a queued high priority frame is written before the normal ones waiting in front of it
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "RS232_Util.h"
+
+namespace RS232
+{
+	/*counters of a transmit lane*/
+	struct RS232_TxLaneStats
+	{
+		unsigned long long m_sentFrames = 0;
+		unsigned long long m_sentBytes = 0;
+		unsigned long long m_queuedFrames = 0; //waiting for their turn at the moment
+		double m_averageQueueMicros = 0.0; //from send() until the frame got the line
+		unsigned long long m_maxQueueMicros = 0;
+	};
+
+	struct RS232_TxStats
+	{
+		RS232_TxLaneStats m_lanes[TX_PRIORITY_COUNT];
+	};
+
+	/*
+	* the lanes are interleaved at frame boundaries only: none of the framing modes can carry a frame written in the middle
+	* of another one (the receiver would drop both), so a high priority frame waits for the frame on the line at most;
+	* a bulk transfer which has to let the control messages through is sent as several frames
+	*/
+	class RS232_TxScheduler final
+	{
+	public:
+		RS232_TxScheduler();
+
+		//blocks until the frame gets the line, i.e. the higher lanes & the frames in front of it in its own lane are written, then calls transmit
+		void send(TxPriority priority, unsigned int length, const std::function<void()>& transmit);
+
+		RS232_TxStats getStats() const;
+
+	private:
+		//the ticket is at the head of its lane & no higher lane has a frame waiting
+		bool isTurnOf(TxPriority priority, unsigned long long ticket) const;
+
+		RS232_TxScheduler(const RS232_TxScheduler&) = delete;
+		RS232_TxScheduler& operator=(const RS232_TxScheduler&) = delete;
+
+		mutable std::mutex m_guard;
+		std::condition_variable m_turn;
+		std::deque<unsigned long long> m_lanes[TX_PRIORITY_COUNT]; //tickets of the waiting frames
+		unsigned long long m_nextTicket;
+		bool m_transmitting;
+		RS232_TxStats m_stats;
+		unsigned long long m_totalQueueMicros[TX_PRIORITY_COUNT];
+	};
+}
@@ -1,393 +1,676 @@
-#pragma once
-/*
-@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
-* @version 1.0
-* @since   09-07-2018
-* @Purpose: implements utility structs and constant expressions
-*/
-
-#include <string>
-#include <vector>
-#include <iostream>
-#include <memory>
-
-#include <Windows.h>
-
-namespace RS232
-{
-#define ASCII_NULL	0x00	//Null char
-#define ASCII_ETX	0x03	//End of Text
-#define ASCII_CR	0x0D	//Carriage Return
-#define ASCII_SI	0x0F	//Shift In / X-Off
-#define ASCII_DLE	0x10	//Data Line Escape
-#define ASCII_DC1	0x11	//Device Control 1 (oft. XON)
-#define ASCII_DC3	0x13	//Device Control 3 (oft. XOFF)
-#define ASCII_SP	0x20	//Space
-#define ASCII_PLS	0x2B	//Plus +
-#define ASCII_SLH	0x2F	//Slash | Divide /
-#define ASCII_0		0x30	//Zero
-#define ASCII_LESS	0x3C	//Less than <
-#define ASCII_EQ	0x3D	//Equal =
-#define ASCII_QSTN	0x3F	//Question mark ?
-#define ASCII_TLDE	0x7E	//Tilde | Equivalency sign ~
-#define ASCII_LCAG	0xC0	//Latin capital letter A with grave
-#define ASCII_LSET	0xF0	//Latin small letter eth
-#define ASCII_LSUD	0xFC	//Latin small letter u with diaeresis
-
-constexpr auto COM_PORT_PREPEND = "\\\\.\\";
-#define DEFAULT_BUFFER_SIZE 16384;
-#define DEFAULT_STATUS_TIMEOUT 100
-
-#define ROOT_ELEMENT "RS232PortList"
-#define PORT_NODE "RS232Port"
-#define PORT_NAME_ATTR "<xmlattr>.portName"
-
-#define DETAILS_NODE "portDetails"
-#define BAUD_ATTR "<xmlattr>.baudRate"
-#define CHAR_SIZE_ATTR "<xmlattr>.charSize"
-#define PARITY_ATTR "<xmlattr>.parity"
-#define STOP_ATTR "<xmlattr>.stopBits"
-#define FLOW_ATTR "<xmlattr>.flowControl"
-
-#define PROTOCOL_NODE "portProtocol"
-#define STX_ATTR "<xmlattr>.stx"
-#define ETX_ATTR "<xmlattr>.etx"
-#define DLE_ATTR "<xmlattr>.dle"
-#define CR_ATTR "<xmlattr>.cr"
-#define UPDATE_TIME_ATTR "<xmlattr>.statusUpdateTime"
-#define RX_SIZE_ATTR "<xmlattr>.rxBufferSize"
-#define TX_SIZE_ATTR "<xmlattr>.txBufferSize"
-
-#define CONTROL_NODE "dataControl"
-#define SOD_ATTR "<xmlattr>.sod"
-#define EOD_ATTR "<xmlattr>.eod"
-#define TYPE_ATTR "<xmlattr>.typeName"
-
-#define DELIM_NODE "delimeter"
-
-#define TRUE_STR "true"
-#define FALSE_STR "false"
-
-#define TRANSMIT_SECTION "TransmitData"
-#define TEXT_SECTION "TextData"
-#define BINARY_SECTION "BinaryData"
-
-
-	enum ReceiveStatus
-	{
-		WaitingForSOD,
-		WaitingForSTX,
-		WaitingForETX,
-		WaitingForEOD
-	};
-
-	enum BaudRate
-	{
-		BR_50 = 50,
-		BR_75 = 75,
-		BR_110 = 110,
-		BR_134 = 134,
-		BR_150 = 150,
-		BR_200 = 200,
-		BR_300 = 300,
-		BR_600 = 600,
-		BR_1200 = 1200,
-		BR_1800 = 1800,
-		BR_2400 = 2400,
-		BR_4800 = 4800,
-		BR_9600 = 9600,
-		BR_19200 = 19200,
-		BR_38400 = 38400,
-		BR_57600 = 57600,
-		BR_115200 = 115200,
-		BR_230400 = 230400,
-		BR_460800 = 460800,
-		BR_UNKNOWN = 0
-	};
-
-	enum CharSize
-	{
-		CS_5 = 5,
-		CS_6 = 6,
-		CS_7 = 7,
-		CS_8 = 8,
-		CS_UNKNOWN = 0
-	};
-
-	enum Parity
-	{
-		EVEN = 'E',
-		ODD = 'O',
-		NONE = 'N',
-		UNKNOWN = 'U'
-	};
-
-	enum StopBits
-	{
-		SB_1 = 1,
-		SB_1_5 = 11,
-		SB_2 = 2,
-		SB_UNKNOWN = 'U'
-	};
-
-	enum FlowControl
-	{
-		FC_HARD = 'H',
-		FC_SOFT = 'S',
-		FC_NONE = 'N',
-		FC_UNKNOWN = 'U'
-	};
-
-	enum PortError
-	{
-		PE_PortIsAlreadyOpen,
-		PE_PortIsNotOpen,
-		PE_InvalidPortParameter,
-		PE_CannotOpenPort,
-		PE_CannotGetPortSettings,
-		PE_CannotAdjustPortSettings,
-		PE_ReadError,
-		PE_WriteError,
-		PE_BufferOverrunError
-	};
-	
-	struct DataControl
-	{
-		DataControl(const std::string& typeName, char sod, char eod) :
-			m_typeName(typeName), m_SOD(sod), m_EOD(eod), m_delims("")
-		{}
-
-		DataControl(const std::string& typeName, char sod, char eod, std::string delims) :
-			m_typeName(typeName), m_SOD(sod), m_EOD(eod), m_delims(delims)
-		{}
-
-		std::string m_typeName;
-		char m_SOD; //Start of Data
-		char m_EOD; //End of Data
-		std::string m_delims; //data delimeter
-
-		bool operator==(const DataControl& rhs) const
-		{
-			if (m_typeName.compare(rhs.m_typeName) != 0)
-				return false;
-			else if (m_SOD != rhs.m_SOD)
-				return false;
-			else if (m_EOD != rhs.m_EOD)
-				return false;
-			else
-				return true;
-		}
-
-	};
-	using DataControl_Ptr = std::shared_ptr<DataControl>;
-
-	struct RS232_PortParams
-	{
-		RS232_PortParams(const std::string& comPort) :
-			m_comPort(comPort), m_baudRate(BaudRate::BR_9600), m_charSize(CharSize::CS_8), m_parity(Parity::NONE), m_stopBits(StopBits::SB_1), m_flowControl(FlowControl::FC_NONE),
-			m_STX(0x02), m_ETX(0x03), m_DLEEnabled(false), m_CREnabled(false)
-		{}
-
-		RS232_PortParams(const std::string& comPort, BaudRate baudRate, CharSize charSize, Parity parity, StopBits stopBits, FlowControl flowControl) :
-			m_comPort(comPort), m_baudRate(baudRate), m_charSize(charSize), m_parity(parity), m_stopBits(stopBits), m_flowControl(flowControl),
-			m_STX(0x02), m_ETX(0x03), m_DLEEnabled(false), m_CREnabled(false)
-		{}
-
-		RS232_PortParams(const std::string& comPort, BaudRate baudRate, CharSize charSize, Parity parity, StopBits stopBits, FlowControl flowControl,
-			char stx, char etx, bool dleEnabled = false, bool crEnabled = false) :
-			m_comPort(comPort), m_baudRate(baudRate), m_charSize(charSize), m_parity(parity), m_stopBits(stopBits), m_flowControl(flowControl),
-			m_STX(stx), m_ETX(etx), m_DLEEnabled(dleEnabled), m_CREnabled(crEnabled)
-		{}
-
-		std::string m_comPort;
-		BaudRate m_baudRate;
-		CharSize m_charSize;
-		Parity m_parity;
-		StopBits m_stopBits;
-		FlowControl m_flowControl;
-
-		char m_STX; //Start of Text
-		char m_ETX; //End of Text
-		bool m_DLEEnabled; //Data Link Escape enabled
-		bool m_CREnabled; //Carriage Return enabled
-
-		unsigned int m_statusUpdateTime = DEFAULT_STATUS_TIMEOUT;
-		unsigned int m_rxBufferSize = DEFAULT_BUFFER_SIZE;
-		unsigned int m_txBufferSize = DEFAULT_BUFFER_SIZE;
-
-		std::vector<DataControl_Ptr> m_dcList;
-
-		void addDataControl(DataControl dc)
-		{
-			for (auto iter : m_dcList)
-				if (*iter == dc)
-					return;
-			m_dcList.push_back(std::make_shared<DataControl>(dc));
-		}
-
-		char getEOD(char sod)
-		{
-			for (auto iter : m_dcList)
-				if (iter->m_SOD == sod)
-					return iter->m_EOD;
-			return ASCII_NULL; //return NULL char in case no SOD is listed in dataControl list!
-		}
-
-		std::string getDataType(char sod)
-		{
-			for (auto iter : m_dcList)
-				if (iter->m_SOD == sod)
-					return iter->m_typeName;
-			return ""; //return EMPTY string in case no SOD is listed in dataControl list!
-		}
-
-		std::string getDelims(char sod)
-		{
-			for (auto iter : m_dcList)
-				if (iter->m_SOD == sod)
-					return iter->m_delims;
-			return ""; //return EMPTY string in case no SOD is listed in dataControl list!
-		}
-
-	};
-	using RS232_PortParams_Ptr = std::shared_ptr<RS232_PortParams>;
-
-	struct RS232_PinStatus
-	{
-		RS232_PinStatus(bool cts_on = false, bool dsr_on = false, bool ri_on = false, bool rlsd_on = false) :
-			m_CTS_on(cts_on), m_DSR_on(dsr_on), m_RI_on(ri_on), m_RLSD_on(rlsd_on)
-		{}
-
-		/*!!!Information!!!
-		*DTE -> Data Terminal Equipment [ex: computer terminal]
-		*DCE -> Data Circuit-terminating Equipment (Data Communication Equipment) [ex: modem]
-		*/
-		bool m_CTS_on; //Clear To Send [DCE is ready to accept data from DTE]
-		bool m_DSR_on; //Data Set Ready [DCE is ready to receive and send data]
-		bool m_RI_on; //Ring Indicator [DCE has detected an incoming ring signal on the telephone line]
-		bool m_RLSD_on; //Receive Line Signal Detect (DCD {Data Carrier Detect}) [DCE is receiving a carrier from a remote DCE]
-
-		bool operator==(const RS232_PinStatus& rhs) const
-		{
-			if (m_CTS_on != rhs.m_CTS_on)
-				return false;
-			else if (m_DSR_on != rhs.m_DSR_on)
-				return false;
-			else if (m_RI_on != rhs.m_RI_on)
-				return false;
-			else if (m_RLSD_on != rhs.m_RLSD_on)
-				return false;
-			else
-				return true;
-		}
-
-		bool operator!=(const RS232_PinStatus& rhs) const
-		{
-			return !operator==(rhs);
-		}
-	};
-
-	inline DWORD ConvertBaudRate(BaudRate baudRate)
-	{
-		switch (baudRate)
-		{
-		case BR_50:
-			return 50;
-		case BR_75:
-			return 75;
-		case BR_110:
-			return 110;
-		case BR_134:
-			return 134;
-		case BR_150:
-			return 150;
-		case BR_200:
-			return 200;
-		case BR_300:
-			return 300;
-		case BR_600:
-			return 600;
-		case BR_1200:
-			return 1200;
-		case BR_1800:
-			return 1800;
-		case BR_2400:
-			return 2400;
-		case BR_4800:
-			return 4800;
-		case BR_9600:
-			return 9600;
-		case BR_19200:
-			return 19200;
-		case BR_38400:
-			return 38400;
-		case BR_57600:
-			return 57600;
-		case BR_115200:
-			return 115200;
-		case BR_230400:
-			return 230400;
-		case BR_460800:
-			return 460800;
-		default:
-			return 9600;
-		}
-	}
-
-	inline BYTE ConvertCharSize(CharSize charSize)
-	{
-		switch (charSize)
-		{
-		case CS_5:
-			return DATABITS_5;
-		case CS_6:
-			return DATABITS_6;
-		case CS_7:
-			return DATABITS_7;
-		case CS_8:
-		default:
-			return DATABITS_8;
-		}
-	}
-
-	inline BYTE ConvertParity(Parity parity)
-	{
-		switch (parity)
-		{
-		case EVEN:
-			return EVENPARITY;
-		case ODD:
-			return ODDPARITY;
-		case NONE:
-		default:
-			return NOPARITY;
-		}
-	}
-
-	inline BYTE ConvertStopBits(StopBits stopBits)
-	{
-		switch (stopBits)
-		{
-		case SB_1_5:
-			return ONE5STOPBITS;
-		case SB_2:
-			return TWOSTOPBITS;
-		case SB_1:
-		default:
-			return ONESTOPBIT;
-		}
-	}
-
-	inline BOOL ConvertFlowControl(FlowControl flowControl)
-	{
-		switch (flowControl)
-		{
-		case FC_HARD:
-		case FC_SOFT:
-			return TRUE;
-		case FC_NONE:
-		default:
-			return FALSE;
-		}
-	}
+#pragma once
+/*
+@author  Ali Yavuz Kahveci aliyavuzkahveci@gmail.com
+* @version 1.0
+* @since   09-07-2018
+* @Purpose: implements utility structs and constant expressions
+*/
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <memory>
+
+#include <Windows.h>
+
+#include "RS232_Tokenizer.h"
+#include "RS232_Checksum.h"
+#include "RS232_SegmentedBuffer.h"
+
+namespace RS232
+{
+#define ASCII_NULL	0x00	//Null char
+#define ASCII_ETX	0x03	//End of Text
+#define ASCII_CR	0x0D	//Carriage Return
+#define ASCII_SI	0x0F	//Shift In / X-Off
+#define ASCII_DLE	0x10	//Data Line Escape
+#define ASCII_DC1	0x11	//Device Control 1 (oft. XON)
+#define ASCII_DC3	0x13	//Device Control 3 (oft. XOFF)
+#define ASCII_SP	0x20	//Space
+#define ASCII_PLS	0x2B	//Plus +
+#define ASCII_SLH	0x2F	//Slash | Divide /
+#define ASCII_0		0x30	//Zero
+#define ASCII_LESS	0x3C	//Less than <
+#define ASCII_EQ	0x3D	//Equal =
+#define ASCII_QSTN	0x3F	//Question mark ?
+#define ASCII_TLDE	0x7E	//Tilde | Equivalency sign ~
+#define ASCII_LCAG	0xC0	//Latin capital letter A with grave
+#define ASCII_LSET	0xF0	//Latin small letter eth
+#define ASCII_LSUD	0xFC	//Latin small letter u with diaeresis
+
+#define SLIP_END		0xC0	//SLIP frame end
+#define SLIP_ESC		0xDB	//SLIP escape
+#define SLIP_ESC_END	0xDC	//SLIP escaped frame end
+#define SLIP_ESC_ESC	0xDD	//SLIP escaped escape
+
+constexpr auto COM_PORT_PREPEND = "\\\\.\\";
+#define DEFAULT_BUFFER_SIZE 16384;
+#define DEFAULT_STATUS_TIMEOUT 100
+#define DEFAULT_RX_BUFFER_MAX_SIZE 1048576
+#define DEFAULT_TX_DRAIN_TIMEOUT 100
+#define DEFAULT_RX_QUEUE_SIZE 1048576
+#define DEFAULT_FLOW_LOW_WATERMARK 25
+#define DEFAULT_MAX_FRAME_SIZE 1048576
+#define DEFAULT_SPILL_FILE_SUFFIX "_rx_spill.bin"
+#define DEFAULT_JOURNAL_SEGMENT_SIZE 67108864
+#define DEFAULT_JOURNAL_COMMIT_INTERVAL 10
+#define DEFAULT_TRAFFIC_LOG_FILE_SIZE 16777216
+#define DEFAULT_TRAFFIC_LOG_ROTATE_INTERVAL 3600
+#define DEFAULT_FRAME_OUTPUT_BUFFER_SIZE 1048576
+#define DEFAULT_FRAME_OUTPUT_FLUSH_INTERVAL 100
+#define DEFAULT_GATEWAY_CLIENT_QUEUE 262144
+#define DEFAULT_ROUTE_LATENCY_BUDGET 1000
+#define DEFAULT_HARNESS_FRAMES 1000
+#define DEFAULT_HARNESS_ONE_WAY_P99 20000
+#define DEFAULT_HARNESS_ROUND_TRIP_P99 40000
+#define DEFAULT_HARNESS_LINE_UTILIZATION 0.8
+#define DEFAULT_POLL_PERIOD 1000
+#define DEFAULT_POLL_TIMEOUT 100
+#define DEFAULT_POLL_MAX_BACKOFF 30000
+#define DEFAULT_POLL_DEAD_TIMEOUTS 3
+#define DEFAULT_ECHO_TIMEOUT 50
+#define FRAME_BUS_NAME_PREFIX "Local\\RS232_FrameBus_"
+
+#define ROOT_ELEMENT "RS232PortList"
+#define PORT_NODE "RS232Port"
+#define PORT_NAME_ATTR "<xmlattr>.portName"
+
+#define DETAILS_NODE "portDetails"
+#define BAUD_ATTR "<xmlattr>.baudRate"
+#define CHAR_SIZE_ATTR "<xmlattr>.charSize"
+#define PARITY_ATTR "<xmlattr>.parity"
+#define STOP_ATTR "<xmlattr>.stopBits"
+#define FLOW_ATTR "<xmlattr>.flowControl"
+
+#define PROTOCOL_NODE "portProtocol"
+#define STX_ATTR "<xmlattr>.stx"
+#define ETX_ATTR "<xmlattr>.etx"
+#define DLE_ATTR "<xmlattr>.dle"
+#define CR_ATTR "<xmlattr>.cr"
+#define PRINT_FRAME_START_ATTR "<xmlattr>.printFrameStart"
+#define UPDATE_TIME_ATTR "<xmlattr>.statusUpdateTime"
+#define RX_SIZE_ATTR "<xmlattr>.rxBufferSize"
+#define RX_MAX_SIZE_ATTR "<xmlattr>.rxBufferMaxSize"
+#define TX_SIZE_ATTR "<xmlattr>.txBufferSize"
+#define CHECKSUM_ATTR "<xmlattr>.checksum"
+#define FRAMING_ATTR "<xmlattr>.framing"
+#define READ_MIN_ATTR "<xmlattr>.readMinBytes"
+#define READ_WAIT_ATTR "<xmlattr>.readMaxWait"
+#define READ_BATCH_ATTR "<xmlattr>.readMaxBatch"
+#define RX_QUEUE_ATTR "<xmlattr>.rxQueueSize"
+#define OVERFLOW_ATTR "<xmlattr>.overflowPolicy"
+#define SPILL_FILE_ATTR "<xmlattr>.spillFile"
+#define SPILL_SIZE_ATTR "<xmlattr>.spillMaxSize"
+#define BUS_SIZE_ATTR "<xmlattr>.busSize"
+#define GATEWAY_SOCKET_ATTR "<xmlattr>.gatewaySocket"
+#define GATEWAY_QUEUE_ATTR "<xmlattr>.gatewayClientQueue"
+#define CPU_AFFINITY_ATTR "<xmlattr>.cpuAffinity"
+#define READER_PRIORITY_ATTR "<xmlattr>.readerPriority"
+#define LOCK_MEMORY_ATTR "<xmlattr>.lockMemory"
+#define TX_DRAIN_ATTR "<xmlattr>.txDrainTimeout"
+#define MAX_FRAME_SIZE_ATTR "<xmlattr>.maxFrameSize"
+#define FLOW_HIGH_WATERMARK_ATTR "<xmlattr>.flowHighWatermark"
+#define FLOW_LOW_WATERMARK_ATTR "<xmlattr>.flowLowWatermark"
+#define ADDRESS_SIZE_ATTR "<xmlattr>.addressSize"
+#define ADDRESS_OFFSET_ATTR "<xmlattr>.addressOffset"
+#define HALF_DUPLEX_ATTR "<xmlattr>.halfDuplex"
+#define RTS_GUARD_ATTR "<xmlattr>.rtsGuard"
+#define ECHO_CANCEL_ATTR "<xmlattr>.echoCancel"
+#define ECHO_TIMEOUT_ATTR "<xmlattr>.echoTimeout"
+
+#define CONTROL_NODE "dataControl"
+#define SOD_ATTR "<xmlattr>.sod"
+#define EOD_ATTR "<xmlattr>.eod"
+#define TYPE_ATTR "<xmlattr>.typeName"
+
+#define DELIM_NODE "delimeter"
+
+#define JOURNAL_NODE "journal"
+#define JOURNAL_DIR_ATTR "<xmlattr>.directory"
+#define JOURNAL_SEGMENT_ATTR "<xmlattr>.segmentSize"
+#define JOURNAL_COMMIT_ATTR "<xmlattr>.commitInterval"
+
+#define TRAFFIC_LOG_NODE "trafficLog"
+#define TRAFFIC_LOG_DIR_ATTR "<xmlattr>.directory"
+#define TRAFFIC_LOG_SIZE_ATTR "<xmlattr>.maxFileSize"
+#define TRAFFIC_LOG_ROTATE_ATTR "<xmlattr>.rotateInterval"
+#define TRAFFIC_LOG_COMPRESS_ATTR "<xmlattr>.compress"
+
+#define FRAME_OUTPUT_NODE "frameOutput"
+#define FRAME_OUTPUT_PATH_ATTR "<xmlattr>.path"
+#define FRAME_OUTPUT_BUFFER_ATTR "<xmlattr>.bufferSize"
+#define FRAME_OUTPUT_FLUSH_ATTR "<xmlattr>.flushInterval"
+#define FRAME_OUTPUT_STDOUT "-"
+
+#define HARNESS_NODE "harness"
+#define HARNESS_FRAMES_ATTR "<xmlattr>.frames"
+#define HARNESS_ONE_WAY_ATTR "<xmlattr>.maxOneWayP99"
+#define HARNESS_ROUND_TRIP_ATTR "<xmlattr>.maxRoundTripP99"
+#define HARNESS_UTILIZATION_ATTR "<xmlattr>.minLineUtilization"
+
+#define PROCESS_NODE "process"
+#define PROCESS_PRIORITY_CLASS_ATTR "<xmlattr>.priorityClass"
+
+#define POLLER_NODE "poller"
+#define POLLER_TURNAROUND_ATTR "<xmlattr>.turnaround"
+#define POLLER_MAX_BACKOFF_ATTR "<xmlattr>.maxBackoff"
+#define POLLER_DEAD_TIMEOUTS_ATTR "<xmlattr>.deadAfter"
+#define POLL_NODE "poll"
+#define POLL_SLAVE_ATTR "<xmlattr>.slave"
+#define POLL_PERIOD_ATTR "<xmlattr>.period"
+#define POLL_TIMEOUT_ATTR "<xmlattr>.timeout"
+#define POLL_REQUEST_ATTR "<xmlattr>.request"
+
+#define TRUE_STR "true"
+#define FALSE_STR "false"
+
+#define TRANSMIT_SECTION "TransmitData"
+#define TEXT_SECTION "TextData"
+#define BINARY_SECTION "BinaryData"
+
+#define FRAMING_STX_ETX "STX_ETX"
+#define FRAMING_MODBUS_RTU "RTU"
+#define FRAMING_COBS "COBS"
+#define FRAMING_SLIP "SLIP"
+
+#define OVERFLOW_BLOCK "block"
+#define OVERFLOW_DROP_OLDEST "dropOldest"
+#define OVERFLOW_DROP_NEWEST "dropNewest"
+#define OVERFLOW_SPILL "spill"
+
+#define HALF_DUPLEX_NONE "none"
+#define HALF_DUPLEX_AUTO "auto"
+#define HALF_DUPLEX_RTS "rts"
+
+#define PRIORITY_NORMAL "normal"
+#define PRIORITY_HIGH "high"
+#define PRIORITY_TIME_CRITICAL "timeCritical"
+#define PRIORITY_REALTIME "realtime"
+
+	constexpr unsigned int NO_NON_PRINTABLE_CHAR = 0xFFFFFFFF; //the received data is printable as a whole
+	constexpr int NO_DROP_ADDRESS = -1; //the port has no address field (single peer)
+	constexpr unsigned int MAX_ADDRESS_SIZE = 2; //bytes, the drop table is indexed by the address
+
+	using FrameClock = std::chrono::steady_clock; //monotonic, QueryPerformanceCounter based
+	using FrameTime = FrameClock::time_point;
+
+
+	enum ReceiveStatus
+	{
+		WaitingForSOD,
+		WaitingForSTX,
+		WaitingForETX,
+		WaitingForChecksum,
+		WaitingForEOD
+	};
+
+	enum FramingMode
+	{
+		FM_STX_ETX,		//STX data [DLE escaped] ETX, optionally wrapped by SOD/EOD
+		FM_MODBUS_RTU,	//frames separated by line silence (t3.5), CRC-16 at the end
+		FM_COBS,		//Consistent Overhead Byte Stuffing, 0x00 terminated
+		FM_SLIP			//RFC 1055 Serial Line IP, 0xC0 terminated
+	};
+
+	enum OverflowPolicy
+	{
+		OP_BLOCK,		//the reader thread waits for the consumer, the driver buffer & flow control take over
+		OP_DROP_OLDEST,	//the oldest queued frames are discarded for the new one
+		OP_DROP_NEWEST,	//the new frame is discarded
+		OP_SPILL		//the frames which do not fit in memory are written to a file
+	};
+
+	enum HalfDuplexMode
+	{
+		HD_NONE,		//full duplex, RTS is left to the flow control
+		HD_AUTO,		//RS-485: the driver raises RTS while it sends (RTS_CONTROL_TOGGLE), HD_RTS if the driver does not support it
+		HD_RTS			//RS-485: RTS is raised around each write & dropped once the last stop bit is on the line
+	};
+
+	enum TxPriority
+	{
+		TP_HIGH,		//control messages, sent as soon as the frame on the line is completed
+		TP_NORMAL,		//everything else (i.e. bulk transfers), FIFO behind the high priority lane
+		TX_PRIORITY_COUNT
+	};
+
+	enum ReaderPriority
+	{
+		RP_NORMAL,			//default scheduling
+		RP_HIGH,			//THREAD_PRIORITY_HIGHEST
+		RP_TIME_CRITICAL	//THREAD_PRIORITY_TIME_CRITICAL within the priority class of the process (the process node of the XML)
+	};
+
+	enum BaudRate
+	{
+		BR_50 = 50,
+		BR_75 = 75,
+		BR_110 = 110,
+		BR_134 = 134,
+		BR_150 = 150,
+		BR_200 = 200,
+		BR_300 = 300,
+		BR_600 = 600,
+		BR_1200 = 1200,
+		BR_1800 = 1800,
+		BR_2400 = 2400,
+		BR_4800 = 4800,
+		BR_9600 = 9600,
+		BR_19200 = 19200,
+		BR_38400 = 38400,
+		BR_57600 = 57600,
+		BR_115200 = 115200,
+		BR_230400 = 230400,
+		BR_460800 = 460800,
+		BR_UNKNOWN = 0
+	};
+
+	enum CharSize
+	{
+		CS_5 = 5,
+		CS_6 = 6,
+		CS_7 = 7,
+		CS_8 = 8,
+		CS_UNKNOWN = 0
+	};
+
+	enum Parity
+	{
+		EVEN = 'E',
+		ODD = 'O',
+		NONE = 'N',
+		UNKNOWN = 'U'
+	};
+
+	enum StopBits
+	{
+		SB_1 = 1,
+		SB_1_5 = 11,
+		SB_2 = 2,
+		SB_UNKNOWN = 'U'
+	};
+
+	enum FlowControl
+	{
+		FC_HARD = 'H',
+		FC_SOFT = 'S',
+		FC_NONE = 'N',
+		FC_UNKNOWN = 'U'
+	};
+
+	enum PortError
+	{
+		PE_PortIsAlreadyOpen,
+		PE_PortIsNotOpen,
+		PE_InvalidPortParameter,
+		PE_CannotOpenPort,
+		PE_CannotGetPortSettings,
+		PE_CannotAdjustPortSettings,
+		PE_ReadError,
+		PE_WriteError,
+		PE_BufferOverrunError
+	};
+	
+	struct DataControl
+	{
+		DataControl(const std::string& typeName, char sod, char eod) :
+			m_typeName(typeName), m_SOD(sod), m_EOD(eod), m_delims("")
+		{}
+
+		DataControl(const std::string& typeName, char sod, char eod, std::string delims) :
+			m_typeName(typeName), m_SOD(sod), m_EOD(eod), m_delims(delims), m_delimSet(delims)
+		{}
+
+		std::string m_typeName;
+		char m_SOD; //Start of Data
+		char m_EOD; //End of Data
+		std::string m_delims; //data delimeter
+		DelimiterSet m_delimSet; //precomputed mask of m_delims used by the tokenizer
+		unsigned int m_typeId = 0; //index in RS232_PortParams::m_dcList, frames are routed by it
+
+		bool operator==(const DataControl& rhs) const
+		{
+			if (m_typeName.compare(rhs.m_typeName) != 0)
+				return false;
+			else if (m_SOD != rhs.m_SOD)
+				return false;
+			else if (m_EOD != rhs.m_EOD)
+				return false;
+			else
+				return true;
+		}
+
+	};
+	using DataControl_Ptr = std::shared_ptr<DataControl>;
+
+	/*durable journal of the received frames, shared by all ports*/
+	struct RS232_JournalParams
+	{
+		std::string m_directory;
+		unsigned long long m_segmentSize = DEFAULT_JOURNAL_SEGMENT_SIZE; //a new segment file is started once the current one exceeds it
+		unsigned int m_commitIntervalMillis = DEFAULT_JOURNAL_COMMIT_INTERVAL; //max time an appended frame waits to be flushed to disk, 0 flushes right away
+	};
+	using RS232_JournalParams_Ptr = std::shared_ptr<RS232_JournalParams>;
+
+	/*hex dump of the RX/TX traffic, shared by all ports*/
+	struct RS232_TrafficLogParams
+	{
+		std::string m_directory;
+		unsigned long long m_maxFileSize = DEFAULT_TRAFFIC_LOG_FILE_SIZE; //a new file is started once the current one exceeds it
+		unsigned int m_rotateIntervalSeconds = DEFAULT_TRAFFIC_LOG_ROTATE_INTERVAL; //a new file is started at least this often, 0 rotates by size only
+		bool m_compress = false; //the closed files are compressed
+	};
+	using RS232_TrafficLogParams_Ptr = std::shared_ptr<RS232_TrafficLogParams>;
+
+	/*binary records of the received frames for the downstream ingestion, replaces the console printout of all ports*/
+	struct RS232_FrameOutputParams
+	{
+		std::string m_path = FRAME_OUTPUT_STDOUT; //"-" writes to stdout, the console messages move to stderr
+		unsigned int m_bufferSize = DEFAULT_FRAME_OUTPUT_BUFFER_SIZE; //the records are written in chunks of this size
+		unsigned int m_flushIntervalMillis = DEFAULT_FRAME_OUTPUT_FLUSH_INTERVAL; //max time a record waits in the buffer
+	};
+	using RS232_FrameOutputParams_Ptr = std::shared_ptr<RS232_FrameOutputParams>;
+
+	/*pass/fail thresholds of the end-to-end harness, latencies in microseconds*/
+	struct RS232_HarnessParams
+	{
+		unsigned int m_frames = DEFAULT_HARNESS_FRAMES; //samples of each latency measurement & frames of the throughput measurement
+		double m_maxOneWayP99 = DEFAULT_HARNESS_ONE_WAY_P99; //of the probe & of the payload on top of its wire time
+		double m_maxRoundTripP99 = DEFAULT_HARNESS_ROUND_TRIP_P99;
+		double m_minLineUtilization = DEFAULT_HARNESS_LINE_UTILIZATION; //sustained wire bytes/s over the capacity of the line
+	};
+	using RS232_HarnessParams_Ptr = std::shared_ptr<RS232_HarnessParams>;
+
+	/*a request polled cyclically from a slave of a multidrop line*/
+	struct RS232_PollParams
+	{
+		unsigned int m_slave = 0; //address of the drop, stamped into the request
+		unsigned int m_periodMillis = DEFAULT_POLL_PERIOD; //the reply is due within the period
+		unsigned int m_timeoutMillis = DEFAULT_POLL_TIMEOUT; //wait for the reply
+		std::string m_request; //payload without the address field
+	};
+
+	/*polling master of a port, the slaves are polled earliest deadline first*/
+	struct RS232_PollerParams
+	{
+		unsigned int m_turnaroundMicros = 0; //bus idle time after a reply or a timeout before the next request (RS-485 driver release)
+		unsigned int m_maxBackoffMillis = DEFAULT_POLL_MAX_BACKOFF; //the longest retry interval of a dead slave
+		unsigned int m_deadTimeouts = DEFAULT_POLL_DEAD_TIMEOUTS; //consecutive timeouts after which a slave is backed off
+		std::vector<RS232_PollParams> m_polls;
+	};
+	using RS232_PollerParams_Ptr = std::shared_ptr<RS232_PollerParams>;
+
+	struct RS232_PortParams
+	{
+		RS232_PortParams(const std::string& comPort) :
+			m_comPort(comPort), m_baudRate(BaudRate::BR_9600), m_charSize(CharSize::CS_8), m_parity(Parity::NONE), m_stopBits(StopBits::SB_1), m_flowControl(FlowControl::FC_NONE),
+			m_STX(0x02), m_ETX(0x03), m_DLEEnabled(false), m_CREnabled(false)
+		{}
+
+		RS232_PortParams(const std::string& comPort, BaudRate baudRate, CharSize charSize, Parity parity, StopBits stopBits, FlowControl flowControl) :
+			m_comPort(comPort), m_baudRate(baudRate), m_charSize(charSize), m_parity(parity), m_stopBits(stopBits), m_flowControl(flowControl),
+			m_STX(0x02), m_ETX(0x03), m_DLEEnabled(false), m_CREnabled(false)
+		{}
+
+		RS232_PortParams(const std::string& comPort, BaudRate baudRate, CharSize charSize, Parity parity, StopBits stopBits, FlowControl flowControl,
+			char stx, char etx, bool dleEnabled = false, bool crEnabled = false) :
+			m_comPort(comPort), m_baudRate(baudRate), m_charSize(charSize), m_parity(parity), m_stopBits(stopBits), m_flowControl(flowControl),
+			m_STX(stx), m_ETX(etx), m_DLEEnabled(dleEnabled), m_CREnabled(crEnabled)
+		{}
+
+		std::string m_comPort;
+		BaudRate m_baudRate;
+		CharSize m_charSize;
+		Parity m_parity;
+		StopBits m_stopBits;
+		FlowControl m_flowControl;
+
+		char m_STX; //Start of Text
+		char m_ETX; //End of Text
+		bool m_DLEEnabled; //Data Link Escape enabled
+		bool m_CREnabled; //Carriage Return enabled
+		bool m_printFrameStart = true; //the STX/ETX framer prints "message read started" for every frame
+
+		unsigned int m_statusUpdateTime = DEFAULT_STATUS_TIMEOUT;
+		unsigned int m_rxBufferSize = DEFAULT_BUFFER_SIZE; //initial size of the read buffer & the driver input queue
+		unsigned int m_rxBufferMaxSize = DEFAULT_RX_BUFFER_MAX_SIZE; //both grow up to this size on overflows & deep input queues
+		unsigned int m_txBufferSize = DEFAULT_BUFFER_SIZE;
+
+		ChecksumType m_checksumType = CK_NONE; //checksum sent right after ETX (before EOD)
+		FramingMode m_framingMode = FM_STX_ETX;
+		unsigned int m_maxFrameSize = DEFAULT_MAX_FRAME_SIZE; //a runaway frame is aborted at this size & the framer waits for the next one
+
+		/*multidrop line: the address field of the frames (big endian) selects the logical device of the drop*/
+		unsigned int m_addressSize = 0; //bytes, 0 means a single peer on the line
+		unsigned int m_addressOffset = 0; //position of the address field in the payload
+		RS232_PollerParams_Ptr m_pollerParams; //the slaves polled by the listener, NULL unless configured
+
+		/*RS-485 half duplex: RTS enables the line driver while we send, an adapter which listens to its own line echoes the sent bytes*/
+		HalfDuplexMode m_halfDuplexMode = HD_NONE;
+		unsigned int m_rtsGuardMicros = 0; //HD_RTS: RTS is held this long after the last stop bit
+		bool m_echoCancel = false; //the echoed bytes are removed from the received data
+		unsigned int m_echoTimeoutMillis = DEFAULT_ECHO_TIMEOUT; //the echo not received this long after the wire time is given up
+
+		/*adaptive read batching: the reader waits up to m_readMaxWaitMicros for a batch between m_readMinBytes and m_readMaxBatch bytes*/
+		unsigned int m_readMinBytes = 1;
+		unsigned int m_readMaxWaitMicros = 0; //0 disables batching, every read returns what the driver has (always 0 for Modbus RTU)
+		unsigned int m_readMaxBatch = 0; //0 means m_rxBufferSize
+
+		/*bounded queue between the reader thread and the frame consumer*/
+		size_t m_rxQueueSize = DEFAULT_RX_QUEUE_SIZE; //max memory held by the received frames
+		OverflowPolicy m_overflowPolicy = OP_BLOCK;
+		std::string m_spillFilePath; //OP_SPILL, defaults to <portName>_rx_spill.bin
+		unsigned long long m_spillMaxSize = 0; //OP_SPILL, 0 means unlimited; the frames are dropped beyond it
+
+		/*flow control by the fill level of the receive queue instead of the driver buffer (FC_HARD/FC_SOFT), in percent of m_rxQueueSize*/
+		unsigned int m_flowHighWatermark = 0; //the sender is stopped (RTS off/XOFF) at this level, 0 leaves the flow control to the driver
+		unsigned int m_flowLowWatermark = DEFAULT_FLOW_LOW_WATERMARK; //the sender is released (RTS on/XON) at this level
+
+		size_t m_busSize = 0; //shared memory ring for local reader processes, 0 disables it
+
+		std::string m_gatewaySocketPath; //Unix domain socket of the port for other services, empty disables it
+		size_t m_gatewayClientQueue = DEFAULT_GATEWAY_CLIENT_QUEUE; //a client with more unsent bytes is disconnected
+
+		/*scheduling of the reader thread*/
+		unsigned long long m_cpuAffinity = 0; //mask of the CPUs the reader thread may run on, 0 leaves it to the scheduler
+		ReaderPriority m_readerPriority = RP_NORMAL;
+		bool m_lockMemory = false; //the read buffer is pre-faulted & locked in physical memory
+		unsigned int m_txDrainTimeoutMillis = DEFAULT_TX_DRAIN_TIMEOUT; //close() waits this long for the queued bytes to be sent, the rest is discarded
+
+		std::vector<DataControl_Ptr> m_dcList;
+
+		void addDataControl(DataControl dc)
+		{
+			for (auto iter : m_dcList)
+				if (*iter == dc)
+					return;
+			dc.m_typeId = (unsigned int)m_dcList.size();
+			m_dcList.push_back(std::make_shared<DataControl>(dc));
+		}
+
+		char getEOD(char sod)
+		{
+			for (auto iter : m_dcList)
+				if (iter->m_SOD == sod)
+					return iter->m_EOD;
+			return ASCII_NULL; //return NULL char in case no SOD is listed in dataControl list!
+		}
+
+		std::string getDataType(char sod)
+		{
+			for (auto iter : m_dcList)
+				if (iter->m_SOD == sod)
+					return iter->m_typeName;
+			return ""; //return EMPTY string in case no SOD is listed in dataControl list!
+		}
+
+		//duration of a single character on the line (start + data + parity + stop bits)
+		double getCharTimeMicros() const
+		{
+			double bits = 1.0 + (m_charSize == CS_UNKNOWN ? 8 : (int)m_charSize);
+			if (m_parity == EVEN || m_parity == ODD)
+				bits += 1.0;
+			bits += (m_stopBits == SB_2) ? 2.0 : ((m_stopBits == SB_1_5) ? 1.5 : 1.0);
+			return bits * 1000000.0 / (m_baudRate == BR_UNKNOWN ? BR_9600 : m_baudRate);
+		}
+
+		std::string getDelims(char sod)
+		{
+			for (auto iter : m_dcList)
+				if (iter->m_SOD == sod)
+					return iter->m_delims;
+			return ""; //return EMPTY string in case no SOD is listed in dataControl list!
+		}
+
+		DataControl_Ptr getDataControl(char sod)
+		{
+			for (auto iter : m_dcList)
+				if (iter->m_SOD == sod)
+					return iter;
+			return DataControl_Ptr(); //return NULL in case no SOD is listed in dataControl list!
+		}
+
+	};
+	using RS232_PortParams_Ptr = std::shared_ptr<RS232_PortParams>;
+
+	struct RS232_PinStatus
+	{
+		RS232_PinStatus(bool cts_on = false, bool dsr_on = false, bool ri_on = false, bool rlsd_on = false) :
+			m_CTS_on(cts_on), m_DSR_on(dsr_on), m_RI_on(ri_on), m_RLSD_on(rlsd_on)
+		{}
+
+		/*!!!Information!!!
+		*DTE -> Data Terminal Equipment [ex: computer terminal]
+		*DCE -> Data Circuit-terminating Equipment (Data Communication Equipment) [ex: modem]
+		*/
+		bool m_CTS_on; //Clear To Send [DCE is ready to accept data from DTE]
+		bool m_DSR_on; //Data Set Ready [DCE is ready to receive and send data]
+		bool m_RI_on; //Ring Indicator [DCE has detected an incoming ring signal on the telephone line]
+		bool m_RLSD_on; //Receive Line Signal Detect (DCD {Data Carrier Detect}) [DCE is receiving a carrier from a remote DCE]
+
+		bool operator==(const RS232_PinStatus& rhs) const
+		{
+			if (m_CTS_on != rhs.m_CTS_on)
+				return false;
+			else if (m_DSR_on != rhs.m_DSR_on)
+				return false;
+			else if (m_RI_on != rhs.m_RI_on)
+				return false;
+			else if (m_RLSD_on != rhs.m_RLSD_on)
+				return false;
+			else
+				return true;
+		}
+
+		bool operator!=(const RS232_PinStatus& rhs) const
+		{
+			return !operator==(rhs);
+		}
+	};
+
+	inline DWORD ConvertBaudRate(BaudRate baudRate)
+	{
+		switch (baudRate)
+		{
+		case BR_50:
+			return 50;
+		case BR_75:
+			return 75;
+		case BR_110:
+			return 110;
+		case BR_134:
+			return 134;
+		case BR_150:
+			return 150;
+		case BR_200:
+			return 200;
+		case BR_300:
+			return 300;
+		case BR_600:
+			return 600;
+		case BR_1200:
+			return 1200;
+		case BR_1800:
+			return 1800;
+		case BR_2400:
+			return 2400;
+		case BR_4800:
+			return 4800;
+		case BR_9600:
+			return 9600;
+		case BR_19200:
+			return 19200;
+		case BR_38400:
+			return 38400;
+		case BR_57600:
+			return 57600;
+		case BR_115200:
+			return 115200;
+		case BR_230400:
+			return 230400;
+		case BR_460800:
+			return 460800;
+		default:
+			return 9600;
+		}
+	}
+
+	inline BYTE ConvertCharSize(CharSize charSize)
+	{
+		switch (charSize)
+		{
+		case CS_5:
+			return DATABITS_5;
+		case CS_6:
+			return DATABITS_6;
+		case CS_7:
+			return DATABITS_7;
+		case CS_8:
+		default:
+			return DATABITS_8;
+		}
+	}
+
+	inline BYTE ConvertParity(Parity parity)
+	{
+		switch (parity)
+		{
+		case EVEN:
+			return EVENPARITY;
+		case ODD:
+			return ODDPARITY;
+		case NONE:
+		default:
+			return NOPARITY;
+		}
+	}
+
+	inline BYTE ConvertStopBits(StopBits stopBits)
+	{
+		switch (stopBits)
+		{
+		case SB_1_5:
+			return ONE5STOPBITS;
+		case SB_2:
+			return TWOSTOPBITS;
+		case SB_1:
+		default:
+			return ONESTOPBIT;
+		}
+	}
+
+	//RTS line of the DCB: FC_HARD hands it to the driver unless the receive queue watermarks drive it
+	inline DWORD ConvertRtsControl(FlowControl flowControl, bool watermarks)
+	{
+		switch (flowControl)
+		{
+		case FC_HARD:
+			return watermarks ? RTS_CONTROL_ENABLE : RTS_CONTROL_HANDSHAKE;
+		case FC_SOFT:
+		case FC_NONE:
+		default:
+			return RTS_CONTROL_ENABLE;
+		}
+	}
 }
\ No newline at end of file
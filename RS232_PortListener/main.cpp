@@ -1,112 +1,369 @@
-// main.cpp : Defines the entry point for the console application.
-//
-#include <csignal>
-
-#include "RS232_Device.h"
-#include "INI_Manager.h"
-
-constexpr auto UC_Q = 0x51;
-constexpr auto LC_Q = 0x71;
-
-bool terminationReceived = false;
-
-void signalHandler(int sigNum)
-{
-	if (sigNum == SIGINT)
-		std::cout << "Interactive Attention Signal received!" << std::endl;
-	else if (sigNum == SIGILL)
-		std::cout << "Illegal Instruction Signal received!" << std::endl;
-	else if (sigNum == SIGFPE)
-		std::cout << "Erroneous Arithmetic Operation Signal received!" << std::endl;
-	else if (sigNum == SIGSEGV)
-		std::cout << "Invalid Access to Storage Signal received!" << std::endl;
-	else if (sigNum == SIGTERM)
-		std::cout << "Termination Request Signal received!" << std::endl;
-	else if (sigNum == SIGBREAK)
-		std::cout << "Ctrl-Break Sequence Signal received!" << std::endl;
-	else if (sigNum == SIGABRT)
-		std::cout << "Abnormal Termination Signal received!" << std::endl;
-	else if (sigNum == SIGABRT_COMPAT)
-		std::cout << "Abnormal Termination Signal (compatible with other platforms) received!" << std::endl;
-	else
-	{
-		std::cout << "Unknown signal received!" << std::endl;
-		return; //does not enter to termination state!
-	}
-
-	terminationReceived = true;
-}
-
-int main(int argc, char* argv[])
-{
-	using namespace RS232;
-
-	/*register termination signals to gracefully shut down*/
-	std::cout << "Registering Signals to catch when occured!" << std::endl;
-	signal(SIGINT, signalHandler);			// SIGINT -> Receipt of an interactive attention signal.
-	signal(SIGILL, signalHandler);			// SIGILL -> Detection of an illegal instruction.
-	signal(SIGFPE, signalHandler);			// SIGFPE -> An erroneous arithmetic operation, such as a divide by zero or an operation resulting in overflow.
-	signal(SIGSEGV, signalHandler);			// SIGSEGV -> An invalid access to storage.
-	signal(SIGTERM, signalHandler);			//SIGTERM -> A termination request sent to the program.
-	signal(SIGBREAK, signalHandler);		// SIGBREAK -> Ctrl-Break sequence
-	signal(SIGABRT, signalHandler);			// SIGABRT -> Abnormal termination of the program, such as a call to abort.
-	signal(SIGABRT_COMPAT, signalHandler);	// SIGABRT_COMPAT -> SIGABRT compatible with other platforms, same as SIGABRT
-	/*register termination signals to gracefully shut down*/
-
-	std::vector<std::string> portList;
-	if (argc != 2)
-	{
-		std::cout << "Wrong input format!" << std::endl;
-		std::cout << "Correct format is:" << std::endl;
-		std::cout << "RS232_PortListener.exe ~iniFilePath~" << std::endl;
-	}
-	else if(!INI_Manager::getInstance()->initFromXml(std::string(argv[1])))
-	{
-		std::cout << "Error while loadig RS232 ports from XML file!" << std::endl;
-	}
-	else if((portList = INI_Manager::getInstance()->getComPortList()).empty())
-	{
-		std::cout << "No COM port found from the XML file!" << std::endl;
-	}
-	else
-	{
-		std::string selectedPort;
-		std::cout << "Please select one of the following COM ports:" << std::endl;
-		for (auto iter : portList)
-			std::cout << iter << std::endl;
-		std::cout << "Selection: " << std::endl;
-		std::cin >> selectedPort;
-
-		RS232_Device_Ptr device = RS232_Device_Ptr(new RS232_Device(INI_Manager::getInstance()->getPortParams(selectedPort)));
-
-		device->openDevice();
-
-		std::string received;
-		std::cout
-			<< "Please write \"Q\" to quit application.." << std::endl
-			<< "enter file path containing the data to be sent to the device..." << std::endl << "File Path: ";
-
-		while (!terminationReceived && std::cin >> received)
-		{
-			if (terminationReceived)
-				break;
-			if (received.length() == 1 && (received.at(0) == UC_Q || received.at(0) == LC_Q))
-				break;
-
-			//received string is a file path containing the data to be sent to the device!!!
-			std::string dataToBeSent = TransmitDataHandler::prepareTransmitData(received);
-			if (dataToBeSent.size())
-				device->sendMessageToDevice(dataToBeSent);
-
-			std::cout
-				<< "Please write \"Q\" to quit application.." << std::endl
-				<< "enter file path containing the data to be sent to the device..." << std::endl << "File Path: ";
-		}
-
-		device->closeDevice();
-		device.reset();
-	}
-
-    return 0;
-}
-
+// main.cpp : Defines the entry point for the console application.
+//
+#include <csignal>
+#include <fstream>
+#include <io.h>
+#include <fcntl.h>
+
+#include "RS232_Device.h"
+#include "INI_Manager.h"
+#include "RS232_Benchmark.h"
+#include "RS232_Journal.h"
+#include "RS232_TrafficLogger.h"
+#include "RS232_FrameOutput.h"
+#include "RS232_FrameReader.h"
+#include "RS232_FrameBus.h"
+#include "RS232_Harness.h"
+#include "RS232_Poller.h"
+#include "Base64.h"
+
+constexpr auto UC_Q = 0x51;
+constexpr auto LC_Q = 0x71;
+
+constexpr auto BENCH_FRAMING_ARG = "--bench-framing";
+constexpr auto BENCH_JOURNAL_ARG = "--bench-journal";
+constexpr auto READ_BUS_ARG = "--read-bus";
+constexpr auto BENCH_GATEWAY_ARG = "--bench-gateway";
+constexpr auto BENCH_JITTER_ARG = "--bench-jitter";
+constexpr auto BENCH_TRAFFIC_LOG_ARG = "--bench-traffic-log";
+constexpr auto BENCH_RESTART_ARG = "--bench-restart";
+constexpr auto BENCH_FRAME_OUTPUT_ARG = "--bench-frame-output";
+constexpr auto BENCH_TX_LANES_ARG = "--bench-tx-lanes";
+constexpr auto BENCH_HALF_DUPLEX_ARG = "--bench-half-duplex";
+constexpr auto BENCH_MODBUS_RTU_ARG = "--bench-modbus-rtu";
+constexpr auto BENCH_COROUTINES_ARG = "--bench-coroutines";
+constexpr auto READ_FRAMES_ARG = "--read-frames";
+constexpr auto HARNESS_ARG = "--harness";
+constexpr auto UNPACK_LOG_ARG = "--unpack-log";
+constexpr auto READ_BUS_TIMEOUT = 500;
+
+bool terminationReceived = false;
+
+void signalHandler(int sigNum)
+{
+	if (sigNum == SIGINT)
+		std::cout << "Interactive Attention Signal received!" << std::endl;
+	else if (sigNum == SIGILL)
+		std::cout << "Illegal Instruction Signal received!" << std::endl;
+	else if (sigNum == SIGFPE)
+		std::cout << "Erroneous Arithmetic Operation Signal received!" << std::endl;
+	else if (sigNum == SIGSEGV)
+		std::cout << "Invalid Access to Storage Signal received!" << std::endl;
+	else if (sigNum == SIGTERM)
+		std::cout << "Termination Request Signal received!" << std::endl;
+	else if (sigNum == SIGBREAK)
+		std::cout << "Ctrl-Break Sequence Signal received!" << std::endl;
+	else if (sigNum == SIGABRT)
+		std::cout << "Abnormal Termination Signal received!" << std::endl;
+	else if (sigNum == SIGABRT_COMPAT)
+		std::cout << "Abnormal Termination Signal (compatible with other platforms) received!" << std::endl;
+	else
+	{
+		std::cout << "Unknown signal received!" << std::endl;
+		return; //does not enter to termination state!
+	}
+
+	terminationReceived = true;
+}
+
+//reader process of the frame bus published by a running listener
+void readFrameBus(const std::string& portName)
+{
+	using namespace RS232;
+
+	RS232_FrameBusReader_Ptr reader = RS232_FrameBusReader::open(portName);
+	if (!reader.get())
+		return;
+
+	std::cout << "Reading frames of " << portName << " from the frame bus..." << std::endl;
+	RS232_BusFrame frame;
+	while (!terminationReceived)
+	{
+		BusReadStatus status = reader->waitFrame(frame, READ_BUS_TIMEOUT);
+		if (status == BR_CLOSED)
+		{
+			std::cout << "Listener closed the frame bus of " << portName << std::endl;
+			break;
+		}
+		if (status == BR_TIMEOUT)
+			continue;
+		if (status == BR_LAPPED)
+			std::cout << "!!!frame bus lapped, " << reader->getLostFrames() << " frames lost so far!!!" << std::endl;
+
+		std::string data((const char*)frame.m_data, frame.m_length);
+		if (!reader->validate(frame))
+			continue; //overwritten while it was being copied
+
+		std::cout << "[Bus Frame #" << frame.m_sequence << "]" << std::endl;
+		if (frame.m_firstNonPrintableCharPos == NO_NON_PRINTABLE_CHAR)
+			std::cout << data << std::endl;
+		else
+			std::cout << "Base64-Encoded: " << Base64::Encode((const unsigned char*)data.data(), data.size()) << std::endl;
+	}
+}
+
+//prints the records of a binary frame output file, "-" reads them from stdin
+void readFrameOutput(const std::string& path)
+{
+	using namespace RS232;
+
+	std::ifstream file;
+	if (path == FRAME_OUTPUT_STDOUT)
+	{
+		_setmode(_fileno(stdin), _O_BINARY);
+	}
+	else
+	{
+		file.open(path, std::ios::binary | std::ios::in);
+		if (!file.is_open())
+		{
+			std::cout << "cannot open " << path << std::endl;
+			return;
+		}
+	}
+
+	RS232_FrameReader reader(path == FRAME_OUTPUT_STDOUT ? std::cin : file);
+	if (!reader.isValid())
+	{
+		std::cout << path << " is not a frame output stream!" << std::endl;
+		return;
+	}
+
+	RS232_FrameRecord record;
+	while (!terminationReceived && reader.next(record))
+	{
+		std::cout << "[" << record.m_portName << " type " << record.m_typeId << " " << record.m_startMicros << " - " << record.m_endMicros << "]" << std::endl;
+		if (record.m_flags & FRAME_FLAG_BINARY)
+			std::cout << "Base64-Encoded: " << Base64::Encode((const unsigned char*)record.m_data.data(), record.m_data.size()) << std::endl;
+		else
+			std::cout << record.m_data << std::endl;
+	}
+	std::cout << reader.getReadRecords() << " records read" << std::endl;
+}
+
+//achieved poll rate & missed deadlines of the polling master
+void printPollerStats(const RS232::RS232_PollerStats& stats)
+{
+	std::cout << "[Poller] " << stats.m_polls << " polls at " << stats.m_pollRate << " polls/s, bus utilization " << stats.m_busUtilization * 100.0 << "%, "
+		<< stats.m_replies << " replies, " << stats.m_timeouts << " timeouts, " << stats.m_lateReplies << " late replies, "
+		<< stats.m_missedDeadlines << " missed deadlines" << std::endl;
+	for (const RS232::RS232_SlavePollStats& slave : stats.m_slaves)
+	{
+		std::cout << "  slave " << slave.m_slave << ": " << slave.m_polls << " polls, " << slave.m_replies << " replies, " << slave.m_timeouts << " timeouts, "
+			<< slave.m_missedDeadlines << " missed deadlines, reply avg " << slave.m_averageReplyMicros << " us max " << slave.m_maxReplyMicros << " us"
+			<< (slave.m_backedOff ? " (backed off)" : "") << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	using namespace RS232;
+
+	/*register termination signals to gracefully shut down*/
+	std::cout << "Registering Signals to catch when occured!" << std::endl;
+	signal(SIGINT, signalHandler);			// SIGINT -> Receipt of an interactive attention signal.
+	signal(SIGILL, signalHandler);			// SIGILL -> Detection of an illegal instruction.
+	signal(SIGFPE, signalHandler);			// SIGFPE -> An erroneous arithmetic operation, such as a divide by zero or an operation resulting in overflow.
+	signal(SIGSEGV, signalHandler);			// SIGSEGV -> An invalid access to storage.
+	signal(SIGTERM, signalHandler);			//SIGTERM -> A termination request sent to the program.
+	signal(SIGBREAK, signalHandler);		// SIGBREAK -> Ctrl-Break sequence
+	signal(SIGABRT, signalHandler);			// SIGABRT -> Abnormal termination of the program, such as a call to abort.
+	signal(SIGABRT_COMPAT, signalHandler);	// SIGABRT_COMPAT -> SIGABRT compatible with other platforms, same as SIGABRT
+	/*register termination signals to gracefully shut down*/
+
+	std::vector<std::string> portList;
+	if (argc == 3 && std::string(argv[1]) == BENCH_FRAMING_ARG)
+	{
+		RS232_Benchmark::runFramingBenchmark(std::string(argv[2]));
+	}
+	else if (argc == 3 && std::string(argv[1]) == BENCH_JOURNAL_ARG)
+	{
+		RS232_Benchmark::runJournalBenchmark(std::string(argv[2]));
+	}
+	else if (argc == 3 && std::string(argv[1]) == BENCH_GATEWAY_ARG)
+	{
+		RS232_Benchmark::runGatewayBenchmark((unsigned int)std::stoul(argv[2]));
+	}
+	else if (argc == 3 && std::string(argv[1]) == BENCH_TRAFFIC_LOG_ARG)
+	{
+		RS232_Benchmark::runTrafficLogBenchmark(std::string(argv[2]));
+	}
+	else if (argc == 3 && std::string(argv[1]) == BENCH_FRAME_OUTPUT_ARG)
+	{
+		RS232_Benchmark::runFrameOutputBenchmark(std::string(argv[2]));
+	}
+	else if (argc == 3 && std::string(argv[1]) == BENCH_TX_LANES_ARG)
+	{
+		RS232_Benchmark::runTxLaneBenchmark((unsigned int)std::stoul(argv[2]));
+	}
+	else if (argc == 3 && std::string(argv[1]) == BENCH_HALF_DUPLEX_ARG)
+	{
+		RS232_Benchmark::runHalfDuplexBenchmark((unsigned int)std::stoul(argv[2]));
+	}
+	else if (argc == 3 && std::string(argv[1]) == BENCH_MODBUS_RTU_ARG)
+	{
+		RS232_Benchmark::runModbusRtuBenchmark((unsigned int)std::stoul(argv[2]));
+	}
+	else if (argc == 2 && std::string(argv[1]) == BENCH_COROUTINES_ARG)
+	{
+		RS232_Benchmark::runCoroutineBenchmark();
+	}
+	else if (argc == 4 && std::string(argv[1]) == BENCH_JITTER_ARG)
+	{
+		RS232_PortParams_Ptr portParams;
+		if (!INI_Manager::getInstance()->initFromXml(std::string(argv[2])))
+			std::cout << "Error while loadig RS232 ports from XML file!" << std::endl;
+		else if (!(portParams = INI_Manager::getInstance()->getPortParams(std::string(argv[3]))).get())
+			std::cout << argv[3] << " is not found in the XML file!" << std::endl;
+		else
+		{
+			RS232_PortHandler::applyPriorityClass(INI_Manager::getInstance()->getPriorityClass());
+			RS232_Benchmark::runJitterBenchmark(portParams);
+		}
+	}
+	else if (argc == 5 && std::string(argv[1]) == BENCH_RESTART_ARG)
+	{
+		RS232_PortParams_Ptr portParams;
+		if (!INI_Manager::getInstance()->initFromXml(std::string(argv[2])))
+			std::cout << "Error while loadig RS232 ports from XML file!" << std::endl;
+		else if (!(portParams = INI_Manager::getInstance()->getPortParams(std::string(argv[3]))).get())
+			std::cout << argv[3] << " is not found in the XML file!" << std::endl;
+		else
+			RS232_Benchmark::runRestartBenchmark(portParams, (unsigned int)std::stoul(argv[4]));
+	}
+	else if ((argc == 6 || argc == 7) && std::string(argv[1]) == HARNESS_ARG)
+	{
+		RS232_PortParams_Ptr listenParams;
+		RS232_PortParams_Ptr peerParams;
+		if (!INI_Manager::getInstance()->initFromXml(std::string(argv[2])))
+			std::cout << "Error while loadig RS232 ports from XML file!" << std::endl;
+		else if (!(listenParams = INI_Manager::getInstance()->getPortParams(std::string(argv[3]))).get())
+			std::cout << argv[3] << " is not found in the XML file!" << std::endl;
+		else if (!(peerParams = INI_Manager::getInstance()->getPortParams(std::string(argv[4]))).get())
+			std::cout << argv[4] << " is not found in the XML file!" << std::endl;
+		else if (RS232_Harness::run(listenParams, peerParams, INI_Manager::getInstance()->getHarnessParams(), std::string(argv[5]), argc == 7 ? std::string(argv[6]) : ""))
+			return 0;
+		return 1; //regression: the CI job fails
+	}
+	else if (argc == 4 && std::string(argv[1]) == UNPACK_LOG_ARG)
+	{
+		if (RS232_TrafficLogger::unpackFile(std::string(argv[2]), std::string(argv[3])))
+			std::cout << argv[2] << " is unpacked to " << argv[3] << std::endl;
+	}
+	else if (argc == 3 && std::string(argv[1]) == READ_BUS_ARG)
+	{
+		readFrameBus(std::string(argv[2]));
+	}
+	else if (argc == 3 && std::string(argv[1]) == READ_FRAMES_ARG)
+	{
+		readFrameOutput(std::string(argv[2]));
+	}
+	else if (argc != 2)
+	{
+		std::cout << "Wrong input format!" << std::endl;
+		std::cout << "Correct format is:" << std::endl;
+		std::cout << "RS232_PortListener.exe ~iniFilePath~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_FRAMING_ARG << " ~transmitDataFilePath~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_JOURNAL_ARG << " ~journalDirectory~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << READ_BUS_ARG << " ~comPort~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_GATEWAY_ARG << " ~clientCount~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_TRAFFIC_LOG_ARG << " ~logDirectory~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_FRAME_OUTPUT_ARG << " ~outputDirectory~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_TX_LANES_ARG << " ~baudRate~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_HALF_DUPLEX_ARG << " ~baudRate~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_MODBUS_RTU_ARG << " ~baudRate~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_COROUTINES_ARG << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_JITTER_ARG << " ~iniFilePath~ ~comPort~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << BENCH_RESTART_ARG << " ~iniFilePath~ ~comPort~ ~cycles~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << HARNESS_ARG << " ~iniFilePath~ ~listenComPort~ ~peerComPort~ ~transmitDataFilePath~ [~resultJsonPath~]" << std::endl;
+		std::cout << "RS232_PortListener.exe " << UNPACK_LOG_ARG << " ~compressedTrafficLogPath~ ~outputPath~" << std::endl;
+		std::cout << "RS232_PortListener.exe " << READ_FRAMES_ARG << " ~frameOutputPath~ (- for stdin)" << std::endl;
+	}
+	else if(!INI_Manager::getInstance()->initFromXml(std::string(argv[1])))
+	{
+		std::cout << "Error while loadig RS232 ports from XML file!" << std::endl;
+	}
+	else if((portList = INI_Manager::getInstance()->getComPortList()).empty())
+	{
+		std::cout << "No COM port found from the XML file!" << std::endl;
+	}
+	else
+	{
+		std::string selectedPort;
+		std::cout << "Please select one of the following COM ports:" << std::endl;
+		for (auto iter : portList)
+			std::cout << iter << std::endl;
+		std::cout << "Selection: " << std::endl;
+		std::cin >> selectedPort;
+
+		RS232_PortHandler::applyPriorityClass(INI_Manager::getInstance()->getPriorityClass());
+
+		RS232_JournalParams_Ptr journalParams = INI_Manager::getInstance()->getJournalParams();
+		if (journalParams.get() && !RS232_Journal::getInstance()->open(journalParams))
+			std::cout << "Received frames will not be journaled!" << std::endl;
+
+		RS232_TrafficLogParams_Ptr trafficLogParams = INI_Manager::getInstance()->getTrafficLogParams();
+		if (trafficLogParams.get() && !RS232_TrafficLogger::getInstance()->open(trafficLogParams))
+			std::cout << "Port traffic will not be logged!" << std::endl;
+
+		RS232_FrameOutputParams_Ptr frameOutputParams = INI_Manager::getInstance()->getFrameOutputParams();
+		if (frameOutputParams.get() && !RS232_FrameOutput::getInstance()->open(frameOutputParams))
+			std::cout << "Received frames will be printed as text!" << std::endl;
+
+		RS232_PortParams_Ptr portParams = INI_Manager::getInstance()->getPortParams(selectedPort);
+		RS232_Device_Ptr device = RS232_Device_Ptr(new RS232_Device(portParams));
+
+		RS232_Poller_Ptr poller;
+		if (portParams.get() && portParams->m_pollerParams.get())
+		{	//the replies of the polled slaves are printed/written like any other frame
+			poller = RS232_Poller_Ptr(new RS232_Poller(device, portParams->m_pollerParams, [selectedPort](unsigned int, const RS232_Frame& reply)
+			{
+				if (RS232_FrameOutput::getInstance()->isOpen())
+					RS232_FrameOutput::getInstance()->write(selectedPort, reply);
+				else
+					RS232_Device::printReceivedData(reply.m_data, reply.m_info);
+			}));
+		}
+
+		device->openDevice();
+		if (poller.get())
+			poller->start();
+
+		std::string received;
+		std::cout
+			<< "Please write \"Q\" to quit application.." << std::endl
+			<< "enter file path containing the data to be sent to the device..." << std::endl << "File Path: ";
+
+		while (!terminationReceived && std::cin >> received)
+		{
+			if (terminationReceived)
+				break;
+			if (received.length() == 1 && (received.at(0) == UC_Q || received.at(0) == LC_Q))
+				break;
+
+			//received string is a file path containing the data to be sent to the device!!!
+			std::string dataToBeSent = TransmitDataHandler::prepareTransmitData(received);
+			if (dataToBeSent.size())
+				device->sendMessageToDevice(dataToBeSent);
+
+			std::cout
+				<< "Please write \"Q\" to quit application.." << std::endl
+				<< "enter file path containing the data to be sent to the device..." << std::endl << "File Path: ";
+		}
+
+		if (poller.get())
+		{
+			poller->stop();
+			printPollerStats(poller->getStats());
+			poller.reset();
+		}
+		device->closeDevice();
+		device.reset();
+		RS232_Journal::getInstance()->close();
+		RS232_TrafficLogger::getInstance()->close();
+		RS232_FrameOutput::getInstance()->close();
+	}
+
+    return 0;
+}
+